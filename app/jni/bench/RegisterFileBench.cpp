@@ -0,0 +1,92 @@
+﻿/**
+ * Microbenchmark for the general register layout used by CPU::LoadOperand
+ * and CPU::StoreOperand. Fetches an ERn operand, adds to it and writes it
+ * back, the way the decode/dispatch path does for every ALU instruction,
+ * once with the old per-register stubs (a type size, a name and the value
+ * for each of R0-R15) and once with the flat 16-byte file.
+ *
+ * Standalone, so that it needs neither SDL nor a ROM. Build with
+ * -DCASIOEMU_BENCHMARKS=ON, or just `g++ -O2 RegisterFileBench.cpp`.
+ *
+ *     register_file_bench [iterations]
+ */
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace {
+	// * The layout before the flat register file.
+	struct RegisterStub {
+		size_t type_size;
+		std::string name;
+		uint16_t raw;
+	};
+
+	struct StubFile {
+		RegisterStub reg_r[16];
+
+		uint64_t Load(uint8_t field) {
+			return (uint8_t)reg_r[field].raw | (uint16_t)((uint8_t)reg_r[field + 1].raw << 8);
+		}
+		void Store(uint8_t field, uint64_t value) {
+			for (size_t bx = 0; bx != 2; ++bx)
+				reg_r[field + bx].raw = (uint8_t)(value >> (bx * 8));
+		}
+		uint8_t Sum() {
+			uint8_t sum = 0;
+			for (auto& reg : reg_r)
+				sum += (uint8_t)reg.raw;
+			return sum;
+		}
+	};
+
+	struct FlatFile {
+		union {
+			uint8_t reg_r[16];
+			uint16_t reg_er[8];
+		};
+
+		uint64_t Load(uint8_t field) {
+			return reg_er[field >> 1];
+		}
+		void Store(uint8_t field, uint64_t value) {
+			reg_er[field >> 1] = (uint16_t)value;
+		}
+		uint8_t Sum() {
+			uint8_t sum = 0;
+			for (auto reg : reg_r)
+				sum += reg;
+			return sum;
+		}
+	};
+
+	template <typename File>
+	void Run(const char* label, uint64_t iterations, const uint8_t* fields) {
+		File file{};
+		auto start = std::chrono::steady_clock::now();
+		for (uint64_t ix = 0; ix != iterations; ++ix) {
+			uint8_t field = fields[ix & 255];
+			file.Store(field, file.Load(field) + ix);
+		}
+		auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+		// * Printing the registers keeps the loop from being optimised away.
+		std::printf("%-12s %8lld ms  %zu bytes  (checksum %02X)\n", label, (long long)ms, sizeof(file), file.Sum());
+	}
+} // namespace
+
+int main(int argc, char* argv[]) {
+	uint64_t iterations = argc > 1 ? std::strtoull(argv[1], nullptr, 0) : 200000000;
+	// * Even register numbers, as ERn operands are encoded.
+	uint8_t fields[256];
+	uint32_t seed = 1;
+	for (auto& field : fields) {
+		seed = seed * 1103515245 + 12345;
+		field = (seed >> 16) % 8 * 2;
+	}
+	std::printf("%llu ERn fetch/writeback pairs\n", (unsigned long long)iterations);
+	Run<StubFile>("stubs", iterations, fields);
+	Run<FlatFile>("flat file", iterations, fields);
+	return 0;
+}
@@ -0,0 +1,185 @@
+﻿#include "Batch.hpp"
+
+#include "Chipset/Chipset.hpp"
+#include "Chipset/MMU.hpp"
+#include "Emulator.hpp"
+#include "Logger.hpp"
+#include "Peripheral/BatteryBackedRAM.hpp"
+#include "Peripheral/Keyboard.hpp"
+#include "Peripheral/Screen.hpp"
+#include "Replay.hpp"
+#include "Rewind.hpp"
+#include "SaveState.hpp"
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace casioemu {
+	BatchRunner::BatchRunner(Emulator& _emulator) : emulator(_emulator) {
+	}
+
+	void BatchRunner::Wait(unsigned int ms) {
+		emulator.RunTicks((uint64_t)emulator.cycles_per_second * ms / 1000);
+	}
+
+	void BatchRunner::KeyAction(uint8_t action, uint8_t button) {
+		auto keyboard = emulator.chipset.QueryInterface<IKeyboard>();
+		if (!keyboard)
+			return;
+		keyboard->ApplyKeyAction(action, button);
+		emulator.replay.Record(action, button);
+	}
+
+	int BatchRunner::FindButton(const std::string& name) {
+		auto keyboard = emulator.chipset.QueryInterface<IKeyboard>();
+		int button = keyboard ? keyboard->FindButton(name) : -1;
+		if (button < 0)
+			logger::Info("[Batch][Error] Line %zu: no key '%s' on this model\n", line_number, name.c_str());
+		return button;
+	}
+
+	bool BatchRunner::Execute(const std::vector<std::string>& args) {
+		auto& command = args[0];
+		if (command == "press" && args.size() == 2) {
+			int button = FindButton(args[1]);
+			if (button < 0)
+				return false;
+			KeyAction(IKeyboard::KA_PRESS, button);
+			return true;
+		}
+		if (command == "release" && args.size() == 1) {
+			KeyAction(IKeyboard::KA_RELEASE_ALL, 0);
+			return true;
+		}
+		if (command == "tap" && args.size() >= 2) {
+			for (size_t ix = 1; ix != args.size(); ++ix) {
+				int button = FindButton(args[ix]);
+				if (button < 0)
+					return false;
+				KeyAction(IKeyboard::KA_PRESS, button);
+				Wait(tap_ms);
+				KeyAction(IKeyboard::KA_RELEASE_ALL, 0);
+				Wait(tap_ms);
+			}
+			return true;
+		}
+		if (command == "wait" && args.size() == 2) {
+			Wait(std::stoul(args[1]));
+			return true;
+		}
+		if (args.size() != 2) {
+			logger::Info("[Batch][Error] Line %zu: unknown command '%s' or wrong number of arguments\n", line_number, command.c_str());
+			return false;
+		}
+
+		auto& path = args[1];
+		if (command == "load_state") {
+			StateSnapshot snapshot;
+			std::ifstream is(path, std::ifstream::binary);
+			try {
+				snapshot.Read(is);
+			}
+			catch (std::exception const&) {
+				is.setstate(std::ios::failbit);
+			}
+			if (!is || !emulator.save_states.Restore(snapshot)) {
+				logger::Info("[Batch][Error] Line %zu: can't load a state for this model from %s\n", line_number, path.c_str());
+				return false;
+			}
+			emulator.rewind.Clear();
+			return true;
+		}
+		if (command == "save_state") {
+			std::ofstream os(path, std::ofstream::binary);
+			emulator.save_states.Capture()->Write(os);
+			if (!os) {
+				logger::Info("[Batch][Error] Line %zu: can't save state to %s\n", line_number, path.c_str());
+				return false;
+			}
+			return true;
+		}
+
+		auto ram = emulator.chipset.QueryInterface<IRam>();
+		if ((command == "load_ram" || command == "dump_ram") && !ram) {
+			logger::Info("[Batch][Error] Line %zu: model has no RAM interface\n", line_number);
+			return false;
+		}
+		if (command == "load_ram") {
+			std::ifstream is(path, std::ifstream::binary);
+			is.read((char*)ram->GetRam(), ram->GetRamBufferSize());
+			emulator.chipset.mmu.MarkHostWrite();
+			if (!is) {
+				logger::Info("[Batch][Error] Line %zu: can't read a RAM image from %s\n", line_number, path.c_str());
+				return false;
+			}
+			return true;
+		}
+
+		std::vector<uint8_t> data;
+		if (command == "dump_ram") {
+			data.assign((uint8_t*)ram->GetRam(), (uint8_t*)ram->GetRam() + ram->GetRamBufferSize());
+		}
+		else if (command == "dump_screen") {
+			auto screen = emulator.chipset.QueryInterface<IScreen>();
+			if (screen)
+				data = screen->GetScreenBuffer();
+		}
+		else {
+			logger::Info("[Batch][Error] Line %zu: unknown command '%s' or wrong number of arguments\n", line_number, command.c_str());
+			return false;
+		}
+		std::ofstream os(path, std::ofstream::binary);
+		os.write((const char*)data.data(), data.size());
+		if (!os) {
+			logger::Info("[Batch][Error] Line %zu: can't write to %s\n", line_number, path.c_str());
+			return false;
+		}
+		return true;
+	}
+
+	int BatchRunner::Run() {
+		auto script_iter = emulator.argv_map.find("batch");
+		if (script_iter == emulator.argv_map.end()) {
+			logger::Info("[Batch][Error] No script given, use batch=<file>\n");
+			return 1;
+		}
+		std::ifstream script(script_iter->second);
+		if (!script) {
+			logger::Info("[Batch][Error] Can't read %s\n", script_iter->second.c_str());
+			return 1;
+		}
+
+		// * Let the reset and any replay set up in the constructor happen first.
+		emulator.RunTicks(1);
+
+		std::string line;
+		while (std::getline(script, line)) {
+			++line_number;
+			std::vector<std::string> args;
+			std::istringstream iss(line.substr(0, line.find('#')));
+			std::string arg;
+			while (iss >> std::ws && !iss.eof()) {
+				if (iss.peek() == '"')
+					iss >> std::quoted(arg);
+				else
+					iss >> arg;
+				args.push_back(arg);
+			}
+			if (args.empty())
+				continue;
+
+			bool success;
+			try {
+				success = Execute(args);
+			}
+			catch (std::exception const&) {
+				logger::Info("[Batch][Error] Line %zu: invalid argument\n", line_number);
+				success = false;
+			}
+			if (!success)
+				return 1;
+		}
+		return 0;
+	}
+} // namespace casioemu
@@ -0,0 +1,50 @@
+﻿#pragma once
+#include "Config.hpp"
+
+#include <string>
+#include <vector>
+
+namespace casioemu {
+	class Emulator;
+
+	/**
+	 * Runs a headless emulator through the script given by the `batch` key,
+	 * for regression tests. One command per line, `#` starts a comment and
+	 * arguments with spaces in them can be put in double quotes:
+	 *
+	 *     press <key>          hold a key down, by its name in the model's
+	 *                          config or its KI/KO code as 0x...
+	 *     release              release every key that is not stuck
+	 *     tap <key>...         press and release each key in turn
+	 *     wait <ms>            run for that many emulated milliseconds
+	 *     load_state <file>    see `SaveStates`
+	 *     save_state <file>
+	 *     load_ram <file>      a raw image, like ram.dmp
+	 *     dump_ram <file>
+	 *     dump_screen <file>   the display RAM, see `IScreen`
+	 *
+	 * Everything runs on the calling thread at full speed, and key input is
+	 * recorded if the `record` key is given too.
+	 */
+	class BatchRunner {
+		Emulator& emulator;
+		size_t line_number = 0;
+
+		// * How long `tap` holds a key, and waits after releasing it.
+		static constexpr unsigned int tap_ms = 100;
+
+		void Wait(unsigned int ms);
+		void KeyAction(uint8_t action, uint8_t button);
+		int FindButton(const std::string& name);
+		bool Execute(const std::vector<std::string>& args);
+
+	public:
+		BatchRunner(Emulator& emulator);
+
+		/**
+		 * Returns the process exit code: 0 if every command succeeded, 1 as
+		 * soon as one fails.
+		 */
+		int Run();
+	};
+} // namespace casioemu
@@ -2,220 +2,335 @@
 
 #include "Chipset.hpp"
 #include "Emulator.hpp"
-#include "Gui/CodeViewer.hpp"
 #include "Gui/Hooks.h"
 #include "Logger.hpp"
 #include "MMU.hpp"
+#include "SaveState.hpp"
 
+#include <algorithm>
+#include <cstring>
 #include <iomanip>
 #include <sstream>
 
 #pragma warning(disable:4244)
 
 namespace casioemu {
+	template <size_t register_size>
+	void CPU::LoadOperand(size_t index, uint8_t field) {
+		impl_operands[index].register_index = field;
+		impl_operands[index].register_size = register_size;
+
+		if constexpr (register_size == 0)
+			impl_operands[index].value = field;
+		else if constexpr (register_size == 1)
+			impl_operands[index].value = reg_r[field];
+		else if constexpr (register_size == 2)
+			impl_operands[index].value = reg_er[field >> 1];
+		else if constexpr (register_size == 4)
+			impl_operands[index].value = reg_xr[field >> 2];
+		else
+			impl_operands[index].value = reg_qr[field >> 3];
+	}
+
+	template <size_t register_size>
+	void CPU::StoreOperand(uint8_t field) {
+		if constexpr (register_size == 1)
+			reg_r[field] = (uint8_t)impl_operands[0].value;
+		else if constexpr (register_size == 2)
+			reg_er[field >> 1] = (uint16_t)impl_operands[0].value;
+		else if constexpr (register_size == 4)
+			reg_xr[field >> 2] = (uint32_t)impl_operands[0].value;
+		else if constexpr (register_size == 8)
+			reg_qr[field >> 3] = impl_operands[0].value;
+	}
+
+	template <size_t size0, size_t size1, bool writeback>
+	void CPU::ExecuteAs(const DecodedInstruction& decoded) {
+		const OpcodeSource* handler = decoded.handler;
+
+		impl_opcode = decoded.opcode;
+		impl_long_imm = decoded.long_imm;
+		impl_hint = handler->hint;
+		impl_cycles += handler->cycles;
+
+		LoadOperand<size0>(0, decoded.operands[0]);
+		LoadOperand<size1>(1, decoded.operands[1]);
+
+		if (handler->hint & H_LF) {
+			(this->*(handler->handler_function))();
+			if constexpr (writeback)
+				StoreOperand<size0>(decoded.operands[0]);
+			return;
+		}
+
+		if (handler->reads_flags)
+			MaterializeFlags();
+		impl_flags_changed = 0;
+		impl_flags_in = reg_psw;
+		/**
+		 * Yes, Z is always set to 1. While `impl_flags_changed` may not have
+		 * PSW_Z set, `impl_flags_out` does as most of the time Z is calculated
+		 * by one or more calls to `ZSCheck`. `ZSCheck` only changes Z if the
+		 * value it checks is non-zero, otherwise it leaves it alone.
+		 */
+		impl_flags_out = PSW_Z;
+		(this->*(handler->handler_function))();
+
+		reg_psw &= ~impl_flags_changed;
+		reg_psw |= impl_flags_out & impl_flags_changed;
+		// * Whatever was just written is no longer owed by an earlier lazy instruction.
+		lazy_flags &= ~impl_flags_changed;
+
+		if constexpr (writeback)
+			StoreOperand<size0>(decoded.operands[0]);
+	}
+
+	template <size_t size0, bool writeback>
+	constexpr CPU::Executor CPU::SelectExecutor(size_t size1) {
+		switch (size1) {
+		case 0:
+			return &CPU::ExecuteAs<size0, 0, writeback>;
+		case 1:
+			return &CPU::ExecuteAs<size0, 1, writeback>;
+		case 2:
+			return &CPU::ExecuteAs<size0, 2, writeback>;
+		case 4:
+			return &CPU::ExecuteAs<size0, 4, writeback>;
+		case 8:
+			return &CPU::ExecuteAs<size0, 8, writeback>;
+		default:
+			return nullptr;
+		}
+	}
+
+	constexpr CPU::Executor CPU::SelectExecutor(size_t hint, size_t size0, size_t size1) {
+		switch (size0) {
+		case 0:
+			return SelectExecutor<0, false>(size1);
+		case 1:
+			return (hint & H_WB) ? SelectExecutor<1, true>(size1) : SelectExecutor<1, false>(size1);
+		case 2:
+			return (hint & H_WB) ? SelectExecutor<2, true>(size1) : SelectExecutor<2, false>(size1);
+		case 4:
+			return (hint & H_WB) ? SelectExecutor<4, true>(size1) : SelectExecutor<4, false>(size1);
+		case 8:
+			return (hint & H_WB) ? SelectExecutor<8, true>(size1) : SelectExecutor<8, false>(size1);
+		default:
+			return nullptr;
+		}
+	}
+
+	constexpr CPU::OpcodeSource::OpcodeSource(void (CPU::*handler_function)(), size_t hint, uint16_t opcode, uint8_t cycles, const OperandMask (&operands)[2])
+		: handler_function(handler_function), hint(hint), opcode(opcode), cycles(cycles), operands{operands[0], operands[1]},
+		  executor(SelectExecutor(hint, operands[0].register_size, operands[1].register_size)),
+		  reads_flags(handler_function == &CPU::OP_BC || handler_function == &CPU::OP_DAA || handler_function == &CPU::OP_DAS ||
+					  handler_function == &CPU::OP_CTRL || handler_function == &CPU::OP_PSW_OR || handler_function == &CPU::OP_PSW_AND ||
+					  handler_function == &CPU::OP_CPLC || handler_function == &CPU::OP_PUSHL || handler_function == &CPU::OP_POPL ||
+					  handler_function == &CPU::OP_RTI || handler_function == &CPU::OP_RTICE) {
+	}
+
 	// clang-format off
-	CPU::OpcodeSource CPU::opcode_sources[] = {
-		//           function,                     hints, main mask, operand {size, mask, shift} x2
+	constinit const CPU::OpcodeSource CPU::opcode_sources[] = {
+		//           function,                            hints, main mask, cycles, operand {size, mask, shift} x2
 		// * Arithmetic Instructions
-		{&CPU::OP_ADD        , H_WB                     , 0x8001, {{1, 0x000F,  8}, {1, 0x000F,  4}}},
-		{&CPU::OP_ADD        , H_WB                     , 0x1000, {{1, 0x000F,  8}, {0, 0x00FF,  0}}},
-		{&CPU::OP_ADD16      , H_WB                     , 0xF006, {{2, 0x000E,  8}, {2, 0x000E,  4}}},
-		{&CPU::OP_ADD16      , H_WB               | H_IE, 0xE080, {{2, 0x000E,  8}, {0, 0x007F,  0}}},
-		{&CPU::OP_ADDC       , H_WB                     , 0x8006, {{1, 0x000F,  8}, {1, 0x000F,  4}}},
-		{&CPU::OP_ADDC       , H_WB                     , 0x6000, {{1, 0x000F,  8}, {0, 0x00FF,  0}}},
-		{&CPU::OP_AND        , H_WB                     , 0x8002, {{1, 0x000F,  8}, {1, 0x000F,  4}}},
-		{&CPU::OP_AND        , H_WB                     , 0x2000, {{1, 0x000F,  8}, {0, 0x00FF,  0}}},
-		{&CPU::OP_SUB        ,                         0, 0x8007, {{1, 0x000F,  8}, {1, 0x000F,  4}}},
-		{&CPU::OP_SUB        ,                         0, 0x7000, {{1, 0x000F,  8}, {0, 0x00FF,  0}}},
-		{&CPU::OP_SUBC       ,                         0, 0x8005, {{1, 0x000F,  8}, {1, 0x000F,  4}}},
-		{&CPU::OP_SUBC       ,                         0, 0x5000, {{1, 0x000F,  8}, {0, 0x00FF,  0}}},
-		{&CPU::OP_MOV16      , H_WB                     , 0xF005, {{2, 0x000E,  8}, {2, 0x000E,  4}}},
-		{&CPU::OP_MOV16      , H_WB               | H_IE, 0xE000, {{2, 0x000E,  8}, {0, 0x007F,  0}}},
-		{&CPU::OP_MOV        , H_WB                     , 0x8000, {{1, 0x000F,  8}, {1, 0x000F,  4}}},
-		{&CPU::OP_MOV        , H_WB                     , 0x0000, {{1, 0x000F,  8}, {0, 0x00FF,  0}}},
-		{&CPU::OP_OR         , H_WB                     , 0x8003, {{1, 0x000F,  8}, {1, 0x000F,  4}}},
-		{&CPU::OP_OR         , H_WB                     , 0x3000, {{1, 0x000F,  8}, {0, 0x00FF,  0}}},
-		{&CPU::OP_XOR        , H_WB                     , 0x8004, {{1, 0x000F,  8}, {1, 0x000F,  4}}},
-		{&CPU::OP_XOR        , H_WB                     , 0x4000, {{1, 0x000F,  8}, {0, 0x00FF,  0}}},
-		{&CPU::OP_CMP16      ,                         0, 0xF007, {{2, 0x000E,  8}, {2, 0x000E,  4}}},
-		{&CPU::OP_SUB        , H_WB                     , 0x8008, {{1, 0x000F,  8}, {1, 0x000F,  4}}},
-		{&CPU::OP_SUBC       , H_WB                     , 0x8009, {{1, 0x000F,  8}, {1, 0x000F,  4}}},
+		{&CPU::OP_ADD        , H_WB                      | H_LF, 0x8001,  1, {{1, 0x000F,  8}, {1, 0x000F,  4}}},
+		{&CPU::OP_ADD        , H_WB                      | H_LF, 0x1000,  1, {{1, 0x000F,  8}, {0, 0x00FF,  0}}},
+		{&CPU::OP_ADD16      , H_WB                      | H_LF, 0xF006,  2, {{2, 0x000E,  8}, {2, 0x000E,  4}}},
+		{&CPU::OP_ADD16      , H_WB               | H_IE | H_LF, 0xE080,  2, {{2, 0x000E,  8}, {0, 0x007F,  0}}},
+		{&CPU::OP_ADDC       , H_WB                      | H_LF, 0x8006,  1, {{1, 0x000F,  8}, {1, 0x000F,  4}}},
+		{&CPU::OP_ADDC       , H_WB                      | H_LF, 0x6000,  1, {{1, 0x000F,  8}, {0, 0x00FF,  0}}},
+		{&CPU::OP_AND        , H_WB                      | H_LF, 0x8002,  1, {{1, 0x000F,  8}, {1, 0x000F,  4}}},
+		{&CPU::OP_AND        , H_WB                      | H_LF, 0x2000,  1, {{1, 0x000F,  8}, {0, 0x00FF,  0}}},
+		{&CPU::OP_SUB        ,                             H_LF, 0x8007,  1, {{1, 0x000F,  8}, {1, 0x000F,  4}}},
+		{&CPU::OP_SUB        ,                             H_LF, 0x7000,  1, {{1, 0x000F,  8}, {0, 0x00FF,  0}}},
+		{&CPU::OP_SUBC       ,                             H_LF, 0x8005,  1, {{1, 0x000F,  8}, {1, 0x000F,  4}}},
+		{&CPU::OP_SUBC       ,                             H_LF, 0x5000,  1, {{1, 0x000F,  8}, {0, 0x00FF,  0}}},
+		{&CPU::OP_MOV16      , H_WB                      | H_LF, 0xF005,  2, {{2, 0x000E,  8}, {2, 0x000E,  4}}},
+		{&CPU::OP_MOV16      , H_WB               | H_IE | H_LF, 0xE000,  2, {{2, 0x000E,  8}, {0, 0x007F,  0}}},
+		{&CPU::OP_MOV        , H_WB                      | H_LF, 0x8000,  1, {{1, 0x000F,  8}, {1, 0x000F,  4}}},
+		{&CPU::OP_MOV        , H_WB                      | H_LF, 0x0000,  1, {{1, 0x000F,  8}, {0, 0x00FF,  0}}},
+		{&CPU::OP_OR         , H_WB                      | H_LF, 0x8003,  1, {{1, 0x000F,  8}, {1, 0x000F,  4}}},
+		{&CPU::OP_OR         , H_WB                      | H_LF, 0x3000,  1, {{1, 0x000F,  8}, {0, 0x00FF,  0}}},
+		{&CPU::OP_XOR        , H_WB                      | H_LF, 0x8004,  1, {{1, 0x000F,  8}, {1, 0x000F,  4}}},
+		{&CPU::OP_XOR        , H_WB                      | H_LF, 0x4000,  1, {{1, 0x000F,  8}, {0, 0x00FF,  0}}},
+		{&CPU::OP_CMP16      ,                             H_LF, 0xF007,  2, {{2, 0x000E,  8}, {2, 0x000E,  4}}},
+		{&CPU::OP_SUB        , H_WB                      | H_LF, 0x8008,  1, {{1, 0x000F,  8}, {1, 0x000F,  4}}},
+		{&CPU::OP_SUBC       , H_WB                      | H_LF, 0x8009,  1, {{1, 0x000F,  8}, {1, 0x000F,  4}}},
 		// * Shift Instructions
-		{&CPU::OP_SLL        , H_WB                     , 0x800A, {{1, 0x000F,  8}, {1, 0x000F,  4}}},
-		{&CPU::OP_SLL        , H_WB                     , 0x900A, {{1, 0x000F,  8}, {0, 0x0007,  4}}},
-		{&CPU::OP_SLLC       , H_WB                     , 0x800B, {{1, 0x000F,  8}, {1, 0x000F,  4}}},
-		{&CPU::OP_SLLC       , H_WB                     , 0x900B, {{1, 0x000F,  8}, {0, 0x0007,  4}}},
-		{&CPU::OP_SRA        , H_WB                     , 0x800E, {{1, 0x000F,  8}, {1, 0x000F,  4}}},
-		{&CPU::OP_SRA        , H_WB                     , 0x900E, {{1, 0x000F,  8}, {0, 0x0007,  4}}},
-		{&CPU::OP_SRL        , H_WB                     , 0x800C, {{1, 0x000F,  8}, {1, 0x000F,  4}}},
-		{&CPU::OP_SRL        , H_WB                     , 0x900C, {{1, 0x000F,  8}, {0, 0x0007,  4}}},
-		{&CPU::OP_SRLC       , H_WB                     , 0x800D, {{1, 0x000F,  8}, {1, 0x000F,  4}}},
-		{&CPU::OP_SRLC       , H_WB                     , 0x900D, {{1, 0x000F,  8}, {0, 0x0007,  4}}},
+		{&CPU::OP_SLL        , H_WB                            , 0x800A,  1, {{1, 0x000F,  8}, {1, 0x000F,  4}}},
+		{&CPU::OP_SLL        , H_WB                            , 0x900A,  1, {{1, 0x000F,  8}, {0, 0x0007,  4}}},
+		{&CPU::OP_SLLC       , H_WB                            , 0x800B,  1, {{1, 0x000F,  8}, {1, 0x000F,  4}}},
+		{&CPU::OP_SLLC       , H_WB                            , 0x900B,  1, {{1, 0x000F,  8}, {0, 0x0007,  4}}},
+		{&CPU::OP_SRA        , H_WB                            , 0x800E,  1, {{1, 0x000F,  8}, {1, 0x000F,  4}}},
+		{&CPU::OP_SRA        , H_WB                            , 0x900E,  1, {{1, 0x000F,  8}, {0, 0x0007,  4}}},
+		{&CPU::OP_SRL        , H_WB                            , 0x800C,  1, {{1, 0x000F,  8}, {1, 0x000F,  4}}},
+		{&CPU::OP_SRL        , H_WB                            , 0x900C,  1, {{1, 0x000F,  8}, {0, 0x0007,  4}}},
+		{&CPU::OP_SRLC       , H_WB                            , 0x800D,  1, {{1, 0x000F,  8}, {1, 0x000F,  4}}},
+		{&CPU::OP_SRLC       , H_WB                            , 0x900D,  1, {{1, 0x000F,  8}, {0, 0x0007,  4}}},
 		// * Load/Store Instructions
-		{&CPU::OP_LS_EA      , 2 << 8                   , 0x9032, {{0, 0x000E,  8}, {0,      0,  0}}},
-		{&CPU::OP_LS_EA      , 2 << 8 |      H_IA       , 0x9052, {{0, 0x000E,  8}, {0,      0,  0}}},
-		{&CPU::OP_LS_R       , 2 << 8                   , 0x9002, {{0, 0x000E,  8}, {2, 0x000E,  4}}},
-		{&CPU::OP_LS_I_R     , 2 << 8 |      H_TI       , 0xA008, {{0, 0x000E,  8}, {2, 0x000E,  4}}},
-		{&CPU::OP_LS_BP      , 2 << 8 |                0, 0xB000, {{0, 0x000E,  8}, {0, 0x003F,  0}}},
-		{&CPU::OP_LS_FP      , 2 << 8 |                0, 0xB040, {{0, 0x000E,  8}, {0, 0x003F,  0}}},
-		{&CPU::OP_LS_I       , 2 << 8 |      H_TI       , 0x9012, {{0, 0x000E,  8}, {0,      0,  0}}},
-		{&CPU::OP_LS_EA      , 1 << 8                   , 0x9030, {{0, 0x000F,  8}, {0,      0,  0}}},
-		{&CPU::OP_LS_EA      , 1 << 8 |      H_IA       , 0x9050, {{0, 0x000F,  8}, {0,      0,  0}}},
-		{&CPU::OP_LS_R       , 1 << 8                   , 0x9000, {{0, 0x000F,  8}, {2, 0x000E,  4}}},
-		{&CPU::OP_LS_I_R     , 1 << 8 |      H_TI       , 0x9008, {{0, 0x000F,  8}, {2, 0x000E,  4}}},
-		{&CPU::OP_LS_BP      , 1 << 8 |                0, 0xD000, {{0, 0x000F,  8}, {0, 0x003F,  0}}},
-		{&CPU::OP_LS_FP      , 1 << 8 |                0, 0xD040, {{0, 0x000F,  8}, {0, 0x003F,  0}}},
-		{&CPU::OP_LS_I       , 1 << 8 |      H_TI       , 0x9010, {{0, 0x000F,  8}, {0,      0,  0}}},
-		{&CPU::OP_LS_EA      , 4 << 8                   , 0x9034, {{0, 0x000C,  8}, {0,      0,  0}}},
-		{&CPU::OP_LS_EA      , 4 << 8 |      H_IA       , 0x9054, {{0, 0x000C,  8}, {0,      0,  0}}},
-		{&CPU::OP_LS_EA      , 8 << 8                   , 0x9036, {{0, 0x0008,  8}, {0,      0,  0}}},
-		{&CPU::OP_LS_EA      , 8 << 8 |      H_IA       , 0x9056, {{0, 0x0008,  8}, {0,      0,  0}}},
-		{&CPU::OP_LS_EA      , 2 << 8 |             H_ST, 0x9033, {{0, 0x000E,  8}, {0,      0,  0}}},
-		{&CPU::OP_LS_EA      , 2 << 8 |      H_IA | H_ST, 0x9053, {{0, 0x000E,  8}, {0,      0,  0}}},
-		{&CPU::OP_LS_R       , 2 << 8 |             H_ST, 0x9003, {{0, 0x000E,  8}, {2, 0x000E,  4}}},
-		{&CPU::OP_LS_I_R     , 2 << 8 |      H_TI | H_ST, 0xA009, {{0, 0x000E,  8}, {2, 0x000E,  4}}},
-		{&CPU::OP_LS_BP      , 2 << 8 |             H_ST, 0xB080, {{0, 0x000E,  8}, {0, 0x003F,  0}}},
-		{&CPU::OP_LS_FP      , 2 << 8 |             H_ST, 0xB0C0, {{0, 0x000E,  8}, {0, 0x003F,  0}}},
-		{&CPU::OP_LS_I       , 2 << 8 |      H_TI | H_ST, 0x9013, {{0, 0x000E,  8}, {0,      0,  0}}},
-		{&CPU::OP_LS_EA      , 1 << 8 |             H_ST, 0x9031, {{0, 0x000F,  8}, {0,      0,  0}}},
-		{&CPU::OP_LS_EA      , 1 << 8 |      H_IA | H_ST, 0x9051, {{0, 0x000F,  8}, {0,      0,  0}}},
-		{&CPU::OP_LS_R       , 1 << 8 |             H_ST, 0x9001, {{0, 0x000F,  8}, {2, 0x000E,  4}}},
-		{&CPU::OP_LS_I_R     , 1 << 8 |      H_TI | H_ST, 0x9009, {{0, 0x000F,  8}, {2, 0x000E,  4}}},
-		{&CPU::OP_LS_BP      , 1 << 8 |             H_ST, 0xD080, {{0, 0x000F,  8}, {0, 0x003F,  0}}},
-		{&CPU::OP_LS_FP      , 1 << 8 |             H_ST, 0xD0C0, {{0, 0x000F,  8}, {0, 0x003F,  0}}},
-		{&CPU::OP_LS_I       , 1 << 8 |      H_TI | H_ST, 0x9011, {{0, 0x000F,  8}, {0,      0,  0}}},
-		{&CPU::OP_LS_EA      , 4 << 8 |             H_ST, 0x9035, {{0, 0x000C,  8}, {0,      0,  0}}},
-		{&CPU::OP_LS_EA      , 4 << 8 |      H_IA | H_ST, 0x9055, {{0, 0x000C,  8}, {0,      0,  0}}},
-		{&CPU::OP_LS_EA      , 8 << 8 |             H_ST, 0x9037, {{0, 0x0008,  8}, {0,      0,  0}}},
-		{&CPU::OP_LS_EA      , 8 << 8 |      H_IA | H_ST, 0x9057, {{0, 0x0008,  8}, {0,      0,  0}}},
+		{&CPU::OP_LS_EA      , 2 << 8                    | H_LF, 0x9032,  2, {{0, 0x000E,  8}, {0,      0,  0}}},
+		{&CPU::OP_LS_EA      , 2 << 8 |      H_IA        | H_LF, 0x9052,  2, {{0, 0x000E,  8}, {0,      0,  0}}},
+		{&CPU::OP_LS_R       , 2 << 8                    | H_LF, 0x9002,  2, {{0, 0x000E,  8}, {2, 0x000E,  4}}},
+		{&CPU::OP_LS_I_R     , 2 << 8 |      H_TI        | H_LF, 0xA008,  4, {{0, 0x000E,  8}, {2, 0x000E,  4}}},
+		{&CPU::OP_LS_BP      , 2 << 8 |                0 | H_LF, 0xB000,  3, {{0, 0x000E,  8}, {0, 0x003F,  0}}},
+		{&CPU::OP_LS_FP      , 2 << 8 |                0 | H_LF, 0xB040,  3, {{0, 0x000E,  8}, {0, 0x003F,  0}}},
+		{&CPU::OP_LS_I       , 2 << 8 |      H_TI        | H_LF, 0x9012,  3, {{0, 0x000E,  8}, {0,      0,  0}}},
+		{&CPU::OP_LS_EA      , 1 << 8                    | H_LF, 0x9030,  1, {{0, 0x000F,  8}, {0,      0,  0}}},
+		{&CPU::OP_LS_EA      , 1 << 8 |      H_IA        | H_LF, 0x9050,  1, {{0, 0x000F,  8}, {0,      0,  0}}},
+		{&CPU::OP_LS_R       , 1 << 8                    | H_LF, 0x9000,  1, {{0, 0x000F,  8}, {2, 0x000E,  4}}},
+		{&CPU::OP_LS_I_R     , 1 << 8 |      H_TI        | H_LF, 0x9008,  3, {{0, 0x000F,  8}, {2, 0x000E,  4}}},
+		{&CPU::OP_LS_BP      , 1 << 8 |                0 | H_LF, 0xD000,  2, {{0, 0x000F,  8}, {0, 0x003F,  0}}},
+		{&CPU::OP_LS_FP      , 1 << 8 |                0 | H_LF, 0xD040,  2, {{0, 0x000F,  8}, {0, 0x003F,  0}}},
+		{&CPU::OP_LS_I       , 1 << 8 |      H_TI        | H_LF, 0x9010,  2, {{0, 0x000F,  8}, {0,      0,  0}}},
+		{&CPU::OP_LS_EA      , 4 << 8                    | H_LF, 0x9034,  4, {{0, 0x000C,  8}, {0,      0,  0}}},
+		{&CPU::OP_LS_EA      , 4 << 8 |      H_IA        | H_LF, 0x9054,  4, {{0, 0x000C,  8}, {0,      0,  0}}},
+		{&CPU::OP_LS_EA      , 8 << 8                    | H_LF, 0x9036,  8, {{0, 0x0008,  8}, {0,      0,  0}}},
+		{&CPU::OP_LS_EA      , 8 << 8 |      H_IA        | H_LF, 0x9056,  8, {{0, 0x0008,  8}, {0,      0,  0}}},
+		{&CPU::OP_LS_EA      , 2 << 8 |             H_ST | H_LF, 0x9033,  2, {{0, 0x000E,  8}, {0,      0,  0}}},
+		{&CPU::OP_LS_EA      , 2 << 8 |      H_IA | H_ST | H_LF, 0x9053,  2, {{0, 0x000E,  8}, {0,      0,  0}}},
+		{&CPU::OP_LS_R       , 2 << 8 |             H_ST | H_LF, 0x9003,  2, {{0, 0x000E,  8}, {2, 0x000E,  4}}},
+		{&CPU::OP_LS_I_R     , 2 << 8 |      H_TI | H_ST | H_LF, 0xA009,  4, {{0, 0x000E,  8}, {2, 0x000E,  4}}},
+		{&CPU::OP_LS_BP      , 2 << 8 |             H_ST | H_LF, 0xB080,  3, {{0, 0x000E,  8}, {0, 0x003F,  0}}},
+		{&CPU::OP_LS_FP      , 2 << 8 |             H_ST | H_LF, 0xB0C0,  3, {{0, 0x000E,  8}, {0, 0x003F,  0}}},
+		{&CPU::OP_LS_I       , 2 << 8 |      H_TI | H_ST | H_LF, 0x9013,  3, {{0, 0x000E,  8}, {0,      0,  0}}},
+		{&CPU::OP_LS_EA      , 1 << 8 |             H_ST | H_LF, 0x9031,  1, {{0, 0x000F,  8}, {0,      0,  0}}},
+		{&CPU::OP_LS_EA      , 1 << 8 |      H_IA | H_ST | H_LF, 0x9051,  1, {{0, 0x000F,  8}, {0,      0,  0}}},
+		{&CPU::OP_LS_R       , 1 << 8 |             H_ST | H_LF, 0x9001,  1, {{0, 0x000F,  8}, {2, 0x000E,  4}}},
+		{&CPU::OP_LS_I_R     , 1 << 8 |      H_TI | H_ST | H_LF, 0x9009,  3, {{0, 0x000F,  8}, {2, 0x000E,  4}}},
+		{&CPU::OP_LS_BP      , 1 << 8 |             H_ST | H_LF, 0xD080,  2, {{0, 0x000F,  8}, {0, 0x003F,  0}}},
+		{&CPU::OP_LS_FP      , 1 << 8 |             H_ST | H_LF, 0xD0C0,  2, {{0, 0x000F,  8}, {0, 0x003F,  0}}},
+		{&CPU::OP_LS_I       , 1 << 8 |      H_TI | H_ST | H_LF, 0x9011,  2, {{0, 0x000F,  8}, {0,      0,  0}}},
+		{&CPU::OP_LS_EA      , 4 << 8 |             H_ST | H_LF, 0x9035,  4, {{0, 0x000C,  8}, {0,      0,  0}}},
+		{&CPU::OP_LS_EA      , 4 << 8 |      H_IA | H_ST | H_LF, 0x9055,  4, {{0, 0x000C,  8}, {0,      0,  0}}},
+		{&CPU::OP_LS_EA      , 8 << 8 |             H_ST | H_LF, 0x9037,  8, {{0, 0x0008,  8}, {0,      0,  0}}},
+		{&CPU::OP_LS_EA      , 8 << 8 |      H_IA | H_ST | H_LF, 0x9057,  8, {{0, 0x0008,  8}, {0,      0,  0}}},
 		// * Control Register Access Instructions
-		{&CPU::OP_ADDSP      ,                         0, 0xE100, {{0, 0x00FF,  0}, {0,      0,  0}}},
-		{&CPU::OP_CTRL       ,                    1 << 8, 0xA00F, {{0,      0,  0}, {1, 0x000F,  4}}},
-		{&CPU::OP_CTRL       ,                    2 << 8, 0xA00D, {{0,      0,  0}, {2, 0x000E,  8}}},
-		{&CPU::OP_CTRL       ,                    3 << 8, 0xA00C, {{0,      0,  0}, {1, 0x000F,  4}}},
-		{&CPU::OP_CTRL       , H_WB            |  4 << 8, 0xA005, {{2, 0x000E,  8}, {0,      0,  0}}},
-		{&CPU::OP_CTRL       , H_WB            |  5 << 8, 0xA01A, {{2, 0x000E,  8}, {0,      0,  0}}},
-		{&CPU::OP_CTRL       ,                    6 << 8, 0xA00B, {{0,      0,  0}, {1, 0x000F,  4}}},
-		{&CPU::OP_CTRL       ,                    7 << 8, 0xE900, {{0,      0,  0}, {0, 0x00FF,  0}}},
-		{&CPU::OP_CTRL       , H_WB            |  8 << 8, 0xA007, {{1, 0x000F,  8}, {0,      0,  0}}},
-		{&CPU::OP_CTRL       , H_WB            |  9 << 8, 0xA004, {{1, 0x000F,  8}, {0,      0,  0}}},
-		{&CPU::OP_CTRL       , H_WB            | 10 << 8, 0xA003, {{1, 0x000F,  8}, {0,      0,  0}}},
-		{&CPU::OP_CTRL       ,                   11 << 8, 0xA10A, {{0,      0,  0}, {2, 0x000E,  4}}},
+		{&CPU::OP_ADDSP      ,                         0       , 0xE100,  2, {{0, 0x00FF,  0}, {0,      0,  0}}},
+		{&CPU::OP_CTRL       ,                    1 << 8       , 0xA00F,  1, {{0,      0,  0}, {1, 0x000F,  4}}},
+		{&CPU::OP_CTRL       ,                    2 << 8       , 0xA00D,  2, {{0,      0,  0}, {2, 0x000E,  8}}},
+		{&CPU::OP_CTRL       ,                    3 << 8       , 0xA00C,  1, {{0,      0,  0}, {1, 0x000F,  4}}},
+		{&CPU::OP_CTRL       , H_WB            |  4 << 8       , 0xA005,  2, {{2, 0x000E,  8}, {0,      0,  0}}},
+		{&CPU::OP_CTRL       , H_WB            |  5 << 8       , 0xA01A,  2, {{2, 0x000E,  8}, {0,      0,  0}}},
+		{&CPU::OP_CTRL       ,                    6 << 8       , 0xA00B,  1, {{0,      0,  0}, {1, 0x000F,  4}}},
+		{&CPU::OP_CTRL       ,                    7 << 8       , 0xE900,  1, {{0,      0,  0}, {0, 0x00FF,  0}}},
+		{&CPU::OP_CTRL       , H_WB            |  8 << 8       , 0xA007,  1, {{1, 0x000F,  8}, {0,      0,  0}}},
+		{&CPU::OP_CTRL       , H_WB            |  9 << 8       , 0xA004,  1, {{1, 0x000F,  8}, {0,      0,  0}}},
+		{&CPU::OP_CTRL       , H_WB            | 10 << 8       , 0xA003,  1, {{1, 0x000F,  8}, {0,      0,  0}}},
+		{&CPU::OP_CTRL       ,                   11 << 8       , 0xA10A,  2, {{0,      0,  0}, {2, 0x000E,  4}}},
 		// * PUSH/POP Instructions
-		{&CPU::OP_PUSH       ,                         0, 0xF05E, {{0,      0,  0}, {2, 0x000E,  8}}},
-		{&CPU::OP_PUSH       ,                         0, 0xF07E, {{0,      0,  0}, {8, 0x0008,  8}}},
-		{&CPU::OP_PUSH       ,                         0, 0xF04E, {{0,      0,  0}, {1, 0x000F,  8}}},
-		{&CPU::OP_PUSH       ,                         0, 0xF06E, {{0,      0,  0}, {4, 0x000C,  8}}},
-		{&CPU::OP_PUSHL      ,                         0, 0xF0CE, {{0,      0,  0}, {0, 0x000F,  8}}},
-		{&CPU::OP_POP        , H_WB                     , 0xF01E, {{2, 0x000E,  8}, {0,      0,  0}}},
-		{&CPU::OP_POP        , H_WB                     , 0xF03E, {{8, 0x0008,  8}, {0,      0,  0}}},
-		{&CPU::OP_POP        , H_WB                     , 0xF00E, {{1, 0x000F,  8}, {0,      0,  0}}},
-		{&CPU::OP_POP        , H_WB                     , 0xF02E, {{4, 0x000C,  8}, {0,      0,  0}}},
-		{&CPU::OP_POPL       ,                         0, 0xF08E, {{0, 0x000F,  8}, {0,      0,  0}}},
+		{&CPU::OP_PUSH       ,                         0       , 0xF05E,  2, {{0,      0,  0}, {2, 0x000E,  8}}},
+		{&CPU::OP_PUSH       ,                         0       , 0xF07E,  8, {{0,      0,  0}, {8, 0x0008,  8}}},
+		{&CPU::OP_PUSH       ,                         0       , 0xF04E,  1, {{0,      0,  0}, {1, 0x000F,  8}}},
+		{&CPU::OP_PUSH       ,                         0       , 0xF06E,  4, {{0,      0,  0}, {4, 0x000C,  8}}},
+		{&CPU::OP_PUSHL      ,                         0       , 0xF0CE,  1, {{0,      0,  0}, {0, 0x000F,  8}}},
+		{&CPU::OP_POP        , H_WB                            , 0xF01E,  2, {{2, 0x000E,  8}, {0,      0,  0}}},
+		{&CPU::OP_POP        , H_WB                            , 0xF03E,  8, {{8, 0x0008,  8}, {0,      0,  0}}},
+		{&CPU::OP_POP        , H_WB                            , 0xF00E,  1, {{1, 0x000F,  8}, {0,      0,  0}}},
+		{&CPU::OP_POP        , H_WB                            , 0xF02E,  4, {{4, 0x000C,  8}, {0,      0,  0}}},
+		{&CPU::OP_POPL       ,                         0       , 0xF08E,  1, {{0, 0x000F,  8}, {0,      0,  0}}},
 		// * Coprocessor Data Transfer Instructions
-		{&CPU::OP_CR_R       ,                         0, 0xA00E, {{0, 0x000F,  8}, {0, 0x000F,  4}}},
-		{&CPU::OP_CR_EA      ,      2 << 8 |           0, 0xF02D, {{0,      0,  0}, {0, 0x000E,  8}}},
-		{&CPU::OP_CR_EA      ,      2 << 8 | H_IA       , 0xF03D, {{0,      0,  0}, {0, 0x000E,  8}}},
-		{&CPU::OP_CR_EA      ,      1 << 8 |           0, 0xF00D, {{0,      0,  0}, {0, 0x000F,  8}}},
-		{&CPU::OP_CR_EA      ,      1 << 8 | H_IA       , 0xF01D, {{0,      0,  0}, {0, 0x000F,  8}}},
-		{&CPU::OP_CR_EA      ,      4 << 8 |           0, 0xF04D, {{0,      0,  0}, {0, 0x000C,  8}}},
-		{&CPU::OP_CR_EA      ,      4 << 8 | H_IA       , 0xF05D, {{0,      0,  0}, {0, 0x000C,  8}}},
-		{&CPU::OP_CR_EA      ,      8 << 8 |           0, 0xF06D, {{0,      0,  0}, {0, 0x0008,  8}}},
-		{&CPU::OP_CR_EA      ,      8 << 8 | H_IA       , 0xF07D, {{0,      0,  0}, {0, 0x0008,  8}}},
-		{&CPU::OP_CR_R       ,                      H_ST, 0xA006, {{0, 0x000F,  8}, {0, 0x000F,  4}}},
-		{&CPU::OP_CR_EA      ,      2 << 8 |        H_ST, 0xF0AD, {{0, 0x000E,  8}, {0,      0,  0}}},
-		{&CPU::OP_CR_EA      ,      2 << 8 | H_IA | H_ST, 0xF0BD, {{0, 0x000E,  8}, {0,      0,  0}}},
-		{&CPU::OP_CR_EA      ,      1 << 8 |        H_ST, 0xF08D, {{0, 0x000F,  8}, {0,      0,  0}}},
-		{&CPU::OP_CR_EA      ,      1 << 8 | H_IA | H_ST, 0xF09D, {{0, 0x000F,  8}, {0,      0,  0}}},
-		{&CPU::OP_CR_EA      ,      4 << 8 |        H_ST, 0xF0CD, {{0, 0x000C,  8}, {0,      0,  0}}},
-		{&CPU::OP_CR_EA      ,      4 << 8 | H_IA | H_ST, 0xF0DD, {{0, 0x000C,  8}, {0,      0,  0}}},
-		{&CPU::OP_CR_EA      ,      8 << 8 |        H_ST, 0xF0ED, {{0, 0x0008,  8}, {0,      0,  0}}},
-		{&CPU::OP_CR_EA      ,      8 << 8 | H_IA | H_ST, 0xF0FD, {{0, 0x0008,  8}, {0,      0,  0}}},
+		{&CPU::OP_CR_R       ,                         0       , 0xA00E,  1, {{0, 0x000F,  8}, {0, 0x000F,  4}}},
+		{&CPU::OP_CR_EA      ,      2 << 8 |           0       , 0xF02D,  2, {{0,      0,  0}, {0, 0x000E,  8}}},
+		{&CPU::OP_CR_EA      ,      2 << 8 | H_IA              , 0xF03D,  2, {{0,      0,  0}, {0, 0x000E,  8}}},
+		{&CPU::OP_CR_EA      ,      1 << 8 |           0       , 0xF00D,  1, {{0,      0,  0}, {0, 0x000F,  8}}},
+		{&CPU::OP_CR_EA      ,      1 << 8 | H_IA              , 0xF01D,  1, {{0,      0,  0}, {0, 0x000F,  8}}},
+		{&CPU::OP_CR_EA      ,      4 << 8 |           0       , 0xF04D,  4, {{0,      0,  0}, {0, 0x000C,  8}}},
+		{&CPU::OP_CR_EA      ,      4 << 8 | H_IA              , 0xF05D,  4, {{0,      0,  0}, {0, 0x000C,  8}}},
+		{&CPU::OP_CR_EA      ,      8 << 8 |           0       , 0xF06D,  8, {{0,      0,  0}, {0, 0x0008,  8}}},
+		{&CPU::OP_CR_EA      ,      8 << 8 | H_IA              , 0xF07D,  8, {{0,      0,  0}, {0, 0x0008,  8}}},
+		{&CPU::OP_CR_R       ,                      H_ST       , 0xA006,  1, {{0, 0x000F,  8}, {0, 0x000F,  4}}},
+		{&CPU::OP_CR_EA      ,      2 << 8 |        H_ST       , 0xF0AD,  2, {{0, 0x000E,  8}, {0,      0,  0}}},
+		{&CPU::OP_CR_EA      ,      2 << 8 | H_IA | H_ST       , 0xF0BD,  2, {{0, 0x000E,  8}, {0,      0,  0}}},
+		{&CPU::OP_CR_EA      ,      1 << 8 |        H_ST       , 0xF08D,  1, {{0, 0x000F,  8}, {0,      0,  0}}},
+		{&CPU::OP_CR_EA      ,      1 << 8 | H_IA | H_ST       , 0xF09D,  1, {{0, 0x000F,  8}, {0,      0,  0}}},
+		{&CPU::OP_CR_EA      ,      4 << 8 |        H_ST       , 0xF0CD,  4, {{0, 0x000C,  8}, {0,      0,  0}}},
+		{&CPU::OP_CR_EA      ,      4 << 8 | H_IA | H_ST       , 0xF0DD,  4, {{0, 0x000C,  8}, {0,      0,  0}}},
+		{&CPU::OP_CR_EA      ,      8 << 8 |        H_ST       , 0xF0ED,  8, {{0, 0x0008,  8}, {0,      0,  0}}},
+		{&CPU::OP_CR_EA      ,      8 << 8 | H_IA | H_ST       , 0xF0FD,  8, {{0, 0x0008,  8}, {0,      0,  0}}},
 		// * EA Register Data Transfer Instructions
-		{&CPU::OP_LEA        ,                         0, 0xF00A, {{0,      0,  0}, {2, 0x000E,  4}}},
-		{&CPU::OP_LEA        ,        H_TI              , 0xF00B, {{0,      0,  0}, {2, 0x000E,  4}}},
-		{&CPU::OP_LEA        ,        H_TI              , 0xF00C, {{0,      0,  0}, {0,      0,  0}}},
+		{&CPU::OP_LEA        ,                         0       , 0xF00A,  1, {{0,      0,  0}, {2, 0x000E,  4}}},
+		{&CPU::OP_LEA        ,        H_TI                     , 0xF00B,  2, {{0,      0,  0}, {2, 0x000E,  4}}},
+		{&CPU::OP_LEA        ,        H_TI                     , 0xF00C,  2, {{0,      0,  0}, {0,      0,  0}}},
 		// * ALU Instructions
-		{&CPU::OP_DAA        , H_WB                     , 0x801F, {{1, 0x000F,  8}, {0,      0,  0}}},
-		{&CPU::OP_DAS        , H_WB                     , 0x803F, {{1, 0x000F,  8}, {0,      0,  0}}},
-		{&CPU::OP_NEG        , H_WB                     , 0x805F, {{1, 0x000F,  8}, {0,      0,  0}}},
+		{&CPU::OP_DAA        , H_WB                            , 0x801F,  1, {{1, 0x000F,  8}, {0,      0,  0}}},
+		{&CPU::OP_DAS        , H_WB                            , 0x803F,  1, {{1, 0x000F,  8}, {0,      0,  0}}},
+		{&CPU::OP_NEG        , H_WB                            , 0x805F,  1, {{1, 0x000F,  8}, {0,      0,  0}}},
 		// * Bit Access Instructions
-		{&CPU::OP_BITMOD     ,                         0, 0xA000, {{0, 0x000F,  8}, {0, 0x0007,  4}}},
-		{&CPU::OP_BITMOD     ,        H_TI              , 0xA080, {{0,      0,  0}, {0, 0x0007,  4}}},
-		{&CPU::OP_BITMOD     ,                         0, 0xA002, {{0, 0x000F,  8}, {0, 0x0007,  4}}},
-		{&CPU::OP_BITMOD     ,        H_TI              , 0xA082, {{0,      0,  0}, {0, 0x0007,  4}}},
-		{&CPU::OP_BITMOD     ,                         0, 0xA001, {{0, 0x000F,  8}, {0, 0x0007,  4}}},
-		{&CPU::OP_BITMOD     ,        H_TI              , 0xA081, {{0,      0,  0}, {0, 0x0007,  4}}},
+		{&CPU::OP_BITMOD     ,                         0       , 0xA000,  1, {{0, 0x000F,  8}, {0, 0x0007,  4}}},
+		{&CPU::OP_BITMOD     ,        H_TI                     , 0xA080,  2, {{0,      0,  0}, {0, 0x0007,  4}}},
+		{&CPU::OP_BITMOD     ,                         0       , 0xA002,  1, {{0, 0x000F,  8}, {0, 0x0007,  4}}},
+		{&CPU::OP_BITMOD     ,        H_TI                     , 0xA082,  2, {{0,      0,  0}, {0, 0x0007,  4}}},
+		{&CPU::OP_BITMOD     ,                         0       , 0xA001,  1, {{0, 0x000F,  8}, {0, 0x0007,  4}}},
+		{&CPU::OP_BITMOD     ,        H_TI                     , 0xA081,  2, {{0,      0,  0}, {0, 0x0007,  4}}},
 		// * PSW Access Instructions
-		{&CPU::OP_PSW_OR     ,                         0, 0xED08, {{0,      0,  0}, {0,      0,  0}}},
-		{&CPU::OP_PSW_AND    ,                         0, 0xEBF7, {{0,      0,  0}, {0,      0,  0}}},
-		{&CPU::OP_PSW_OR     ,                         0, 0xED80, {{0,      0,  0}, {0,      0,  0}}},
-		{&CPU::OP_PSW_AND    ,                         0, 0xEB7F, {{0,      0,  0}, {0,      0,  0}}},
-		{&CPU::OP_CPLC       ,                         0, 0xFECF, {{0,      0,  0}, {0,      0,  0}}},
+		{&CPU::OP_PSW_OR     ,                         0       , 0xED08,  1, {{0,      0,  0}, {0,      0,  0}}},
+		{&CPU::OP_PSW_AND    ,                         0       , 0xEBF7,  1, {{0,      0,  0}, {0,      0,  0}}},
+		{&CPU::OP_PSW_OR     ,                         0       , 0xED80,  1, {{0,      0,  0}, {0,      0,  0}}},
+		{&CPU::OP_PSW_AND    ,                         0       , 0xEB7F,  1, {{0,      0,  0}, {0,      0,  0}}},
+		{&CPU::OP_CPLC       ,                         0       , 0xFECF,  1, {{0,      0,  0}, {0,      0,  0}}},
 		// * Conditional Relative Branch Instructions
-		{&CPU::OP_BC         ,                         0, 0xC000, {{0, 0x00FF,  0}, {0,      0,  0}}},
-		{&CPU::OP_BC         ,                         0, 0xC100, {{0, 0x00FF,  0}, {0,      0,  0}}},
-		{&CPU::OP_BC         ,                         0, 0xC200, {{0, 0x00FF,  0}, {0,      0,  0}}},
-		{&CPU::OP_BC         ,                         0, 0xC300, {{0, 0x00FF,  0}, {0,      0,  0}}},
-		{&CPU::OP_BC         ,                         0, 0xC400, {{0, 0x00FF,  0}, {0,      0,  0}}},
-		{&CPU::OP_BC         ,                         0, 0xC500, {{0, 0x00FF,  0}, {0,      0,  0}}},
-		{&CPU::OP_BC         ,                         0, 0xC600, {{0, 0x00FF,  0}, {0,      0,  0}}},
-		{&CPU::OP_BC         ,                         0, 0xC700, {{0, 0x00FF,  0}, {0,      0,  0}}},
-		{&CPU::OP_BC         ,                         0, 0xC800, {{0, 0x00FF,  0}, {0,      0,  0}}},
-		{&CPU::OP_BC         ,                         0, 0xC900, {{0, 0x00FF,  0}, {0,      0,  0}}},
-		{&CPU::OP_BC         ,                         0, 0xCA00, {{0, 0x00FF,  0}, {0,      0,  0}}},
-		{&CPU::OP_BC         ,                         0, 0xCB00, {{0, 0x00FF,  0}, {0,      0,  0}}},
-		{&CPU::OP_BC         ,                         0, 0xCC00, {{0, 0x00FF,  0}, {0,      0,  0}}},
-		{&CPU::OP_BC         ,                         0, 0xCD00, {{0, 0x00FF,  0}, {0,      0,  0}}},
-		{&CPU::OP_BC         ,                         0, 0xCE00, {{0, 0x00FF,  0}, {0,      0,  0}}},
+		{&CPU::OP_BC         ,                         0       , 0xC000,  1, {{0, 0x00FF,  0}, {0,      0,  0}}},
+		{&CPU::OP_BC         ,                         0       , 0xC100,  1, {{0, 0x00FF,  0}, {0,      0,  0}}},
+		{&CPU::OP_BC         ,                         0       , 0xC200,  1, {{0, 0x00FF,  0}, {0,      0,  0}}},
+		{&CPU::OP_BC         ,                         0       , 0xC300,  1, {{0, 0x00FF,  0}, {0,      0,  0}}},
+		{&CPU::OP_BC         ,                         0       , 0xC400,  1, {{0, 0x00FF,  0}, {0,      0,  0}}},
+		{&CPU::OP_BC         ,                         0       , 0xC500,  1, {{0, 0x00FF,  0}, {0,      0,  0}}},
+		{&CPU::OP_BC         ,                         0       , 0xC600,  1, {{0, 0x00FF,  0}, {0,      0,  0}}},
+		{&CPU::OP_BC         ,                         0       , 0xC700,  1, {{0, 0x00FF,  0}, {0,      0,  0}}},
+		{&CPU::OP_BC         ,                         0       , 0xC800,  1, {{0, 0x00FF,  0}, {0,      0,  0}}},
+		{&CPU::OP_BC         ,                         0       , 0xC900,  1, {{0, 0x00FF,  0}, {0,      0,  0}}},
+		{&CPU::OP_BC         ,                         0       , 0xCA00,  1, {{0, 0x00FF,  0}, {0,      0,  0}}},
+		{&CPU::OP_BC         ,                         0       , 0xCB00,  1, {{0, 0x00FF,  0}, {0,      0,  0}}},
+		{&CPU::OP_BC         ,                         0       , 0xCC00,  1, {{0, 0x00FF,  0}, {0,      0,  0}}},
+		{&CPU::OP_BC         ,                         0       , 0xCD00,  1, {{0, 0x00FF,  0}, {0,      0,  0}}},
+		{&CPU::OP_BC         ,                         0       , 0xCE00,  1, {{0, 0x00FF,  0}, {0,      0,  0}}},
 		// * Sign Extension Instruction
-		{&CPU::OP_EXTBW      ,                         0, 0x810F, {{0,      0,  0}, {0,      0,  0}}},
-		{&CPU::OP_EXTBW      ,                         0, 0x832F, {{0,      0,  0}, {0,      0,  0}}},
-		{&CPU::OP_EXTBW      ,                         0, 0x854F, {{0,      0,  0}, {0,      0,  0}}},
-		{&CPU::OP_EXTBW      ,                         0, 0x876F, {{0,      0,  0}, {0,      0,  0}}},
-		{&CPU::OP_EXTBW      ,                         0, 0x898F, {{0,      0,  0}, {0,      0,  0}}},
-		{&CPU::OP_EXTBW      ,                         0, 0x8BAF, {{0,      0,  0}, {0,      0,  0}}},
-		{&CPU::OP_EXTBW      ,                         0, 0x8DCF, {{0,      0,  0}, {0,      0,  0}}},
-		{&CPU::OP_EXTBW      ,                         0, 0x8FEF, {{0,      0,  0}, {0,      0,  0}}},
+		{&CPU::OP_EXTBW      ,                         0       , 0x810F,  1, {{0,      0,  0}, {0,      0,  0}}},
+		{&CPU::OP_EXTBW      ,                         0       , 0x832F,  1, {{0,      0,  0}, {0,      0,  0}}},
+		{&CPU::OP_EXTBW      ,                         0       , 0x854F,  1, {{0,      0,  0}, {0,      0,  0}}},
+		{&CPU::OP_EXTBW      ,                         0       , 0x876F,  1, {{0,      0,  0}, {0,      0,  0}}},
+		{&CPU::OP_EXTBW      ,                         0       , 0x898F,  1, {{0,      0,  0}, {0,      0,  0}}},
+		{&CPU::OP_EXTBW      ,                         0       , 0x8BAF,  1, {{0,      0,  0}, {0,      0,  0}}},
+		{&CPU::OP_EXTBW      ,                         0       , 0x8DCF,  1, {{0,      0,  0}, {0,      0,  0}}},
+		{&CPU::OP_EXTBW      ,                         0       , 0x8FEF,  1, {{0,      0,  0}, {0,      0,  0}}},
 		// * Software Interrupt Instructions
-		{&CPU::OP_SWI        ,                         0, 0xE500, {{0, 0x00FF,  0}, {0,      0,  0}}},
-		{&CPU::OP_BRK        ,                         0, 0xFFFF, {{0,      0,  0}, {0,      0,  0}}},
+		{&CPU::OP_SWI        ,                         0       , 0xE500,  3, {{0, 0x00FF,  0}, {0,      0,  0}}},
+		{&CPU::OP_BRK        ,                         0       , 0xFFFF,  3, {{0,      0,  0}, {0,      0,  0}}},
 		// * Branch Instructions
-		{&CPU::OP_B          ,        H_TI              , 0xF000, {{0,      0,  0}, {0, 0x000F,  8}}},
-		{&CPU::OP_B          ,                         0, 0xF002, {{0,      0,  0}, {2, 0x000E,  4}}},
-		{&CPU::OP_BL         ,        H_TI              , 0xF001, {{0,      0,  0}, {0, 0x000F,  8}}},
-		{&CPU::OP_BL         ,                         0, 0xF003, {{0,      0,  0}, {2, 0x000E,  4}}},
+		{&CPU::OP_B          ,        H_TI                     , 0xF000,  2, {{0,      0,  0}, {0, 0x000F,  8}}},
+		{&CPU::OP_B          ,                         0       , 0xF002,  2, {{0,      0,  0}, {2, 0x000E,  4}}},
+		{&CPU::OP_BL         ,        H_TI                     , 0xF001,  2, {{0,      0,  0}, {0, 0x000F,  8}}},
+		{&CPU::OP_BL         ,                         0       , 0xF003,  2, {{0,      0,  0}, {2, 0x000E,  4}}},
 		// * Multiplication and Division Instructions
-		{&CPU::OP_MUL        , H_WB                     , 0xF004, {{2, 0x000E,  8}, {1, 0x000F,  4}}},
-		{&CPU::OP_DIV        , H_WB                     , 0xF009, {{2, 0x000E,  8}, {1, 0x000F,  4}}},
+		{&CPU::OP_MUL        , H_WB                            , 0xF004,  9, {{2, 0x000E,  8}, {1, 0x000F,  4}}},
+		{&CPU::OP_DIV        , H_WB                            , 0xF009, 17, {{2, 0x000E,  8}, {1, 0x000F,  4}}},
 		// * Miscellaneous Instructions
-		{&CPU::OP_INC_EA     ,                         0, 0xFE2F, {{0,      0,  0}, {0,      0,  0}}},
-		{&CPU::OP_DEC_EA     ,                         0, 0xFE3F, {{0,      0,  0}, {0,      0,  0}}},
-		{&CPU::OP_RT         ,                         0, 0xFE1F, {{0,      0,  0}, {0,      0,  0}}},
-		{&CPU::OP_RTI        ,                         0, 0xFE0F, {{0,      0,  0}, {0,      0,  0}}},
-		{&CPU::OP_NOP        ,                         0, 0xFE8F, {{0,      0,  0}, {0,      0,  0}}},
-		{&CPU::OP_DSR        ,               H_DS       , 0xFE9F, {{0,      0,  0}, {0,      0,  0}}},
-		{&CPU::OP_DSR        ,               H_DS | H_DW, 0xE300, {{0, 0x00FF,  0}, {0,      0,  0}}},
-		{&CPU::OP_DSR        ,               H_DS | H_DW, 0x900F, {{1, 0x000F,  4}, {0,      0,  0}}},
+		{&CPU::OP_INC_EA     ,                         0       , 0xFE2F,  2, {{0,      0,  0}, {0,      0,  0}}},
+		{&CPU::OP_DEC_EA     ,                         0       , 0xFE3F,  2, {{0,      0,  0}, {0,      0,  0}}},
+		{&CPU::OP_RT         ,                         0       , 0xFE1F,  2, {{0,      0,  0}, {0,      0,  0}}},
+		{&CPU::OP_RTI        ,                         0       , 0xFE0F,  2, {{0,      0,  0}, {0,      0,  0}}},
+		{&CPU::OP_NOP        ,                         0       , 0xFE8F,  1, {{0,      0,  0}, {0,      0,  0}}},
+		{&CPU::OP_DSR        ,               H_DS              , 0xFE9F,  1, {{0,      0,  0}, {0,      0,  0}}},
+		{&CPU::OP_DSR        ,               H_DS | H_DW       , 0xE300,  1, {{0, 0x00FF,  0}, {0,      0,  0}}},
+		{&CPU::OP_DSR        ,               H_DS | H_DW       , 0x900F,  1, {{1, 0x000F,  4}, {0,      0,  0}}},
 
 		// * Undocumented Instructions
-		{&CPU::OP_RTICE      ,                         0, 0xFE6F, {{0,      0,  0}, {0,      0,  0}}}, // RTICE
-		{&CPU::OP_RTICE      ,                         0, 0xFE7F, {{0,      0,  0}, {0,      0,  0}}}, // RTICEPSW 
-		{&CPU::OP_ICESWI     ,                         0, 0xFEFF, {{0,      0,  0}, {0,      0,  0}}}, // ICESWI
-		{&CPU::OP_NOP        ,                         0, 0xFE4F, {{0,      0,  0}, {0,      0,  0}}}, // NOP
-		{&CPU::OP_NOP        ,                         0, 0xFE5F, {{0,      0,  0}, {0,      0,  0}}}, // NOP
-		{&CPU::OP_NOP        ,                         0, 0xFE8F, {{0,      0,  0}, {0,      0,  0}}}, // NOP
-		{&CPU::OP_NOP        ,                         0, 0xFEAF, {{0,      0,  0}, {0,      0,  0}}}, // NOP
-		{&CPU::OP_NOP        ,                         0, 0xFEBF, {{0,      0,  0}, {0,      0,  0}}}, // NOP
-		{&CPU::OP_NOP        ,                         0, 0xFEDF, {{0,      0,  0}, {0,      0,  0}}}, // NOP
-		{&CPU::OP_NOP        ,                         0, 0xFEEF, {{0,      0,  0}, {0,      0,  0}}}, // NOP
+		{&CPU::OP_RTICE      ,                         0       , 0xFE6F,  2, {{0,      0,  0}, {0,      0,  0}}}, // RTICE
+		{&CPU::OP_RTICE      ,                         0       , 0xFE7F,  2, {{0,      0,  0}, {0,      0,  0}}}, // RTICEPSW 
+		{&CPU::OP_ICESWI     ,                         0       , 0xFEFF,  3, {{0,      0,  0}, {0,      0,  0}}}, // ICESWI
+		{&CPU::OP_NOP        ,                         0       , 0xFE4F,  1, {{0,      0,  0}, {0,      0,  0}}}, // NOP
+		{&CPU::OP_NOP        ,                         0       , 0xFE5F,  1, {{0,      0,  0}, {0,      0,  0}}}, // NOP
+		{&CPU::OP_NOP        ,                         0       , 0xFE8F,  1, {{0,      0,  0}, {0,      0,  0}}}, // NOP
+		{&CPU::OP_NOP        ,                         0       , 0xFEAF,  1, {{0,      0,  0}, {0,      0,  0}}}, // NOP
+		{&CPU::OP_NOP        ,                         0       , 0xFEBF,  1, {{0,      0,  0}, {0,      0,  0}}}, // NOP
+		{&CPU::OP_NOP        ,                         0       , 0xFEDF,  1, {{0,      0,  0}, {0,      0,  0}}}, // NOP
+		{&CPU::OP_NOP        ,                         0       , 0xFEEF,  1, {{0,      0,  0}, {0,      0,  0}}}, // NOP
 
 	};
 
 	// clang-format on
 
 	CPU::RegisterRecord CPU::register_record_sources[] = {
-		{    "r", 16, 0, nullptr,    (RegisterStubArrayPointer)&CPU::reg_r},
 		{   "cr", 16, 0, nullptr,   (RegisterStubArrayPointer)&CPU::reg_cr},
 		{   "pc",  1, 0,        (RegisterStubPointer)&CPU::reg_pc, nullptr},
 		{  "csr",  1, 0,       (RegisterStubPointer)&CPU::reg_csr, nullptr},
@@ -248,9 +363,14 @@ namespace casioemu {
 	}
 
 	CPU::CPU(Emulator& _emulator) : emulator(_emulator), reg_lr(reg_elr[0]), reg_lcsr(reg_ecsr[0]), reg_psw(reg_epsw[0]) {
-		opcode_dispatch = new OpcodeSource*[0x10000];
+		opcode_dispatch = new const OpcodeSource*[0x10000];
 		for (size_t ix = 0; ix != 0x10000; ++ix)
 			opcode_dispatch[ix] = nullptr;
+
+		decode_generation = 1;
+		block_generation = 0;
+		lazy_flags = 0;
+		impl_cycles = 0;
 	}
 
 	CPU::~CPU() {
@@ -268,12 +388,18 @@ namespace casioemu {
 		dsr_mask = emulator.hardware_id == HW_CLASSWIZ ? 0x1F : 0xFF;
 
 		fetch_addition = 2;
+
+		block_engine = emulator.argv_map.find("block_engine") != emulator.argv_map.end();
+
+		decode_cache.clear();
+		decode_cache.resize((size_t)impl_csr_mask + 1);
+		InvalidateDecodeCache();
 	}
 
 	void CPU::SetupOpcodeDispatch() {
 		uint16_t* permutation_buffer = new uint16_t[0x10000];
 		for (size_t ix = 0; ix != sizeof(opcode_sources) / sizeof(opcode_sources[0]); ++ix) {
-			OpcodeSource& handler_stub = opcode_sources[ix];
+			const OpcodeSource& handler_stub = opcode_sources[ix];
 
 			uint16_t varying_bits = 0;
 			for (size_t ox = 0; ox != sizeof(impl_operands) / sizeof(impl_operands[0]); ++ox)
@@ -299,28 +425,30 @@ namespace casioemu {
 	}
 
 	void CPU::SetupRegisterProxies() {
+		for (size_t ix = 0; ix != 16; ++ix) {
+			register_proxies["r" + std::to_string(ix)] = {&reg_r[ix], 1};
+			if (ix % 2 == 0)
+				register_proxies["er" + std::to_string(ix)] = {&reg_er[ix >> 1], 2};
+			if (ix % 4 == 0)
+				register_proxies["xr" + std::to_string(ix)] = {&reg_xr[ix >> 2], 4};
+			if (ix % 8 == 0)
+				register_proxies["qr" + std::to_string(ix)] = {&reg_qr[ix >> 3], 8};
+		}
+
 		for (size_t ix = 0; ix != sizeof(register_record_sources) / sizeof(register_record_sources[0]); ++ix) {
 			RegisterRecord& record = register_record_sources[ix];
 
-			if (record.stub) {
-				RegisterStub* register_stub = &(this->*record.stub);
-				register_stub->name = record.name;
-				register_proxies[record.name] = register_stub;
-			}
+			if (record.stub)
+				register_proxies[record.name] = {&(this->*record.stub).raw, sizeof(RegisterStub::raw)};
 
 			if (record.stub_array) {
-				if (record.array_size == 1) {
-					RegisterStub* register_stub = &(this->*record.stub_array)[record.array_base];
-					register_stub->name = record.name;
-					register_proxies[record.name] = register_stub;
-				}
+				if (record.array_size == 1)
+					register_proxies[record.name] = {&(this->*record.stub_array)[record.array_base].raw, sizeof(RegisterStub::raw)};
 				else {
 					for (size_t rx = 0; rx != record.array_size; ++rx) {
 						std::stringstream ss;
 						ss << record.name << rx;
-						RegisterStub* register_stub = &(this->*record.stub_array)[rx];
-						register_stub->name = ss.str();
-						register_proxies[ss.str()] = register_stub;
+						register_proxies[ss.str()] = {&(this->*record.stub_array)[rx].raw, sizeof(RegisterStub::raw)};
 					}
 				}
 			}
@@ -338,7 +466,86 @@ namespace casioemu {
 		return opcode;
 	}
 
-	void CPU::Next() {
+	void CPU::InvalidateDecodeCache() {
+		if (++decode_generation == 0) {
+			// The counter wrapped around, so stale entries could look valid again.
+			for (auto& page : decode_cache)
+				page.reset();
+			decode_generation = 1;
+			block_generation = 0;
+		}
+	}
+
+	void CPU::DecodeAt(DecodedInstruction& decoded) {
+		uint16_t pc_before = reg_pc.raw;
+
+		decoded.opcode = Fetch();
+		decoded.handler = opcode_dispatch[decoded.opcode];
+		decoded.long_imm = 0;
+		decoded.fused = 0;
+		if (decoded.handler) {
+			if (decoded.handler->hint & H_TI)
+				decoded.long_imm = Fetch();
+
+			for (size_t ix = 0; ix != sizeof(decoded.operands) / sizeof(decoded.operands[0]); ++ix)
+				decoded.operands[ix] = (decoded.opcode >> decoded.handler->operands[ix].shift) & decoded.handler->operands[ix].mask;
+		}
+		decoded.length = (uint8_t)(reg_pc.raw - pc_before);
+	}
+
+	const CPU::DecodedInstruction& CPU::Decode() {
+		if (reg_csr.raw & ~impl_csr_mask)
+			reg_csr.raw &= impl_csr_mask;
+		if (reg_pc.raw & 1)
+			reg_pc.raw &= ~1;
+
+		/**
+		 * `CorruptByDSR` changes how far the next fetch moves PC, which a cached
+		 * entry knows nothing about. Decode that one on the side.
+		 */
+		if (fetch_addition != 2) {
+			DecodeAt(decode_scratch);
+			return decode_scratch;
+		}
+
+		auto& page = decode_cache[reg_csr.raw];
+		if (!page)
+			page.reset(new DecodedInstruction[0x8000]());
+
+		DecodedInstruction& decoded = page[reg_pc.raw >> 1];
+		if (decoded.generation != decode_generation) {
+			DecodeAt(decoded);
+			decoded.generation = decode_generation;
+		}
+		else
+			reg_pc.raw = (uint16_t)(reg_pc.raw + decoded.length);
+		return decoded;
+	}
+
+	void CPU::Execute(const DecodedInstruction& decoded) {
+		(this->*(decoded.handler->executor))(decoded);
+	}
+
+	bool CPU::RaiseInstructionEvent(uint32_t pc_before) {
+		if (!emulator.hooks.Wants(emulator.hooks.on_instruction_listeners))
+			return true;
+
+		MaterializeFlags();
+		InstructionEventArgs iea{};
+		iea.pc_before = pc_before;
+		iea.pc_after = reg_csr << 16 | reg_pc;
+		RaiseEvent(emulator.hooks.on_instruction, *this, iea);
+		if (iea.should_break) {
+			emulator.SetPaused(true);
+			return false;
+		}
+		return true;
+	}
+
+	size_t CPU::Next() {
+		if (reg_r_view_live)
+			ApplyRegisterView();
+
 		/**
 		 * `reg_dsr` only affects the current instruction. The old DSR is stored in
 		 * `impl_last_dsr` and is recalled every time a DSR instruction is encountered
@@ -350,60 +557,300 @@ namespace casioemu {
 
 		auto pc_before = reg_csr << 16 | reg_pc;
 
+		impl_cycles = 0;
 		while (1) {
-
-			impl_opcode = Fetch();
-			OpcodeSource* handler = opcode_dispatch[impl_opcode];
+			const DecodedInstruction& decoded = Decode();
+			const OpcodeSource* handler = decoded.handler;
 
 			if (!handler)
 				continue;
 
-			impl_long_imm = 0;
-			if (handler->hint & H_TI)
-				impl_long_imm = Fetch();
+			Execute(decoded);
 
-			for (size_t ix = 0; ix != sizeof(impl_operands) / sizeof(impl_operands[0]); ++ix) {
-				impl_operands[ix].value = (impl_opcode >> handler->operands[ix].shift) & handler->operands[ix].mask;
-				impl_operands[ix].register_index = impl_operands[ix].value;
-				impl_operands[ix].register_size = handler->operands[ix].register_size;
+			if (!(handler->hint & H_DS))
+				break;
+		}
+
+		++instructions_retired;
+		RaiseInstructionEvent(pc_before);
+		if (reg_r_view_live)
+			RefreshRegisterView();
+		return real_hardware ? impl_cycles : 1;
+	}
+
+	uint16_t* CPU::PluginRegister(const std::string& name) {
+		auto proxy = register_proxies.find(name);
+		if (proxy == register_proxies.end())
+			return nullptr;
+		if (proxy->second.size != 1)
+			return (uint16_t*)proxy->second.value;
+
+		if (reg_r_view_live)
+			ApplyRegisterView();
+		RefreshRegisterView();
+		reg_r_view_live = true;
+		return &reg_r_view[(uint8_t*)proxy->second.value - reg_r];
+	}
+
+	void CPU::ApplyRegisterView() {
+		for (size_t ix = 0; ix != 16; ++ix)
+			if (reg_r_view[ix] != reg_r_view_synced[ix])
+				reg_r[ix] = (uint8_t)reg_r_view[ix];
+	}
+
+	void CPU::RefreshRegisterView() {
+		for (size_t ix = 0; ix != 16; ++ix)
+			reg_r_view[ix] = reg_r_view_synced[ix] = reg_r[ix];
+	}
 
-				if (impl_operands[ix].register_size) {
-					impl_operands[ix].value = 0;
-					for (size_t bx = 0; bx != impl_operands[ix].register_size; ++bx)
-						impl_operands[ix].value |= (uint64_t)(reg_r[impl_operands[ix].register_index + bx]) << (bx * 8);
+	void CPU::MaterializeFlags() {
+		if (!lazy_flags)
+			return;
+
+		uint16_t addend_0 = lazy_addend[0], addend_1 = lazy_addend[1];
+		bool carry_8 = (addend_0 + addend_1 + lazy_carry) >> 8;
+		bool carry_7 = ((addend_0 & 0x7F) + (addend_1 & 0x7F) + lazy_carry) >> 7;
+		bool carry_4 = ((addend_0 & 0x0F) + (addend_1 & 0x0F) + lazy_carry) >> 4;
+
+		uint8_t flags = 0;
+		flags |= (lazy_zero_in && !lazy_result) ? PSW_Z : 0;
+		flags |= (lazy_result & lazy_sign) ? PSW_S : 0;
+		flags |= carry_8 ? PSW_C : 0;
+		flags |= (carry_8 ^ carry_7) ? PSW_OV : 0;
+		flags |= carry_4 ? PSW_HC : 0;
+
+		reg_psw.raw = (reg_psw.raw & ~lazy_flags) | (flags & lazy_flags);
+		lazy_flags = 0;
+	}
+
+	bool CPU::EndsBlock(const OpcodeSource* handler) {
+		auto function = handler->handler_function;
+		return function == &CPU::OP_B || function == &CPU::OP_BL || function == &CPU::OP_BC ||
+			   function == &CPU::OP_RT || function == &CPU::OP_RTI || function == &CPU::OP_RTICE ||
+			   function == &CPU::OP_POPL || function == &CPU::OP_SWI || function == &CPU::OP_BRK ||
+			   function == &CPU::OP_ICESWI;
+	}
+
+	void CPU::BuildBlock(std::vector<DecodedInstruction>& block) {
+		uint16_t pc = reg_pc.raw;
+
+		/**
+		 * Keep decoding past `max_block_size` until the current instruction is
+		 * complete, so that a block never ends on a DSR prefix. An invalid
+		 * opcode, or an unusually long run of prefixes, ends the block before
+		 * the instruction it is part of. A block that would be empty holds a
+		 * single entry without a handler instead, which tells `NextBlock` to
+		 * leave this address to `Next`.
+		 */
+		size_t complete = 0;
+		while (1) {
+			const DecodedInstruction& decoded = Decode();
+			if (!decoded.handler || block.size() - complete == max_block_size) {
+				block.resize(complete);
+				if (block.empty())
+					block.emplace_back();
+				break;
+			}
+			block.push_back(decoded);
+			if (decoded.handler->hint & H_DS)
+				continue;
+			complete = block.size();
+			if (EndsBlock(decoded.handler) || block.size() >= max_block_size)
+				break;
+		}
+
+		reg_pc.raw = pc;
+		FuseBlock(block);
+	}
+
+	void CPU::FuseBlock(std::vector<DecodedInstruction>& block) {
+		auto function_at = [&block](size_t index) {
+			return index < block.size() && block[index].handler ? block[index].handler->handler_function : nullptr;
+		};
+		auto is_load_ea = [&block](size_t index) {
+			if (index >= block.size() || !block[index].handler)
+				return false;
+			const OpcodeSource* handler = block[index].handler;
+			return handler->handler_function == &CPU::OP_LS_EA && (handler->hint & H_IA) && !(handler->hint & H_ST);
+		};
+
+		for (size_t ix = 0; ix < block.size();) {
+			auto function = function_at(ix);
+			if (!function) {
+				++ix;
+				continue;
+			}
+
+			if (block[ix].handler->hint & H_DS) {
+				auto next = function_at(ix + 1);
+				if (next && !(block[ix + 1].handler->hint & H_DS)) {
+					block[ix].fused = 1;
+					ix += 2;
 				}
+				else
+					++ix;
+				continue;
+			}
+
+			size_t end = ix + 1;
+			if (is_load_ea(ix)) {
+				while (is_load_ea(end))
+					++end;
+			}
+			else if (function == &CPU::OP_PUSH || function == &CPU::OP_POP) {
+				while (function_at(end) == function)
+					++end;
+				if (function == &CPU::OP_PUSH && function_at(end) == &CPU::OP_BL)
+					++end;
 			}
-			impl_hint = handler->hint;
 
-			impl_flags_changed = 0;
-			impl_flags_in = reg_psw;
+			block[ix].fused = (uint8_t)std::min<size_t>(end - ix - 1, 0xFF);
+			ix += block[ix].fused + 1;
+		}
+	}
+
+	void CPU::PrefixDSR(const DecodedInstruction& decoded) {
+		const OpcodeSource* handler = decoded.handler;
+		impl_cycles += handler->cycles;
+		if (handler->hint & H_DW)
+			impl_last_dsr = handler->operands[0].register_size ? reg_r[decoded.operands[0]] : decoded.operands[0];
+
+		impl_last_dsr &= dsr_mask;
+		reg_dsr = impl_last_dsr;
+	}
+
+	size_t CPU::ExecuteFused(const DecodedInstruction* decoded, uint16_t csr, uint16_t& pc) {
+		size_t count = decoded->fused + 1;
+		for (size_t ix = 0; ix != count; ++ix) {
+			if (ix && !BlockContinues(csr, pc))
+				return ix;
+
+			const DecodedInstruction& instruction = decoded[ix];
+			const OpcodeSource* handler = instruction.handler;
+			pc = (uint16_t)(pc + instruction.length);
+			reg_pc.raw = pc;
+
+			// * Same as `OP_LS_EA`, `OP_PUSH` and `OP_POP` with their operands in place.
+			uint8_t field = instruction.operands[0];
+			if (handler->handler_function == &CPU::OP_LS_EA) {
+				impl_cycles += handler->cycles;
+				size_t length = handler->hint >> 8;
+				uint16_t offset = reg_ea;
+				if (length % 2 == 0)
+					offset &= ~1;
+				uint64_t loaded = ReadMemory((((size_t)reg_dsr) << 16) | offset, length);
+				memcpy(&reg_r[field], &loaded, length);
+				SetZSFlags(loaded, (uint64_t)0x80 << ((length - 1) * 8), true);
+				BumpEA(length);
+			}
+			else if (handler->handler_function == &CPU::OP_PUSH) {
+				impl_cycles += handler->cycles;
+				size_t size = handler->operands[1].register_size;
+				field = instruction.operands[1];
+				reg_sp -= size == 1 ? 2 : size;
+				uint64_t value = 0;
+				memcpy(&value, &reg_r[field], size);
+				WriteMemory(reg_sp, value, size);
+			}
+			else if (handler->handler_function == &CPU::OP_POP) {
+				impl_cycles += handler->cycles;
+				size_t size = handler->operands[0].register_size;
+				uint64_t value = ReadMemory(reg_sp, size);
+				reg_sp += size == 1 ? 2 : size;
+				memcpy(&reg_r[field], &value, size);
+			}
+			else
+				Execute(instruction);
+		}
+		return count;
+	}
+
+	/**
+	 * False as soon as the block stops describing what the CPU would fetch
+	 * next: a taken branch, modified code, a pending interrupt or the CPU no
+	 * longer running.
+	 */
+	bool CPU::BlockContinues(uint16_t csr, uint16_t pc) {
+		if (reg_csr.raw != csr || reg_pc.raw != pc || fetch_addition != 2 || block_generation != decode_generation)
+			return false;
+		if (emulator.chipset.InterruptPending() || emulator.chipset.run_mode != Chipset::RM_RUN)
+			return false;
+		return true;
+	}
+
+	size_t CPU::NextBlock() {
+		if (fetch_addition != 2 || reg_r_view_live)
+			return Next();
+
+		if (reg_csr.raw & ~impl_csr_mask)
+			reg_csr.raw &= impl_csr_mask;
+		if (reg_pc.raw & 1)
+			reg_pc.raw &= ~1;
+
+		if (block_generation != decode_generation) {
+			block_cache.clear();
+			block_generation = decode_generation;
+		}
+
+		uint16_t csr = reg_csr.raw;
+		auto& block = block_cache[csr << 16 | reg_pc.raw];
+		if (block.empty())
+			BuildBlock(block);
+		if (!block.front().handler)
+			return Next();
+
+		size_t executed = 0;
+		impl_cycles = 0;
+		uint16_t pc = reg_pc.raw;
+		auto decoded = block.begin();
+		while (decoded != block.end()) {
+			reg_dsr = 0;
+
+			emulator.chipset.isMIBlocked = false;
+
+			auto pc_before = reg_csr << 16 | reg_pc;
+
 			/**
-			 * Yes, Z is always set to 1. While `impl_flags_changed` may not have
-			 * PSW_Z set, `impl_flags_out` does as most of the time Z is calculated
-			 * by one or more calls to `ZSCheck`. `ZSCheck` only changes Z if the
-			 * value it checks is non-zero, otherwise it leaves it alone.
+			 * Superinstructions spanning several instructions skip the
+			 * per-instruction events, so they are only taken without a hook.
 			 */
-			impl_flags_out = PSW_Z;
-			(this->*(handler->handler_function))();
+			if (decoded->fused && !(decoded->handler->hint & H_DS) && !emulator.hooks.Wants(emulator.hooks.on_instruction_listeners)) {
+				size_t count = ExecuteFused(&*decoded, csr, pc);
+				decoded += count;
+				executed += count;
+				if (!BlockContinues(csr, pc))
+					break;
+				continue;
+			}
 
-			reg_psw &= ~impl_flags_changed;
-			reg_psw |= impl_flags_out & impl_flags_changed;
+			while (decoded != block.end()) {
+				const OpcodeSource* handler = decoded->handler;
+				pc = (uint16_t)(pc + decoded->length);
+				reg_pc.raw = pc;
+				if (!handler) {
+					++decoded;
+					continue;
+				}
 
-			if (handler->hint & H_WB && impl_operands[0].register_size)
-				for (size_t bx = 0; bx != impl_operands[0].register_size; ++bx)
-					reg_r[impl_operands[0].register_index + bx] = (uint8_t)(impl_operands[0].value >> (bx * 8));
+				if (decoded->fused && handler->hint & H_DS)
+					PrefixDSR(*decoded++);
+				else
+					Execute(*decoded++);
 
-			if (!(handler->hint & H_DS))
+				if (!(handler->hint & H_DS))
+					break;
+			}
+			++executed;
+
+			if (!RaiseInstructionEvent(pc_before))
 				break;
-		}
 
-		InstructionEventArgs iea{};
-		iea.pc_before = pc_before;
-		iea.pc_after = reg_csr << 16 | reg_pc;
-		RaiseEvent(on_instruction, *this, iea);
-		if (iea.should_break) {
-			emulator.SetPaused(true);
+			if (!BlockContinues(csr, pc))
+				break;
 		}
+
+		instructions_retired += executed;
+		return real_hardware ? impl_cycles : executed;
 	}
 
 	void CPU::SetMemoryModel(MemoryModel _memory_model) {
@@ -418,13 +865,30 @@ namespace casioemu {
 		reg_sp = emulator.chipset.mmu.ReadCode(0);
 		reg_dsr = 0;
 		reg_psw = 0;
+		lazy_flags = 0;
 		fetch_addition = 2;
 #ifdef DBG
 		stack.get()->clear();
 #endif
 	}
 
+	void CPU::Serialize(StateStream& state) {
+		MaterializeFlags();
+		state(reg_r, reg_cr, reg_pc.raw, reg_elr, reg_csr.raw, reg_ecsr, reg_epsw, reg_sp.raw, reg_ea.raw, reg_dsr.raw);
+		// * Fixed width, so the layout doesn't depend on the host's `size_t`.
+		uint32_t fetch = (uint32_t)fetch_addition;
+		state(impl_last_dsr, fetch);
+		if (state.Loading()) {
+			fetch_addition = fetch;
+#ifdef DBG
+			stack.get()->clear();
+#endif
+			InvalidateDecodeCache();
+		}
+	}
+
 	void CPU::Raise(size_t exception_level, size_t index) {
+		MaterializeFlags();
 		reg_epsw[exception_level].raw = reg_psw.raw;
 		reg_elr[exception_level].raw = reg_pc.raw;
 		reg_ecsr[exception_level].raw = reg_csr.raw;
@@ -2,27 +2,27 @@
 #include "Config.hpp"
 #include "Logger.hpp"
 
+#include <memory>
+#include <unordered_map>
+
 namespace casioemu {
 	class Emulator;
+	class StateStream;
 
 	class CPU {
 		Emulator& emulator;
 
 	private:
+		/**
+		 * Names and sizes live in `register_proxies`, so a register is nothing
+		 * but its value.
+		 */
 		struct RegisterStub {
-			size_t type_size;
-			std::string name;
-
 			uint16_t raw;
 		};
 
 		template <typename value_type>
 		struct Register : public RegisterStub {
-			Register<value_type>() {
-				type_size = sizeof(value_type);
-				name = "?";
-			}
-
 			operator value_type() {
 				return raw;
 			}
@@ -57,6 +57,29 @@ namespace casioemu {
 		typedef Register<uint16_t> reg16_t;
 
 		uint8_t impl_flags_changed, impl_flags_out, impl_flags_in;
+		/**
+		 * Flags owed to PSW by handlers hinted with `H_LF`. Instead of going
+		 * through `impl_flags_*`, such a handler records the operands its flags
+		 * are derived from and marks them in `lazy_flags`. Z and S come from
+		 * `lazy_result`; C, OV and HC from adding `lazy_addend` and `lazy_carry`
+		 * like `Add8` does. `MaterializeFlags` folds the pending bits into PSW.
+		 */
+		uint8_t lazy_flags;
+		uint64_t lazy_result, lazy_sign;
+		bool lazy_zero_in;
+		uint8_t lazy_addend[2], lazy_carry;
+		void SetZSFlags(uint64_t result, uint64_t sign, bool zero_in) {
+			lazy_result = result;
+			lazy_sign = sign;
+			lazy_zero_in = zero_in;
+			lazy_flags |= PSW_Z | PSW_S;
+		}
+		void SetAddFlags(uint8_t addend_0, uint8_t addend_1, uint8_t carry) {
+			lazy_addend[0] = addend_0;
+			lazy_addend[1] = addend_1;
+			lazy_carry = carry;
+			lazy_flags |= PSW_C | PSW_OV | PSW_HC;
+		}
 		uint8_t impl_shift_buffer;
 		uint16_t impl_opcode, impl_long_imm;
 		struct {
@@ -68,6 +91,15 @@ namespace casioemu {
 
 		size_t fetch_addition;
 
+	public:
+		/**
+		 * Cycles spent by the instructions run since `Next` or `NextBlock` was
+		 * entered. `MMU` adds the wait states of the memory it accesses here.
+		 */
+		size_t impl_cycles;
+
+	private:
+
 		void SetupOpcodeDispatch();
 		void SetupRegisterProxies();
 
@@ -106,9 +138,17 @@ namespace casioemu {
 		} cpu_model;
 
 		/**
-		 * See 1.2.1 in the nX-U8 manual.
+		 * See 1.2.1 in the nX-U8 manual. The general registers are 16 contiguous
+		 * bytes; ERn, XRn and QRn are views of the same bytes, which relies on a
+		 * little-endian host just like the register pairs themselves do.
 		 */
-		reg8_t reg_r[16], reg_cr[16];
+		union {
+			uint8_t reg_r[16];
+			uint16_t reg_er[8];
+			uint32_t reg_xr[4];
+			uint64_t reg_qr[2];
+		};
+		reg8_t reg_cr[16];
 		reg16_t reg_pc, reg_elr[4], &reg_lr;
 		reg16_t reg_csr, reg_ecsr[4], &reg_lcsr;
 		reg8_t reg_epsw[4], &reg_psw;
@@ -121,9 +161,26 @@ namespace casioemu {
 
 		bool real_hardware;
 
+		/**
+		 * Set by the `block_engine` command line key. `Chipset::Tick` then runs
+		 * whole basic blocks through `NextBlock` instead of calling `Next`.
+		 */
+		bool block_engine;
+
 		void SetMemoryModel(MemoryModel memory_model);
 		void SetCPUModel(CPUModel cpu_model);
-		void Next();
+		/**
+		 * Runs one instruction and returns the number of SYSCLK ticks it takes.
+		 * That's always 1, unless the model emulates real hardware, in which
+		 * case it's the instruction's cycle count plus wait states.
+		 */
+		size_t Next();
+		/**
+		 * Runs instructions until the end of the current basic block, a taken
+		 * branch, a pending interrupt or a debugger break. Returns the number of
+		 * SYSCLK ticks taken, each instruction counted the way `Next` counts it.
+		 */
+		size_t NextBlock();
 		void Reset();
 		void Raise(size_t exception_level, size_t index);
 		void CorruptByDSR();
@@ -154,9 +211,13 @@ namespace casioemu {
 			H_DS = 0x0008, // * Instruction is a DSR prefix.
 			H_IA = 0x0010, // * Increment EA flag for load/store/coprocessor instructions.
 			H_TI = 0x0020, // * Instruction takes an external long immediate value.
-			H_WB = 0x0040  // * Register Writeback flag for a lot of instructions to make life easier.
+			H_WB = 0x0040, // * Register Writeback flag for a lot of instructions to make life easier.
+			H_LF = 0x0080  // * Handler sets its flags lazily through `SetZSFlags`/`SetAddFlags`.
 		};
 
+		struct DecodedInstruction;
+		typedef void (CPU::*Executor)(const DecodedInstruction& decoded);
+
 		struct OpcodeSource {
 			void (CPU::*handler_function)();
 			/**
@@ -166,6 +227,13 @@ namespace casioemu {
 			 */
 			size_t hint;
 			uint16_t opcode;
+			/**
+			 * Execution cycles with no wait states, see the nX-U8 core manual.
+			 * The core has an 8-bit data bus, so every data byte costs a cycle.
+			 * Cycles that depend on the outcome (taken branches, register lists)
+			 * are added by the handler to `impl_cycles`.
+			 */
+			uint8_t cycles;
 			struct OperandMask {
 				/**
 				 * `register_size` determines whether an operand is a register
@@ -175,9 +243,109 @@ namespace casioemu {
 				size_t register_size;
 				uint16_t mask, shift;
 			} operands[2];
+			/**
+			 * `ExecuteAs` instantiated for this entry's operand sizes and
+			 * writeback hint. Picked while `opcode_sources` is constant-initialised.
+			 */
+			Executor executor;
+			/**
+			 * Whether the handler reads PSW, or writes it as a whole. Only then
+			 * does `ExecuteAs` bring the flags of lazy instructions up to date
+			 * first.
+			 */
+			bool reads_flags;
+
+			constexpr OpcodeSource(void (CPU::*handler_function)(), size_t hint, uint16_t opcode, uint8_t cycles, const OperandMask (&operands)[2]);
 		};
-		static OpcodeSource opcode_sources[];
-		OpcodeSource** opcode_dispatch;
+		static const OpcodeSource opcode_sources[];
+		const OpcodeSource** opcode_dispatch;
+
+		template <size_t register_size>
+		void LoadOperand(size_t index, uint8_t field);
+		template <size_t register_size>
+		void StoreOperand(uint8_t field);
+		template <size_t size0, size_t size1, bool writeback>
+		void ExecuteAs(const DecodedInstruction& decoded);
+		template <size_t size0, bool writeback>
+		static constexpr Executor SelectExecutor(size_t size1);
+		static constexpr Executor SelectExecutor(size_t hint, size_t size0, size_t size1);
+
+		/**
+		 * Instructions decoded at a given CSR:PC. `operands` holds the operand
+		 * fields already shifted and masked out of the opcode. An entry is only
+		 * valid while `generation` equals `decode_generation`, so the whole cache
+		 * is dropped by bumping the generation whenever code memory changes.
+		 * `fused` is only used inside blocks, see `FuseBlock`.
+		 */
+		struct DecodedInstruction {
+			const OpcodeSource* handler;
+			uint32_t generation;
+			uint16_t opcode, long_imm;
+			uint8_t operands[2];
+			uint8_t length;
+			uint8_t fused;
+		};
+		std::vector<std::unique_ptr<DecodedInstruction[]>> decode_cache;
+		uint32_t decode_generation;
+		DecodedInstruction decode_scratch;
+		const DecodedInstruction& Decode();
+		void DecodeAt(DecodedInstruction& decoded);
+		void Execute(const DecodedInstruction& decoded);
+		bool RaiseInstructionEvent(uint32_t pc_before);
+
+		/**
+		 * Straight-line runs of decoded instructions keyed by the CSR:PC they
+		 * start at. A block ends after an instruction that may transfer control
+		 * or after `max_block_size` instructions. The whole map is dropped when
+		 * `block_generation` falls behind `decode_generation`.
+		 */
+		static const size_t max_block_size = 32;
+		std::unordered_map<uint32_t, std::vector<DecodedInstruction>> block_cache;
+		uint32_t block_generation;
+		static bool EndsBlock(const OpcodeSource* handler);
+		void BuildBlock(std::vector<DecodedInstruction>& block);
+		bool BlockContinues(uint16_t csr, uint16_t pc);
+
+		/**
+		 * Marks superinstructions in a freshly built block by setting `fused` on
+		 * their first entry to the number of entries that follow it:
+		 * - a DSR prefix and the instruction it applies to, run by `PrefixDSR`
+		 *   without going through an executor;
+		 * - a chain of `L Rn,[EA+]` loads;
+		 * - a run of PUSHes, optionally ending with the BL they set up;
+		 * - a run of POPs.
+		 * The last three are run by `ExecuteFused` as long as no instruction
+		 * hook is attached.
+		 */
+		static void FuseBlock(std::vector<DecodedInstruction>& block);
+		void PrefixDSR(const DecodedInstruction& decoded);
+		size_t ExecuteFused(const DecodedInstruction* decoded, uint16_t csr, uint16_t& pc);
+
+		/**
+		 * Must be called whenever the bytes `MMU::ReadCode` sees may have changed,
+		 * e.g. after writing `rom_data`/`flash_data` or changing ROM remapping.
+		 */
+		void InvalidateDecodeCache();
+
+		/**
+		 * Brings `reg_psw` up to date with the flags of lazily evaluated
+		 * instructions. Handlers that read PSW, `Raise`, `Serialize` and the
+		 * instruction hook do this on their own; anything else looking at PSW
+		 * between instructions has to call it first.
+		 */
+		void MaterializeFlags();
+
+		/**
+		 * Instructions run since startup, for `RewindBuffer` to find its way
+		 * back to one. Not part of save states.
+		 */
+		uint64_t instructions_retired = 0;
+
+		/**
+		 * Saves or restores the registers. Pending flags are materialized
+		 * first, so lazy flag state never ends up in a save state.
+		 */
+		void Serialize(StateStream& state);
 
 		typedef RegisterStub CPU::*RegisterStubPointer;
 		typedef RegisterStub (CPU::*RegisterStubArrayPointer)[];
@@ -188,7 +356,35 @@ namespace casioemu {
 			RegisterStubArrayPointer stub_array;
 		};
 		static RegisterRecord register_record_sources[];
-		std::map<std::string, RegisterStub*> register_proxies;
+		/**
+		 * Side table for plugins and debugging tools. Maps register names
+		 * (`r0`, `er0`, `xr0`, `qr0`, `pc`, `psw`, ...) to their storage.
+		 */
+		struct RegisterProxy {
+			void* value;
+			size_t size;
+		};
+		std::map<std::string, RegisterProxy> register_proxies;
+		/**
+		 * Returns 16-bit storage for a register, as the plugin API expects.
+		 * `r0`-`r15` are single bytes, so they are handed out as 16-bit views
+		 * in `reg_r_view` that are kept in step with `reg_r` around every
+		 * instruction once asked for; `NextBlock` then falls back to `Next`.
+		 * Writes to the high byte of such a view are dropped, as they always
+		 * were. Returns nullptr for unknown names.
+		 */
+		uint16_t* PluginRegister(const std::string& name);
+		uint16_t reg_r_view[16], reg_r_view_synced[16];
+		bool reg_r_view_live = false;
+		/**
+		 * Copies plugin writes from `reg_r_view` into `reg_r`. Called before
+		 * an instruction.
+		 */
+		void ApplyRegisterView();
+		/**
+		 * Refreshes `reg_r_view` from `reg_r`. Called after an instruction.
+		 */
+		void RefreshRegisterView();
 
 		// * Arithmetic Instructions
 		void OP_ADD();
@@ -203,6 +399,8 @@ namespace casioemu {
 		void OP_SUB();
 		void OP_SUBC();
 		void Add8();
+		void Add8ZS();
+		void Sub8ZS();
 		void ZSCheck();
 		void ShiftLeft8();
 		void ShiftRight8();
@@ -220,6 +418,8 @@ namespace casioemu {
 		void OP_LS_FP();
 		void OP_LS_I();
 		void LoadStore(uint16_t offset, size_t length);
+		uint64_t ReadMemory(size_t offset, size_t length);
+		void WriteMemory(size_t offset, uint64_t value, size_t length);
 		// * Control Register Access Instructions
 		void OP_ADDSP();
 		void OP_CTRL();
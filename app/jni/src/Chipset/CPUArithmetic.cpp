@@ -11,9 +11,10 @@ namespace casioemu
 	// * Arithmetic Instructions
 	void CPU::OP_ADD()
 	{
-		impl_flags_in &= ~PSW_C;
-		impl_flags_in |= PSW_Z;
-		OP_ADDC();
+		uint8_t op8[2] = {(uint8_t)impl_operands[0].value, (uint8_t)impl_operands[1].value};
+		impl_operands[0].value = (uint8_t)(op8[0] + op8[1]);
+		SetAddFlags(op8[0], op8[1], 0);
+		SetZSFlags(impl_operands[0].value, 0x80, true);
 	}
 
 	void CPU::OP_ADD16()
@@ -21,36 +22,27 @@ namespace casioemu
 		if (impl_hint & H_IE)
 			impl_operands[1].value |= (impl_operands[1].value & 0x40) ? 0xFF80 : 0;
 
-		impl_flags_in &= ~PSW_C;
-
-		uint8_t op_high_0 = impl_operands[0].value >> 8;
-		uint8_t op_high_1 = impl_operands[1].value >> 8;
-		Add8();
-		ZSCheck();
-
-		impl_flags_in = (impl_flags_in & ~PSW_C) | (impl_flags_out & PSW_C);
-
-		uint8_t op_low_0 = impl_operands[0].value;
-		impl_operands[0].value = op_high_0;
-		impl_operands[1].value = op_high_1;
-		Add8();
-		ZSCheck();
-
-		impl_operands[0].value = (impl_operands[0].value << 8) | op_low_0;
+		uint16_t op16[2] = {(uint16_t)impl_operands[0].value, (uint16_t)impl_operands[1].value};
+		uint8_t carry_low = (((uint16_t)(op16[0] & 0xFF)) + (op16[1] & 0xFF)) >> 8;
+		impl_operands[0].value = (uint16_t)(op16[0] + op16[1]);
+		SetAddFlags(op16[0] >> 8, op16[1] >> 8, carry_low);
+		SetZSFlags(impl_operands[0].value, 0x8000, true);
 	}
 
 	void CPU::OP_ADDC()
 	{
-		Add8();
-		if (!(impl_flags_in & PSW_Z))
-			impl_flags_out &= ~PSW_Z;
-		ZSCheck();
+		MaterializeFlags();
+		uint8_t op8[2] = {(uint8_t)impl_operands[0].value, (uint8_t)impl_operands[1].value};
+		uint8_t c_in = (reg_psw & PSW_C) ? 1 : 0;
+		impl_operands[0].value = (uint8_t)(op8[0] + op8[1] + c_in);
+		SetAddFlags(op8[0], op8[1], c_in);
+		SetZSFlags(impl_operands[0].value, 0x80, reg_psw & PSW_Z);
 	}
 
 	void CPU::OP_AND()
 	{
 		impl_operands[0].value &= impl_operands[1].value & 0xFF;
-		ZSCheck();
+		SetZSFlags(impl_operands[0].value & 0xFF, 0x80, true);
 	}
 
 	void CPU::OP_MOV16()
@@ -58,73 +50,57 @@ namespace casioemu
 		if (impl_hint & H_IE)
 			impl_operands[1].value |= (impl_operands[1].value & 0x40) ? 0xFF80 : 0;
 
-		impl_operands[0].value = impl_operands[1].value & 0xFF;
-		ZSCheck();
-
-		uint8_t op_low_0 = impl_operands[0].value;
-		impl_operands[0].value = (impl_operands[1].value >> 8) & 0xFF;
-		ZSCheck();
-
-		impl_operands[0].value = (impl_operands[0].value << 8) | op_low_0;
+		impl_operands[0].value = impl_operands[1].value & 0xFFFF;
+		SetZSFlags(impl_operands[0].value, 0x8000, true);
 	}
 
 	void CPU::OP_MOV()
 	{
 		impl_operands[0].value = impl_operands[1].value & 0xFF;
-		ZSCheck();
+		SetZSFlags(impl_operands[0].value, 0x80, true);
 	}
 
 	void CPU::OP_OR()
 	{
 		impl_operands[0].value |= impl_operands[1].value & 0xFF;
-		ZSCheck();
+		SetZSFlags(impl_operands[0].value & 0xFF, 0x80, true);
 	}
 
 	void CPU::OP_XOR()
 	{
 		impl_operands[0].value ^= impl_operands[1].value & 0xFF;
-		ZSCheck();
+		SetZSFlags(impl_operands[0].value & 0xFF, 0x80, true);
 	}
 
 	void CPU::OP_CMP16()
 	{
-		impl_flags_in &= ~PSW_C;
-
-		uint8_t op_high_0 = impl_operands[0].value >> 8;
-		uint8_t op_high_1 = impl_operands[1].value >> 8;
-		impl_operands[0].value ^= 0xFF;
-		Add8();
-		impl_operands[0].value ^= 0xFF;
-		ZSCheck();
-
-		impl_flags_in = (impl_flags_in & ~PSW_C) | (impl_flags_out & PSW_C);
-
-		uint8_t op_low_0 = impl_operands[0].value;
-		impl_operands[0].value = op_high_0;
-		impl_operands[1].value = op_high_1;
-		impl_operands[0].value ^= 0xFF;
-		Add8();
-		impl_operands[0].value ^= 0xFF;
-		ZSCheck();
-
-		impl_operands[0].value = (impl_operands[0].value << 8) | op_low_0;
+		/**
+		 * Subtraction is done as in `Sub8ZS`, by adding to the one's complement
+		 * of the minuend and complementing the sum.
+		 */
+		uint16_t op16[2] = {(uint16_t)~impl_operands[0].value, (uint16_t)impl_operands[1].value};
+		uint8_t carry_low = (((uint16_t)(op16[0] & 0xFF)) + (op16[1] & 0xFF)) >> 8;
+		impl_operands[0].value = (uint16_t)~(op16[0] + op16[1]);
+		SetAddFlags(op16[0] >> 8, op16[1] >> 8, carry_low);
+		SetZSFlags(impl_operands[0].value, 0x8000, true);
 	}
 
 	void CPU::OP_SUB()
 	{
-		impl_flags_in &= ~PSW_C;
-		impl_flags_in |= PSW_Z;
-		OP_SUBC();
+		uint8_t op8[2] = {(uint8_t)~impl_operands[0].value, (uint8_t)impl_operands[1].value};
+		impl_operands[0].value = (uint8_t)~(op8[0] + op8[1]);
+		SetAddFlags(op8[0], op8[1], 0);
+		SetZSFlags(impl_operands[0].value, 0x80, true);
 	}
 
 	void CPU::OP_SUBC()
 	{
-		impl_operands[0].value ^= 0xFF;
-		Add8();
-		impl_operands[0].value ^= 0xFF;
-		if (!(impl_flags_in & PSW_Z))
-			impl_flags_out &= ~PSW_Z;
-		ZSCheck();
+		MaterializeFlags();
+		uint8_t op8[2] = {(uint8_t)~impl_operands[0].value, (uint8_t)impl_operands[1].value};
+		uint8_t c_in = (reg_psw & PSW_C) ? 1 : 0;
+		impl_operands[0].value = (uint8_t)~(op8[0] + op8[1] + c_in);
+		SetAddFlags(op8[0], op8[1], c_in);
+		SetZSFlags(impl_operands[0].value, 0x80, reg_psw & PSW_Z);
 	}
 
 	// * Shift Instructions
@@ -172,7 +148,7 @@ namespace casioemu
 		if ((impl_operands[0].value & 0xF0) > 0x90 || (impl_flags_in &  PSW_C)) impl_operands[1].value |= 0x60;
 		if ((impl_operands[0].value & 0xF0) == 0x90 && (impl_operands[0].value & 0x0F) > 0x09 && !(impl_flags_in & PSW_HC)) impl_operands[1].value |= 0x60;
 		uint8_t flags_in_backup = impl_flags_in;
-		OP_ADD();
+		Add8ZS();
 		impl_flags_out |= flags_in_backup & PSW_C;
 		impl_flags_changed &= ~PSW_OV;
 	}
@@ -183,7 +159,7 @@ namespace casioemu
 		if ((impl_operands[0].value & 0x0F) > 0x09 || (impl_flags_in & PSW_HC)) impl_operands[1].value |= 0x06;
 		if ((impl_operands[0].value & 0xF0) > 0x90 || (impl_flags_in &  PSW_C)) impl_operands[1].value |= 0x60;
 		uint8_t flags_in_backup = impl_flags_in;
-		OP_SUB();
+		Sub8ZS();
 		impl_flags_out |= flags_in_backup & PSW_C;
 		impl_flags_changed &= ~PSW_OV;
 	}
@@ -192,7 +168,7 @@ namespace casioemu
 	{
 		impl_operands[1].value = impl_operands[0].value;
 		impl_operands[0].value = 0;
-		OP_SUB();
+		Sub8ZS();
 	}
 
 	// * Bit Access Instructions
@@ -277,7 +253,7 @@ namespace casioemu
 	{
 		impl_operands[0].value = emulator.chipset.mmu.ReadData((((size_t)reg_dsr) << 16) | reg_ea);
 		impl_operands[1].value = 1;
-		OP_ADD();
+		Add8ZS();
 		impl_flags_changed &= ~PSW_C;
 		emulator.chipset.mmu.WriteData((((size_t)reg_dsr) << 16) | reg_ea, impl_operands[0].value);
 	}
@@ -286,7 +262,7 @@ namespace casioemu
 	{
 		impl_operands[0].value = emulator.chipset.mmu.ReadData((((size_t)reg_dsr) << 16) | reg_ea);
 		impl_operands[1].value = 1;
-		OP_SUB();
+		Sub8ZS();
 		impl_flags_changed &= ~PSW_C;
 		emulator.chipset.mmu.WriteData((((size_t)reg_dsr) << 16) | reg_ea, impl_operands[0].value);
 	}
@@ -308,6 +284,26 @@ namespace casioemu
 		impl_operands[0].value = (uint8_t)(op8[0] + op8[1] + c_in);
 	}
 
+	/**
+	 * Eager counterparts of `OP_ADD` and `OP_SUB` for handlers that go through
+	 * `impl_flags_*` and need the flags of the addition right away.
+	 */
+	void CPU::Add8ZS()
+	{
+		impl_flags_in &= ~PSW_C;
+		Add8();
+		ZSCheck();
+	}
+
+	void CPU::Sub8ZS()
+	{
+		impl_flags_in &= ~PSW_C;
+		impl_operands[0].value ^= 0xFF;
+		Add8();
+		impl_operands[0].value ^= 0xFF;
+		ZSCheck();
+	}
+
 	void CPU::ZSCheck()
 	{
 		impl_flags_changed |= PSW_Z | PSW_S;
@@ -3,7 +3,6 @@
 #include "Chipset.hpp"
 #include "Emulator.hpp"
 #include "Gui/Hooks.h"
-#include "Ui.hpp"
 #include "MMU.hpp"
 
 #pragma warning(disable : 4244)
@@ -88,12 +87,18 @@ namespace casioemu {
 		size_t op0_index = (impl_opcode >> 8) & 0x000F;
 		size_t register_size = impl_hint >> 8;
 
-		if (impl_hint & H_ST)
-			for (size_t ix = register_size - 1; ix != (size_t)-1; --ix)
-				emulator.chipset.mmu.WriteData((((size_t)reg_dsr) << 16) | (uint16_t)(reg_ea + ix), reg_cr[op0_index + ix]);
-		else
+		size_t offset = (((size_t)reg_dsr) << 16) | reg_ea;
+		if (impl_hint & H_ST) {
+			uint64_t value = 0;
+			for (size_t ix = 0; ix != register_size; ++ix)
+				value |= (uint64_t)reg_cr[op0_index + ix] << (8 * ix);
+			WriteMemory(offset, value, register_size);
+		}
+		else {
+			uint64_t value = ReadMemory(offset, register_size);
 			for (size_t ix = 0; ix != register_size; ++ix)
-				reg_cr[op0_index + ix] = emulator.chipset.mmu.ReadData((((size_t)reg_dsr) << 16) | (uint16_t)(reg_ea + ix));
+				reg_cr[op0_index + ix] = value >> (8 * ix);
+		}
 
 		if (impl_hint & H_IA)
 			BumpEA(register_size);
@@ -186,6 +191,7 @@ namespace casioemu {
 		if (branch) {
 			impl_operands[0].value |= (impl_operands[0].value & 0x80) ? 0x7F00 : 0;
 			reg_pc += impl_operands[0].value << 1;
+			impl_cycles += 2;
 		}
 	}
 
@@ -225,8 +231,8 @@ namespace casioemu {
 		OP_B();
 #ifdef DBG
 		StackFrame sf{};
-		sf.er0 = reg_r[0] | (reg_r[1] << 8);
-		sf.er2 = reg_r[2] | (reg_r[3] << 8);
+		sf.er0 = reg_er[0];
+		sf.er2 = reg_er[1];
 		sf.sp = reg_sp;
 		sf.new_pc = reg_csr << 16 | reg_pc;
 		if (!stack->empty() && !stack->back().lr_pushed) {
@@ -237,8 +243,8 @@ namespace casioemu {
 			// stack->clear();
 		}
 		stack->push_back(sf);
-		if (on_call_function)
-			on_call_function(*this, {sf.new_pc, (uint32_t)(reg_lcsr << 16 | reg_lr)});
+		if (emulator.hooks.Wants(emulator.hooks.on_call_function_listeners))
+			RaiseEvent(emulator.hooks.on_call_function, *this, FunctionEventArgs{sf.new_pc, (uint32_t)(reg_lcsr << 16 | reg_lr)});
 #endif
 	}
 
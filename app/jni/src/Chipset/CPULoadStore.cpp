@@ -4,6 +4,8 @@
 #include "Chipset.hpp"
 #include "MMU.hpp"
 
+#include <cstring>
+
 #pragma warning(disable : 4244)
 
 namespace casioemu
@@ -27,14 +29,14 @@ namespace casioemu
 	void CPU::OP_LS_BP()
 	{
 		impl_operands[1].value |= (impl_operands[1].value & 0x20) ? 0xFFC0 : 0;
-		impl_operands[1].value += reg_r[12] | (((uint16_t)reg_r[13]) << 8);
+		impl_operands[1].value += reg_er[6];
 		LoadStore(impl_operands[1].value, impl_hint >> 8);
 	}
 
 	void CPU::OP_LS_FP()
 	{
 		impl_operands[1].value |= (impl_operands[1].value & 0x20) ? 0xFFC0 : 0;
-		impl_operands[1].value += reg_r[14] | (((uint16_t)reg_r[15]) << 8);
+		impl_operands[1].value += reg_er[7];
 		LoadStore(impl_operands[1].value, impl_hint >> 8);
 	}
 
@@ -50,21 +52,58 @@ namespace casioemu
 		size_t reg_base = impl_operands[0].value;
 		if (impl_hint & H_ST)
 		{
-			for (size_t ix = length - 1; ix != (size_t)-1; --ix)
-				emulator.chipset.mmu.WriteData((((size_t)reg_dsr) << 16) | (uint16_t)(offset + ix), reg_r[reg_base + ix]);
+			uint64_t value = 0;
+			memcpy(&value, &reg_r[reg_base], length);
+			WriteMemory((((size_t)reg_dsr) << 16) | offset, value, length);
 		}
 		else
 		{
-			for (size_t ix = 0; ix != length; ++ix)
-			{
-				impl_operands[0].value = emulator.chipset.mmu.ReadData((((size_t)reg_dsr) << 16) | (uint16_t)(offset + ix));
-				ZSCheck(); // * defined in CPUArithmetic.cpp
-				reg_r[reg_base + ix] = impl_operands[0].value;
-			}
+			uint64_t loaded = ReadMemory((((size_t)reg_dsr) << 16) | offset, length);
+			memcpy(&reg_r[reg_base], &loaded, length);
+			SetZSFlags(loaded, (uint64_t)0x80 << ((length - 1) * 8), true);
 		}
 
 		if (impl_hint & H_IA)
 			BumpEA(length); // * defined in CPUControl.cpp
 	}
+
+	/**
+	 * `length` is 1, 2, 4 or 8, and the widest MMU access that fits is used.
+	 */
+	uint64_t CPU::ReadMemory(size_t offset, size_t length)
+	{
+		MMU &mmu = emulator.chipset.mmu;
+		switch (length)
+		{
+		case 1:
+			return mmu.ReadData(offset);
+		case 2:
+			return mmu.Read16(offset);
+		case 4:
+			return mmu.Read32(offset);
+		default:
+			return mmu.Read64(offset);
+		}
+	}
+
+	void CPU::WriteMemory(size_t offset, uint64_t value, size_t length)
+	{
+		MMU &mmu = emulator.chipset.mmu;
+		switch (length)
+		{
+		case 1:
+			mmu.WriteData(offset, value);
+			break;
+		case 2:
+			mmu.Write16(offset, value);
+			break;
+		case 4:
+			mmu.Write32(offset, value);
+			break;
+		default:
+			mmu.Write64(offset, value);
+			break;
+		}
+	}
 }
 
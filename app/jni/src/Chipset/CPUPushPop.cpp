@@ -15,8 +15,7 @@ namespace casioemu {
 		if (push_size == 1)
 			push_size = 2;
 		reg_sp -= push_size;
-		for (size_t ix = impl_operands[1].register_size - 1; ix != (size_t)-1; --ix)
-			emulator.chipset.mmu.WriteData(reg_sp + ix, impl_operands[1].value >> (8 * ix));
+		WriteMemory(reg_sp, impl_operands[1].value, impl_operands[1].register_size);
 	}
 
 	void CPU::OP_PUSHL() {
@@ -52,9 +51,7 @@ namespace casioemu {
 		size_t pop_size = impl_operands[0].register_size;
 		if (pop_size == 1)
 			pop_size = 2;
-		impl_operands[0].value = 0;
-		for (size_t ix = 0; ix != impl_operands[0].register_size; ++ix)
-			impl_operands[0].value |= ((uint64_t)emulator.chipset.mmu.ReadData(reg_sp + ix)) << (8 * ix);
+		impl_operands[0].value = ReadMemory(reg_sp, impl_operands[0].register_size);
 		reg_sp += pop_size;
 	}
 
@@ -104,7 +101,8 @@ namespace casioemu {
 							stack->back().is_jump = true;
 						}
 						else {
-							RaiseEvent(on_function_return, *this, FunctionEventArgs{oldaddr, (uint32_t)reg_pc | reg_csr << 16});
+							if (emulator.hooks.Wants(emulator.hooks.on_function_return_listeners))
+								RaiseEvent(emulator.hooks.on_function_return, *this, FunctionEventArgs{oldaddr, (uint32_t)reg_pc | reg_csr << 16});
 							stack->pop_back();
 						}
 					}
@@ -124,14 +122,15 @@ namespace casioemu {
 	}
 
 	void CPU::Push16(uint16_t data) {
+		impl_cycles += 2;
 		reg_sp -= 2;
-		emulator.chipset.mmu.WriteData(reg_sp + 1, data >> 8);
-		emulator.chipset.mmu.WriteData(reg_sp, data & 0xFF);
+		emulator.chipset.mmu.Write16(reg_sp, data);
 	}
 
 	uint16_t CPU::Pop16() {
-		uint16_t result = emulator.chipset.mmu.ReadData(reg_sp) | (((uint16_t)emulator.chipset.mmu.ReadData(reg_sp + 1)) << 8);
+		uint16_t result = emulator.chipset.mmu.Read16(reg_sp);
 		reg_sp += 2;
+		impl_cycles += 2;
 		return result;
 	}
 } // namespace casioemu
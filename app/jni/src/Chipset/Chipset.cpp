@@ -20,6 +20,7 @@
 #include "Models.h"
 #include "PowerSupply.hpp"
 #include "ROMWindow.hpp"
+#include "SaveState.hpp"
 #include "RealTimeClock.hpp"
 #include "Romu.h"
 #include "Screen.hpp"
@@ -52,9 +53,8 @@ namespace casioemu {
 	}
 
 	void Chipset::Setup() {
-		for (size_t ix = 0; ix != INT_COUNT; ++ix)
-			interrupts_active[ix] = false;
-		pending_interrupt_count = 0;
+		interrupts_active[0] = 0;
+		interrupts_active[1] = 0;
 
 		cpu.SetMemoryModel(CPU::MM_LARGE);
 		cpu.SetCPUModel(emulator.hardware_id == HW_CLASSWIZ || emulator.hardware_id == HW_CLASSWIZ_II || emulator.hardware_id == HW_TI ? CPU::CM_NX_U16 : CPU::CM_NX_U8);
@@ -441,17 +441,7 @@ namespace casioemu {
 			Chipset* chipset = (Chipset*)region->userdata;
 			data &= chipset->BLKCON_mask;
 			chipset->data_BLKCON = data;
-			for(auto peripheral : chipset->peripherals) {
-				int block_bit = peripheral->block_bit;
-				if(block_bit == -1)
-					continue;
-				if((1 << block_bit) > chipset->BLKCON_mask)
-					PANIC("Invalid BLKCON0 bit %d\n", block_bit);
-				if(data & (1 << block_bit))
-					peripheral->Uninitialise();
-				else
-					peripheral->Initialise();
-			} }, emulator);
+			chipset->UpdateBlockControl(); }, emulator);
 		}
 
 		ioport = new IOPorts(emulator);
@@ -497,6 +487,20 @@ namespace casioemu {
 			new FakeSdCard(spi);
 	}
 
+	void Chipset::UpdateBlockControl() {
+		for (auto peripheral : peripherals) {
+			int block_bit = peripheral->block_bit;
+			if (block_bit == -1)
+				continue;
+			if ((1 << block_bit) > BLKCON_mask)
+				PANIC("Invalid BLKCON0 bit %d\n", block_bit);
+			if (data_BLKCON & (1 << block_bit))
+				peripheral->Uninitialise();
+			else
+				peripheral->Initialise();
+		}
+	}
+
 	void Chipset::DestructPeripherals() {
 		region_BLKCON.Kill();
 
@@ -507,7 +511,10 @@ namespace casioemu {
 	}
 
 	void Chipset::SetupInternals() {
-		std::ifstream rom_handle(emulator.GetModelFilePath(emulator.ModelDefinition.rom_path), std::ifstream::binary);
+		// * The `rom` key runs another ROM image on the same model, e.g. one job of an `EmulatorPool`.
+		auto rom_iter = emulator.argv_map.find("rom");
+		std::string rom_path = rom_iter != emulator.argv_map.end() ? rom_iter->second : emulator.GetModelFilePath(emulator.ModelDefinition.rom_path);
+		std::ifstream rom_handle(rom_path, std::ifstream::binary);
 		if (rom_handle.fail())
 			PANIC("std::ifstream failed: %s\n", std::strerror(errno));
 		rom_data = std::vector<unsigned char>((std::istreambuf_iterator<char>(rom_handle)), std::istreambuf_iterator<char>());
@@ -538,6 +545,9 @@ namespace casioemu {
 		GetRamSize(emulator.hardware_id);
 		for (auto& peripheral : peripherals)
 			peripheral->Initialise();
+		for (auto& peripheral : peripherals)
+			if (peripheral->clock_type != CLOCK_SCHEDULED)
+				polled_peripherals.push_back(peripheral);
 
 		ConstructInterruptSFR();
 		ConstructClockGenerator();
@@ -553,17 +563,24 @@ namespace casioemu {
 		ResetClockGenerator();
 
 		SegmentAccess = false;
+		mmu.UpdateCodePages();
 		data_BLKCON = 0;
+		cpu.InvalidateDecodeCache();
+		cpu_tick_backlog = 0;
+
+		scheduled_events = {};
+		for (auto& peripheral : peripherals)
+			peripheral->scheduled_cycle = 0;
 
-		RaiseEvent(on_reset, *this);
+		RaiseEvent(emulator.hooks.on_reset, *this);
 
 		for (auto& peripheral : peripherals)
 			peripheral->Reset();
 
 		cpu.Reset();
 
-		interrupts_active[INT_RESET] = true;
-		pending_interrupt_count = 1;
+		interrupts_active[0] = uint64_t(1) << INT_RESET;
+		interrupts_active[1] = 0;
 
 		run_mode = RM_RUN;
 	}
@@ -576,14 +593,13 @@ namespace casioemu {
 
 		InterruptEventArgs iea{};
 		iea.index = INT_BREAK;
-		RaiseEvent(on_brk, *this, iea);
+		RaiseEvent(emulator.hooks.on_brk, *this, iea);
 		if (iea.handled)
 			return;
 
-		if (interrupts_active[INT_BREAK])
+		if (InterruptActive(INT_BREAK))
 			return;
-		interrupts_active[INT_BREAK] = true;
-		pending_interrupt_count++;
+		SetInterruptActive(INT_BREAK);
 	}
 
 	void Chipset::Halt() {
@@ -601,10 +617,9 @@ namespace casioemu {
 	}
 
 	void Chipset::RaiseEmulator() {
-		if (interrupts_active[INT_EMULATOR])
+		if (InterruptActive(INT_EMULATOR))
 			return;
-		interrupts_active[INT_EMULATOR] = true;
-		pending_interrupt_count++;
+		SetInterruptActive(INT_EMULATOR);
 	}
 
 	void Chipset::RequestNonmaskable() {
@@ -617,21 +632,17 @@ namespace casioemu {
 
 		InterruptEventArgs iea{};
 		iea.index = INT_MASKABLE;
-		RaiseEvent(on_interrupt, *this, iea);
+		RaiseEvent(emulator.hooks.on_interrupt, *this, iea);
 		if (iea.handled)
 			return;
 
-		if (interrupts_active[INT_NONMASKABLE])
+		if (InterruptActive(INT_NONMASKABLE))
 			return;
-		interrupts_active[INT_NONMASKABLE] = true;
-		pending_interrupt_count++;
+		SetInterruptActive(INT_NONMASKABLE);
 	}
 
 	void Chipset::ResetNonmaskable() {
-		if (!interrupts_active[INT_NONMASKABLE])
-			return;
-		interrupts_active[INT_NONMASKABLE] = false;
-		pending_interrupt_count--;
+		ClearInterruptActive(INT_NONMASKABLE);
 	}
 
 	void Chipset::RaiseMaskable(size_t index) {
@@ -640,24 +651,20 @@ namespace casioemu {
 
 		InterruptEventArgs iea{};
 		iea.index = static_cast<uint8_t>(index); // this conversion is guaranteed
-		RaiseEvent(on_interrupt, *this, iea);
+		RaiseEvent(emulator.hooks.on_interrupt, *this, iea);
 		if (iea.handled)
 			return;
 
-		if (interrupts_active[index])
+		if (InterruptActive(index))
 			return;
 
-		interrupts_active[index] = true;
-		pending_interrupt_count++;
+		SetInterruptActive(index);
 	}
 
 	void Chipset::ResetMaskable(size_t index) {
 		if (index < INT_MASKABLE || index >= INT_SOFTWARE)
 			PANIC("%zu is not a valid maskable interrupt index\n", index);
-		if (!interrupts_active[index])
-			return;
-		interrupts_active[index] = false;
-		pending_interrupt_count--;
+		ClearInterruptActive(index);
 	}
 
 	void Chipset::RaiseSoftware(size_t index) {
@@ -679,11 +686,7 @@ namespace casioemu {
 				return;
 			}
 		}
-		index += 0x40;
-		if (interrupts_active[index])
-			return;
-		interrupts_active[index] = true;
-		pending_interrupt_count++;
+		SetInterruptActive(INT_SOFTWARE + index);
 	}
 
 	void Chipset::AcceptInterrupt() {
@@ -691,40 +694,33 @@ namespace casioemu {
 
 		size_t index = 0;
 		bool acceptable = true;
+		uint64_t maskable = interrupts_active[0] & ~((uint64_t(1) << INT_MASKABLE) - 1);
 		// * Reset has priority over everything.
-		if (interrupts_active[INT_RESET])
+		if (InterruptActive(INT_RESET))
 			index = INT_RESET;
 		// * Software interrupts are immediately accepted.
-		if (!index)
-			for (size_t ix = INT_SOFTWARE; ix != INT_COUNT; ++ix)
-				if (interrupts_active[ix]) {
-					if (old_exception_level > 1)
-						logger::Info("software interrupt while exception level was greater than 1\n"); // test on real hardware shows that SWI seems to be raised normally when ELEVEL=2
-					index = ix;
-					break;
-				}
+		else if (interrupts_active[1]) {
+			if (old_exception_level > 1)
+				logger::Info("software interrupt while exception level was greater than 1\n"); // test on real hardware shows that SWI seems to be raised normally when ELEVEL=2
+			index = INT_SOFTWARE + std::countr_zero(interrupts_active[1]);
+		}
 		// * No need to check the old exception level as NMICI has an exception level of 3.
-		if (!index && interrupts_active[INT_EMULATOR])
+		else if (InterruptActive(INT_EMULATOR))
 			index = INT_EMULATOR;
 		// * No need to check the old exception level as BRK initiates a reset if
 		//   the currect exception level is greater than 1.
-		if (!index && interrupts_active[INT_BREAK])
+		else if (InterruptActive(INT_BREAK))
 			index = INT_BREAK;
-		if (!index && interrupts_active[INT_NONMASKABLE]) {
+		else if (InterruptActive(INT_NONMASKABLE)) {
 			index = INT_NONMASKABLE;
 			if (old_exception_level > 2) {
 				acceptable = false;
 			}
 		}
-		if (!index) {
-			for (size_t ix = INT_MASKABLE; ix != INT_SOFTWARE; ++ix) {
-				if (interrupts_active[ix]) {
-					index = ix;
-					if (old_exception_level > 1) {
-						acceptable = false;
-					}
-					break;
-				}
+		else if (maskable) {
+			index = std::countr_zero(maskable);
+			if (old_exception_level > 1) {
+				acceptable = false;
 			}
 		}
 
@@ -753,22 +749,19 @@ namespace casioemu {
 				SetInterruptPendingSFR(index, false);
 				cpu.Raise(exception_level, index);
 
-				interrupts_active[index] = false;
-				pending_interrupt_count--;
+				ClearInterruptActive(index);
 			}
 		}
 		else if (index == INT_NONMASKABLE) {
 			if (acceptable) {
 				cpu.Raise(exception_level, index);
 				SetInterruptPendingSFR(INT_NONMASKABLE, false);
-				interrupts_active[index] = false;
-				pending_interrupt_count--;
+				ClearInterruptActive(index);
 			}
 		}
 		else {
 			cpu.Raise(exception_level, index);
-			interrupts_active[index] = false;
-			pending_interrupt_count--;
+			ClearInterruptActive(index);
 		}
 
 		run_mode = RM_RUN;
@@ -830,13 +823,36 @@ namespace casioemu {
 			peripheral->Frame();
 	}
 
+	void Chipset::Schedule(Peripheral* peripheral, uint64_t delay) {
+		uint64_t cycle = tick_count + (delay ? delay : 1);
+		if (peripheral->scheduled_cycle && peripheral->scheduled_cycle <= cycle)
+			return;
+		peripheral->scheduled_cycle = cycle;
+		scheduled_events.push({cycle, peripheral});
+	}
+
+	void Chipset::RunScheduledEvents() {
+		while (!scheduled_events.empty() && scheduled_events.top().cycle <= tick_count) {
+			ScheduledEvent event = scheduled_events.top();
+			scheduled_events.pop();
+			if (event.peripheral->scheduled_cycle != event.cycle)
+				continue;
+			event.peripheral->scheduled_cycle = 0;
+			event.peripheral->Tick();
+		}
+	}
+
 	void Chipset::Tick() {
 		// * TODO: decrement delay counter, return if it's not 0
 
+		tick_count++;
+		if (!scheduled_events.empty())
+			RunScheduledEvents();
+
 		if (real_hardware) {
 			GenerateTickForClock();
 
-			for (auto& peripheral : peripherals) {
+			for (auto& peripheral : polled_peripherals) {
 				switch (peripheral->clock_type) {
 				case CLOCK_UNDEFINED:
 					peripheral->Tick();
@@ -861,7 +877,7 @@ namespace casioemu {
 			}
 		}
 		else {
-			for (auto& peripheral : peripherals) {
+			for (auto& peripheral : polled_peripherals) {
 				switch (peripheral->clock_type) {
 				case CLOCK_UNDEFINED:
 				case CLOCK_HSCLK:
@@ -875,14 +891,19 @@ namespace casioemu {
 			HSCLKTick = SYSCLKTick = true;
 		}
 
-		if (pending_interrupt_count) {
+		if (InterruptPending()) {
 			AcceptInterrupt();
 			for (auto peripheral : peripherals)
 				peripheral->TickAfterInterrupts();
 		}
 
 		if (run_mode == RM_RUN && SYSCLKTick) {
-			cpu.Next();
+			if (cpu_tick_backlog)
+				cpu_tick_backlog--;
+			else if (cpu.block_engine)
+				cpu_tick_backlog = cpu.NextBlock() - 1;
+			else
+				cpu_tick_backlog = cpu.Next() - 1;
 		}
 
 		LSCLKTick = false;
@@ -891,8 +912,42 @@ namespace casioemu {
 		SYSCLKTick = false;
 	}
 
+	bool Chipset::IsIdle() {
+		if (run_mode == RM_RUN || InterruptPending() || !scheduled_events.empty())
+			return false;
+		for (auto& peripheral : polled_peripherals)
+			if (!peripheral->IsIdle())
+				return false;
+		return true;
+	}
+
+	size_t Chipset::SkipIdleTicks(size_t max_ticks) {
+		if (!real_hardware || !IsIdle())
+			return 0;
+
+		bool lsclk_polled = false, hsclk_polled = false;
+		for (auto& peripheral : polled_peripherals) {
+			lsclk_polled |= peripheral->clock_type == CLOCK_LSCLK;
+			hsclk_polled |= peripheral->clock_type == CLOCK_HSCLK || peripheral->clock_type == CLOCK_SYSCLK;
+		}
+
+		size_t skipped = 0;
+		for (; skipped != max_ticks; ++skipped) {
+			if (lsclk_polled && LSCLKMode && LSCLKTickCounter + 1 >= emulator.GetCyclesPerSecond() / LSCLKFreq + LSCLKFreqAddition)
+				break;
+			if (hsclk_polled && run_mode != RM_STOP && HSCLKTickCounter + 1 >= ClockDiv)
+				break;
+			GenerateTickForClock();
+			tick_count++;
+		}
+		LSCLKTick = false;
+		HSCLKTick = false;
+		SYSCLKTick = false;
+		return skipped;
+	}
+
 	void Chipset::EmulatorTick() {
-		for (auto& peripheral : peripherals) {
+		for (auto& peripheral : polled_peripherals) {
 			switch (peripheral->clock_type) {
 			case CLOCK_LSCLK:
 			case CLOCK_EMUCLK:
@@ -908,4 +963,38 @@ namespace casioemu {
 		for (auto peripheral : peripherals)
 			peripheral->UIEvent(event);
 	}
+
+	void Chipset::Serialize(StateStream& state) {
+		cpu.Serialize(state);
+
+		state(run_mode, interrupts_active, data_int_mask, data_int_pending, isMIBlocked);
+		for (size_t i = 0; i < EffectiveMICount; i++)
+			MaskableInterrupts[i].Serialize(state);
+
+		state(data_BLKCON, data_EXICON, WDT_enabled, SegmentAccess, remap, tiDiagMode, tiKey);
+		// * Blocked peripherals drop their SFRs, so bring them in line before they read their state.
+		if (state.Loading() && emulator.hardware_id != HW_TI)
+			UpdateBlockControl();
+		state(data_FCON, data_FCON1, data_LTBR, data_HTBR, data_LTBADJ, LSCLKFreq, LSCLKFreqAddition);
+		state(LSCLKTickCounter, HSCLKTickCounter, HSCLKTimeCounter, SYSCLKTickCounter, LSCLKTimeCounter, LSCLKThresh);
+		state(LSCLK_output, HSCLK_output, ClockDiv, LSCLKMode, LSCLKTick, HSCLKTick, SYSCLKTick, LTBCReset, HTBCReset);
+		state(Port0Inputlevel, Port1Inputlevel, Port0Outputlevel, Port1Outputlevel);
+		state(UserInput_level_Port0, UserInput_level_Port1, UserInput_state_Port0, UserInput_state_Port1);
+		state(tick_count, cpu_tick_backlog);
+
+		for (auto& peripheral : peripherals) {
+			state(peripheral->scheduled_cycle);
+			peripheral->Serialize(state);
+		}
+
+		if (state.Loading()) {
+			scheduled_events = {};
+			for (auto& peripheral : peripherals)
+				if (peripheral->scheduled_cycle)
+					scheduled_events.push({peripheral->scheduled_cycle, peripheral});
+			mmu.UpdateCodePages();
+			cpu.InvalidateDecodeCache();
+			emulator.ScheduleEmulatorTick();
+		}
+	}
 } // namespace casioemu
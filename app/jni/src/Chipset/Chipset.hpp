@@ -8,7 +8,9 @@
 #include "Peripheral/IOPorts.hpp"
 
 #include <SDL.h>
+#include <bit>
 #include <forward_list>
+#include <queue>
 #include <string>
 #include <vector>
 
@@ -17,6 +19,7 @@ namespace casioemu {
 	class CPU;
 	class MMU;
 	class Peripheral;
+	class StateStream;
 
 	class Chipset {
 		enum InterruptIndex {
@@ -41,16 +44,59 @@ namespace casioemu {
 	private:
 		std::forward_list<Peripheral*> peripherals;
 
+		/**
+		 * Peripherals that have to be visited on every tick of their clock.
+		 * Anything left at `CLOCK_SCHEDULED` after `SetupInternals` is only
+		 * ticked through the event queue below.
+		 */
+		std::vector<Peripheral*> polled_peripherals;
+
+		struct ScheduledEvent {
+			uint64_t cycle;
+			Peripheral* peripheral;
+			bool operator>(const ScheduledEvent& other) const {
+				return cycle > other.cycle;
+			}
+		};
+		/**
+		 * Min-heap of pending peripheral deadlines keyed on `tick_count`.
+		 * Rescheduling a peripheral leaves its old entry in the heap; entries
+		 * that no longer match `Peripheral::scheduled_cycle` are dropped when
+		 * they reach the top.
+		 */
+		std::priority_queue<ScheduledEvent, std::vector<ScheduledEvent>, std::greater<ScheduledEvent>> scheduled_events;
+		uint64_t tick_count = 0;
+		void RunScheduledEvents();
+
 		/**
 		 * A bunch of internally used methods for encapsulation purposes.
 		 */
-		size_t pending_interrupt_count;
-		bool interrupts_active[INT_COUNT];
+		/**
+		 * Raised interrupts, one bit per `InterruptIndex`. Word 0 holds reset,
+		 * break, emulator, NMI and the maskable interrupts, word 1 holds the
+		 * software interrupts, so a count of trailing zeros picks the highest
+		 * priority one in each.
+		 */
+		uint64_t interrupts_active[INT_COUNT / 64];
+		bool InterruptActive(size_t index) {
+			return interrupts_active[index / 64] & (uint64_t(1) << index % 64);
+		}
+		void SetInterruptActive(size_t index) {
+			interrupts_active[index / 64] |= uint64_t(1) << index % 64;
+		}
+		void ClearInterruptActive(size_t index) {
+			interrupts_active[index / 64] &= ~(uint64_t(1) << index % 64);
+		}
+		bool InterruptPending() {
+			return interrupts_active[0] | interrupts_active[1];
+		}
 		void AcceptInterrupt();
 		void RaiseSoftware(size_t index);
 
 		void ConstructPeripherals();
 		void DestructPeripherals();
+		// * Enables or disables the peripherals with a `block_bit` according to BLKCON.
+		void UpdateBlockControl();
 
 		void ConstructClockGenerator();
 		void GenerateTickForClock();
@@ -74,6 +120,13 @@ namespace casioemu {
 
 		bool real_hardware;
 
+		/**
+		 * SYSCLK ticks still owed for instructions the CPU has already run, as
+		 * counted by `CPU::Next` and `CPU::NextBlock`. Peripherals keep ticking
+		 * while the CPU works it off.
+		 */
+		size_t cpu_tick_backlog = 0;
+
 	public:
 		void* QueryInterface(const char* name);
 		Chipset(Emulator& emulator);
@@ -163,11 +216,43 @@ namespace casioemu {
 		void InputToPort(int, int, bool);
 		void RemovePortInput(int, int);
 
+		/**
+		 * Ticks `peripheral` once, `delay` ticks from now (at least one). If
+		 * it already has an earlier event pending, that one is kept.
+		 */
+		void Schedule(Peripheral* peripheral, uint64_t delay);
+		uint64_t GetTickCount() const {
+			return tick_count;
+		}
+
 		void Tick();
 		void EmulatorTick();
+
+		/**
+		 * True while the CPU is halted or stopped, no interrupt is pending, no
+		 * event is scheduled and every polled peripheral reports `IsIdle`.
+		 */
+		bool IsIdle();
+		/**
+		 * Fast-forwards up to `max_ticks` ticks in which nothing but the clock
+		 * generator would have done any work, and returns how many were
+		 * skipped. Skips nothing unless `IsIdle`, so not while any event is
+		 * scheduled, and stops short of the next tick that reaches a polled
+		 * peripheral on the LSCLK/HSCLK/SYSCLK domains, so the caller should
+		 * follow it with a regular `Tick`. Only meaningful with
+		 * `real_hardware`, where ticks map to emulated time.
+		 */
+		size_t SkipIdleTicks(size_t max_ticks);
 		void Frame();
 		void UIEvent(SDL_Event& event);
 
+		/**
+		 * Saves or restores the CPU, the interrupt and clock state and every
+		 * peripheral, in that order. Memory is left to `SaveStates`. Pending
+		 * scheduled events are rebuilt from each peripheral's `scheduled_cycle`.
+		 */
+		void Serialize(StateStream& state);
+
 		template <typename T>
 		T* QueryInterface() {
 			auto i = this->QueryInterface(typeid(T).name());
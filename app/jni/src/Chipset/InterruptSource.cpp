@@ -2,6 +2,7 @@
 
 #include "Emulator.hpp"
 #include "Chipset.hpp"
+#include "SaveState.hpp"
 
 namespace casioemu
 {
@@ -52,5 +53,10 @@ namespace casioemu
 		
 		emulator->chipset.ResetMaskable(interrupt_index);
 	}
+
+	void InterruptSource::Serialize(StateStream &state)
+	{
+		state(enabled);
+	}
 }
 
@@ -4,6 +4,7 @@
 namespace casioemu
 {
 	class Emulator;
+	class StateStream;
 
 	class InterruptSource
 	{
@@ -17,6 +18,7 @@ namespace casioemu
 		void TryRaise();
 		void ResetInt();
 		void SetEnabled(bool val);
+		void Serialize(StateStream &state);
 	};
 }
 
@@ -4,123 +4,140 @@
 #include "Chipset.hpp"
 #include "Emulator.hpp"
 #include "Gui/Hooks.h"
-#include "Gui/Ui.hpp"
 #include "Logger.hpp"
+#include <algorithm>
 #include <cstring>
 
 namespace casioemu {
 	MMU::MMU(Emulator& _emulator) : emulator(_emulator) {
-		segment_dispatch = new MemoryByte*[0x100];
+		segment_dispatch = new MemoryPage*[0x100];
 		for (size_t ix = 0; ix != 0x100; ++ix)
 			segment_dispatch[ix] = nullptr;
+		for (auto& bits : watch_bits)
+			bits.resize((0x1000000 >> watch_granule_shift) / 64);
 	}
 
 	MMU::~MMU() {
-		for (size_t ix = 0; ix != 0x100; ++ix)
-			if (segment_dispatch[ix])
-				delete[] segment_dispatch[ix];
+		for (size_t ix = 0; ix != 0x100; ++ix) {
+			if (!segment_dispatch[ix])
+				continue;
+			for (size_t px = 0; px != 0x10000 / page_size; ++px)
+				delete[] segment_dispatch[ix][px].bytes;
+			delete[] segment_dispatch[ix];
+		}
 
 		delete[] segment_dispatch;
 	}
 
 	void MMU::GenerateSegmentDispatch(size_t segment_index) {
-		segment_dispatch[segment_index] = new MemoryByte[0x10000];
-		for (size_t ix = 0; ix != 0x10000; ++ix) {
-			segment_dispatch[segment_index][ix].region = nullptr;
-		}
+		segment_dispatch[segment_index] = new MemoryPage[0x10000 / page_size]{};
 	}
 
 	void MMU::SetupInternals() {
-		me_mmu = this;
 		real_hardware = emulator.ModelDefinition.real_hardware;
+		UpdateCodePages();
 	}
 
-	inline uint16_t le_read(uint8_t& a) {
-		return *(uint16_t*)&a;
-	}
-
-	uint16_t MMU::ReadCode(size_t offset) {
-		// if (offset >= (1 << 20))
-		//	PANIC("offset doesn't fit 20 bits\n");
-		// if (offset & 1)
-		//	PANIC("offset has LSB set\n");
+	// * Shared by every emulator in the process, so they are filled at compile time and never written.
+	static constexpr std::array<uint8_t, 0x100> code_fill_zero_page{};
+	static constexpr std::array<uint8_t, 0x100> code_fill_ones_page = [] {
+		std::array<uint8_t, 0x100> page{};
+		page.fill(0xFF);
+		return page;
+	}();
+	static const uint8_t* const code_fill_zero = code_fill_zero_page.data();
+	static const uint8_t* const code_fill_ones = code_fill_ones_page.data();
 
-		size_t segment_index = offset >> 16;
-		size_t segment_offset = offset & 0xFFFE;
+	/**
+	 * The page of code seen at `address` (page aligned), following the memory
+	 * map of each model. ROM past the end of `rom_data` reads as 00h.
+	 */
+	const uint8_t* MMU::CodePage(size_t address) {
+		auto& chipset = emulator.chipset;
+		size_t segment_index = address >> 16;
+		size_t segment_offset = address & 0xFFFF;
+		auto rom = [&](size_t rom_address) {
+			return rom_address + page_size <= chipset.rom_data.size() ? chipset.rom_data.data() + rom_address : code_fill_zero;
+		};
+		// * ROM segments 0-5; the first 200h bytes of segment 0 are swapped with its last ones when remapped.
+		auto rom_segment = [&](size_t segment_index) {
+			if (chipset.remap)
+				return rom((segment_index << 16) + segment_offset + ((segment_index == 0 && segment_offset < 0x200) ? 0xFE00 : 0));
+			return (segment_index == 0 && segment_offset >= 0xFE00) ? code_fill_ones : rom((segment_index << 16) + segment_offset);
+		};
 
-		// if (emulator.hardware_id == HW_FX_5800P && segment_index > 7) {
-		//	auto off = (segment_index & 7) << 16;
-		//	return (((uint16_t)emulator.chipset.flash_data[off + segment_offset + 1]) << 8) | emulator.chipset.flash_data[off + segment_offset];
-		// }
-		//  Read from rom data?
-
-		auto rom = emulator.chipset.rom_data.data();
-		auto rom_size = emulator.chipset.rom_data.size();
 		switch (emulator.hardware_id) {
 		case HW_ES_PLUS:
-			if (offset < rom_size)
-				return le_read(rom[offset]);
-			else
-				return 0;
+			return rom(address);
 		case HW_TI:
 		case HW_CLASSWIZ:
-			if (emulator.chipset.SegmentAccess && segment_index == 5)
-				segment_index = 0;
-			if (segment_index < 4) {
-				if (emulator.chipset.remap)
-					return le_read(rom[offset + ((segment_index == 0 && segment_offset < 0x200) ? 0xFE00 : 0)]);
-				else
-					return (segment_index == 0 && segment_offset >= 0xFE00) ? 0xFFFF : le_read(rom[offset]);
-			}
-			return 0;
+			return segment_index < 4 ? rom_segment(segment_index) : code_fill_zero;
 		case HW_CLASSWIZ_II:
 			if (segment_index == 8)
-				return le_read(rom[offset & 0x7ffff]);
+				return rom(segment_offset);
 			segment_index &= 7;
-			if (segment_index == 7) {
-				if (segment_offset >= 0x2000) {
-					return 0xffff;
-				}
-				else {
-					return le_read(rom[0x5E000 + segment_offset]);
-				}
-			}
-			if (segment_index > 6)
-				return 0xFFFF;
-			if (segment_index == 5) {
-				if (segment_offset >= 0xe000)
-					return 0xFFFF;
-			}
-			if (emulator.chipset.remap)
-				return le_read(rom[offset + ((segment_index == 0 && segment_offset < 0x200) ? 0xFE00 : 0)]);
-			else
-				return (segment_index == 0 && segment_offset >= 0xFE00) ? 0xFFFF : le_read(rom[offset]);
+			if (segment_index == 7)
+				return segment_offset >= 0x2000 ? code_fill_ones : rom(0x5E000 + segment_offset);
+			if (segment_index == 5 && segment_offset >= 0xE000)
+				return code_fill_ones;
+			return rom_segment(segment_index);
 		case HW_FX_5800P:
 			if (segment_index < 2)
-				return le_read(rom[offset]);
+				return rom(address);
 			if (segment_index >= 8)
-				return le_read(emulator.chipset.flash_data[offset & 0x7ffff]);
-			return 0xFFFF;
+				return chipset.flash_data.data() + (address & 0x7ffff);
+			return code_fill_ones;
 		default:
-			return 0;
+			return code_fill_zero;
+		}
+	}
+
+	void MMU::UpdateCodePages() {
+		auto& chipset = emulator.chipset;
+		if (code_segments.empty() || code_rom_data != chipset.rom_data.data() || code_flash_data != chipset.flash_data.data() || code_remap != chipset.remap) {
+			code_segments.clear();
+			code_rom_data = chipset.rom_data.data();
+			code_flash_data = chipset.flash_data.data();
+			code_remap = chipset.remap;
+			for (size_t segment_index = 0; segment_index != 0x100; ++segment_index) {
+				CodeSegment segment;
+				for (size_t ix = 0; ix != segment.size(); ++ix)
+					segment[ix] = CodePage((segment_index << 16) | (ix << page_shift));
+				// * Most segments are entirely unmapped; share their tables.
+				auto same = std::find(code_segments.begin(), code_segments.end(), segment);
+				if (same == code_segments.end()) {
+					code_segments.push_back(segment);
+					same = code_segments.end() - 1;
+				}
+				code_pages_unaliased[segment_index] = &*same;
+			}
 		}
+
+		std::copy(std::begin(code_pages_unaliased), std::end(code_pages_unaliased), code_pages);
+		// * The data segment access window also exposes segment 0 as code in segment 5.
+		if ((emulator.hardware_id == HW_CLASSWIZ || emulator.hardware_id == HW_TI) && chipset.SegmentAccess)
+			code_pages[5] = code_pages_unaliased[0];
 	}
+
 	uint8_t MMU::ReadData(size_t offset, bool softwareRead) {
 		// if (offset >= (1 << 24))
 		//	PANIC("offset doesn't fit 24 bits\n");
 #ifdef DBG
-		if (offset == 0x60722) { // Debug printf
-
-		}
-		if (softwareRead) {
+		if (softwareRead && (emulator.hooks.Wants(emulator.hooks.on_memory_read_listeners) || Watched(offset, WATCH_READ))) {
 			MemoryEventArgs mea{};
 			mea.offset = static_cast<uint32_t>(offset);
-			RaiseEvent(on_memory_read, *this, mea);
-			if (mea.handled)
-				return mea.value;
+			RaiseEvent(emulator.hooks.on_memory_read, *this, mea);
+			if (!mea.handled)
+				mea.value = ReadBus(offset, true);
+			if (Watched(offset, WATCH_READ))
+				RaiseEvent(emulator.hooks.on_watched_read, *this, mea);
+			return mea.value;
 		}
 #endif
+		return ReadBus(offset, softwareRead);
+	}
 
+	uint8_t MMU::ReadBus(size_t offset, bool softwareRead) {
 		/*
 		things about accessing unmapped segment is actually far more complex on real hardware;
 		the result seems to be also affected by the next instruction,
@@ -152,17 +169,24 @@ namespace casioemu {
 			}
 		}
 
-		MemoryByte* segment = segment_dispatch[segment_index];
+		MemoryPage* segment = segment_dispatch[segment_index];
 		if (!segment) {
 			return 0;
 		}
 
-		MemoryByte& byte = segment[segment_offset];
-		MMURegion* region = byte.region;
+		MemoryPage& page = segment[segment_offset >> page_shift];
+		if (page.data) {
+			if (softwareRead)
+				emulator.chipset.cpu.impl_cycles += page.region->wait_states;
+			return page.data[segment_offset & (page_size - 1)];
+		}
+		MMURegion* region = page.bytes ? page.bytes[segment_offset & (page_size - 1)] : page.region;
 
 		if (!region || !region->read) {
 			return 0;
 		}
+		if (softwareRead)
+			emulator.chipset.cpu.impl_cycles += region->wait_states;
 		return region->read(region, offset);
 	}
 
@@ -171,15 +195,11 @@ namespace casioemu {
 		//	PANIC("offset doesn't fit 24 bits\n");
 
 #ifdef DBG
-		if (offset == 0x60721) {
-			std::cout << data;
-			return;
-		}
-		if (softwareWrite) {
+		if (softwareWrite && (emulator.hooks.Wants(emulator.hooks.on_memory_write_listeners) || Watched(offset, WATCH_WRITE))) {
 			MemoryEventArgs mea{};
 			mea.offset = static_cast<uint32_t>(offset);
 			mea.value = data;
-			RaiseEvent(on_memory_write, *this, mea);
+			RaiseEvent(emulator.hooks.on_memory_write, *this, mea);
 			if (mea.handled)
 				return;
 		}
@@ -188,15 +208,28 @@ namespace casioemu {
 		size_t segment_index = offset >> 16;
 		size_t segment_offset = offset & 0xFFFF;
 
-		MemoryByte* segment = segment_dispatch[segment_index];
+		MemoryPage* segment = segment_dispatch[segment_index];
 		if (!segment) {
+#ifdef DBG
+			if (offset == 0x60721) // * Debug printf port, unmapped on every model.
+				std::cout << data;
+#endif
 			return;
 		}
 
-		MemoryByte& byte = segment[segment_offset];
-		MMURegion* region = byte.region;
+		MemoryPage& page = segment[segment_offset >> page_shift];
+		page.written_epoch = write_epoch;
+		if (page.writable) {
+			page.data[segment_offset & (page_size - 1)] = data;
+			return;
+		}
+		MMURegion* region = page.bytes ? page.bytes[segment_offset & (page_size - 1)] : page.region;
 		if (!region || !region->write) {
 #ifdef DBG
+			if (offset == 0x60721) {
+				std::cout << data;
+				return;
+			}
 			printf("[MMU][Warn] Unmapped write: %x <- %x\n", (uint32_t)offset, (uint32_t)data);
 #endif
 			return;
@@ -204,6 +237,94 @@ namespace casioemu {
 		region->write(region, offset, data);
 	}
 
+	void MMU::SetWatch(size_t begin, size_t length, int kinds) {
+		if (!length)
+			return;
+		size_t first = (begin & 0xFFFFFF) >> watch_granule_shift;
+		size_t last = std::min<size_t>(begin + length - 1, 0xFFFFFF) >> watch_granule_shift;
+		for (int kind = 0; kind != 2; ++kind) {
+			if (!(kinds & (1 << kind)))
+				continue;
+			for (size_t granule = first; granule <= last; ++granule)
+				watch_bits[kind][granule >> 6] |= (uint64_t)1 << (granule & 63);
+		}
+	}
+
+	void MMU::ClearWatches() {
+		for (auto& bits : watch_bits)
+			std::fill(bits.begin(), bits.end(), 0);
+	}
+
+	MMU::MemoryPage* MMU::GetDirectPage(size_t offset, size_t length, bool write) {
+#ifdef DBG
+		WatchKind kind = write ? WATCH_WRITE : WATCH_READ;
+		if (emulator.hooks.Wants(write ? emulator.hooks.on_memory_write_listeners : emulator.hooks.on_memory_read_listeners) || Watched(offset, kind) || Watched(offset + length - 1, kind))
+			return nullptr;
+#endif
+		size_t segment_index = offset >> 16;
+		if (segment_index >= 0x10 && emulator.hardware_id == HW_CLASSWIZ_II && real_hardware)
+			return nullptr;
+		if ((offset & (page_size - 1)) + length > page_size)
+			return nullptr;
+
+		MemoryPage* segment = segment_dispatch[segment_index];
+		if (!segment)
+			return nullptr;
+		MemoryPage& page = segment[(offset & 0xFFFF) >> page_shift];
+		if (write ? !page.writable : !page.data)
+			return nullptr;
+		return &page;
+	}
+
+	template <typename value_type>
+	value_type MMU::ReadMulti(size_t offset, bool softwareRead) {
+		value_type value = 0;
+		if (MemoryPage* page = GetDirectPage(offset, sizeof(value_type), false)) {
+			if (softwareRead)
+				emulator.chipset.cpu.impl_cycles += sizeof(value_type) * page->region->wait_states;
+			memcpy(&value, page->data + (offset & (page_size - 1)), sizeof(value_type));
+			return value;
+		}
+		for (size_t ix = 0; ix != sizeof(value_type); ++ix)
+			value |= (value_type)ReadData((offset & ~(size_t)0xFFFF) | (uint16_t)(offset + ix), softwareRead) << (8 * ix);
+		return value;
+	}
+
+	template <typename value_type>
+	void MMU::WriteMulti(size_t offset, value_type data) {
+		if (MemoryPage* page = GetDirectPage(offset, sizeof(value_type), true)) {
+			page->written_epoch = write_epoch;
+			memcpy(page->data + (offset & (page_size - 1)), &data, sizeof(value_type));
+			return;
+		}
+		for (size_t ix = sizeof(value_type) - 1; ix != (size_t)-1; --ix)
+			WriteData((offset & ~(size_t)0xFFFF) | (uint16_t)(offset + ix), (uint8_t)(data >> (8 * ix)));
+	}
+
+	uint16_t MMU::Read16(size_t offset, bool softwareRead) {
+		return ReadMulti<uint16_t>(offset, softwareRead);
+	}
+
+	uint32_t MMU::Read32(size_t offset, bool softwareRead) {
+		return ReadMulti<uint32_t>(offset, softwareRead);
+	}
+
+	uint64_t MMU::Read64(size_t offset, bool softwareRead) {
+		return ReadMulti<uint64_t>(offset, softwareRead);
+	}
+
+	void MMU::Write16(size_t offset, uint16_t data) {
+		WriteMulti<uint16_t>(offset, data);
+	}
+
+	void MMU::Write32(size_t offset, uint32_t data) {
+		WriteMulti<uint32_t>(offset, data);
+	}
+
+	void MMU::Write64(size_t offset, uint64_t data) {
+		WriteMulti<uint64_t>(offset, data);
+	}
+
 	size_t MMU::getRealOffset(size_t offset) {
 		size_t segment_index = offset >> 16;
 		if (segment_index < 0x10)
@@ -225,20 +346,97 @@ namespace casioemu {
 		return regions;
 	}
 
+	uint32_t MMU::WrittenSince(uint32_t epoch, const std::function<void(const uint8_t*, size_t)>& written) {
+		// * Writes from here on are stamped with a later epoch than any reported now.
+		uint32_t next = ++write_epoch;
+		for (size_t segment_index = 0; segment_index != 0x100; ++segment_index) {
+			MemoryPage* segment = segment_dispatch[segment_index];
+			if (!segment)
+				continue;
+			for (size_t ix = 0; ix != 0x10000 / page_size; ++ix) {
+				MemoryPage& page = segment[ix];
+				if (!page.written_epoch || page.written_epoch < epoch || page.written_epoch == next)
+					continue;
+				if (page.data) {
+					written(page.data, page_size);
+					continue;
+				}
+				if (!page.bytes)
+					continue;
+				size_t page_base = (segment_index << 16) | (ix << page_shift);
+				for (size_t bx = 0; bx != page_size; ++bx) {
+					MMURegion* region = page.bytes[bx];
+					if (region && region->direct_data)
+						written(region->direct_data + (page_base + bx - region->base), 1);
+				}
+			}
+		}
+		return next;
+	}
+
+	/**
+	 * Works out whether `page` still lies entirely inside a single region
+	 * after its per-byte table changed, and if so drops the table again.
+	 */
+	void MMU::UpdatePage(MemoryPage& page, size_t page_base) {
+		if (page.bytes) {
+			MMURegion* region = page.bytes[0];
+			for (size_t ix = 1; ix != page_size; ++ix)
+				if (page.bytes[ix] != region)
+					return;
+			delete[] page.bytes;
+			page.bytes = nullptr;
+			page.region = region;
+		}
+		MMURegion* region = page.region;
+		page.data = region && region->direct_data ? region->direct_data + (page_base - region->base) : nullptr;
+		page.writable = page.data && region->direct_writable;
+	}
+
 	void MMU::RegisterRegion(MMURegion* region) {
-		for (size_t ix = region->base; ix != region->base + region->size; ++ix) {
-			if (segment_dispatch[ix >> 16][ix & 0xFFFF].region)
+		for (size_t ix = region->base; ix != region->base + region->size;) {
+			MemoryPage& page = segment_dispatch[ix >> 16][(ix & 0xFFFF) >> page_shift];
+			size_t page_base = ix & ~(page_size - 1);
+			size_t end = std::min(page_base + page_size, region->base + region->size);
+			if (page.region)
 				PANIC("MMU region overlap at %06zX\n", ix);
-			segment_dispatch[ix >> 16][ix & 0xFFFF].region = region;
+			if (!page.bytes && ix == page_base && end == page_base + page_size) {
+				page.region = region;
+			}
+			else {
+				if (!page.bytes)
+					page.bytes = new MMURegion*[page_size]{};
+				for (; ix != end; ++ix) {
+					if (page.bytes[ix - page_base])
+						PANIC("MMU region overlap at %06zX\n", ix);
+					page.bytes[ix - page_base] = region;
+				}
+			}
+			UpdatePage(page, page_base);
+			ix = end;
 		}
 		regions.push_back(region);
 	}
 
 	void MMU::UnregisterRegion(MMURegion* region) {
-		for (size_t ix = region->base; ix != region->base + region->size; ++ix) {
-			if (!segment_dispatch[ix >> 16][ix & 0xFFFF].region)
-				PANIC("MMU region double-hole at %06zX\n", ix);
-			segment_dispatch[ix >> 16][ix & 0xFFFF].region = nullptr;
+		for (size_t ix = region->base; ix != region->base + region->size;) {
+			MemoryPage& page = segment_dispatch[ix >> 16][(ix & 0xFFFF) >> page_shift];
+			size_t page_base = ix & ~(page_size - 1);
+			size_t end = std::min(page_base + page_size, region->base + region->size);
+			if (page.region == region) {
+				page.region = nullptr;
+			}
+			else {
+				if (!page.bytes)
+					PANIC("MMU region double-hole at %06zX\n", ix);
+				for (; ix != end; ++ix) {
+					if (!page.bytes[ix - page_base])
+						PANIC("MMU region double-hole at %06zX\n", ix);
+					page.bytes[ix - page_base] = nullptr;
+				}
+			}
+			UpdatePage(page, page_base);
+			ix = end;
 		}
 		regions.erase(std::find(regions.begin(), regions.end(), region));
 	}
@@ -3,7 +3,12 @@
 
 #include "MMURegion.hpp"
 
+#include <array>
+#include <atomic>
 #include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -18,22 +23,134 @@ namespace casioemu
 
 		bool real_hardware;
 
-		struct MemoryByte
+		static const size_t page_shift = 8;
+		static const size_t page_size = 1 << page_shift;
+
+		/**
+		 * One entry per 256-byte page. A page that lies entirely inside one
+		 * region points at it through `region`, and if that region is backed by
+		 * host memory `data` points at the first byte of the page so that the
+		 * access needs no call at all. Pages shared by several regions (mostly
+		 * SFRs) fall back to a per-byte table in `bytes`. Every write to the
+		 * page stamps it with the current `write_epoch`, see `WrittenSince`.
+		 */
+		struct MemoryPage
 		{
 			MMURegion *region;
+			uint8_t *data;
+			bool writable;
+			MMURegion **bytes;
+			uint32_t written_epoch;
 		};
-		MemoryByte **segment_dispatch;
+		uint32_t write_epoch = 1;
+		MemoryPage **segment_dispatch;
 		std::vector<MMURegion*> regions;
+
+		void UpdatePage(MemoryPage &page, size_t page_base);
+		uint8_t ReadBus(size_t offset, bool softwareRead);
+		MemoryPage *GetDirectPage(size_t offset, size_t length, bool write);
+
+		template <typename value_type>
+		value_type ReadMulti(size_t offset, bool softwareRead);
+		template <typename value_type>
+		void WriteMulti(size_t offset, value_type data);
+
+		typedef std::array<const uint8_t *, 0x10000 / page_size> CodeSegment;
+		/**
+		 * Where instruction fetches come from: a host pointer for every
+		 * 256-byte page of every code segment, worked out once from the
+		 * hardware model's code map by `UpdateCodePages`. Unmapped pages point
+		 * at a page of 00h or FFh bytes, whichever the model reads there.
+		 */
+		CodeSegment *code_pages[0x100];
+		CodeSegment *code_pages_unaliased[0x100];
+		std::deque<CodeSegment> code_segments;
+		const uint8_t *code_rom_data = nullptr, *code_flash_data = nullptr;
+		bool code_remap = false;
+		const uint8_t *CodePage(size_t address);
+
+		// * One bit per 16-byte granule of the 24-bit data address space; reads in [0], writes in [1].
+		std::vector<uint64_t> watch_bits[2];
 	public:
 		MMU(Emulator &emulator);
 		~MMU();
 		void SetupInternals();
 		void GenerateSegmentDispatch(size_t segment_index);
-		uint16_t ReadCode(size_t offset);
+		/**
+		 * Rebuilds `code_pages`. Has to be called whenever `Chipset::remap`,
+		 * `Chipset::SegmentAccess` or the ROM/flash buffers change; a change of
+		 * `SegmentAccess` alone only re-points segment 5.
+		 */
+		void UpdateCodePages();
+		uint16_t ReadCode(size_t offset) {
+			uint16_t value;
+			memcpy(&value, &(*code_pages[(offset >> 16) & 0xFF])[(offset >> page_shift) & 0xFF][offset & 0xFE], 2);
+			return value;
+		}
+		/**
+		 * `softwareRead` marks an access made by the running program. Only
+		 * those raise the read hooks and charge the region's wait states to
+		 * the current instruction; debugger windows and plugins read with it
+		 * cleared, so they cannot disturb the CPU's timing.
+		 */
 		uint8_t ReadData(size_t offset, bool softwareRead = true);
 		void WriteData(size_t offset, uint8_t data, bool softwareWrite = true);
+		/**
+		 * Little-endian multi-byte accesses. Like the CPU's own data accesses,
+		 * addresses wrap around inside the 64 KB segment. An access that stays
+		 * inside one host-backed page is a single memcpy; anything else goes
+		 * through `ReadData`/`WriteData` one byte at a time, reading from the
+		 * lowest byte up and writing from the highest byte down, so SFR side
+		 * effects keep their order.
+		 */
+		uint16_t Read16(size_t offset, bool softwareRead = true);
+		uint32_t Read32(size_t offset, bool softwareRead = true);
+		uint64_t Read64(size_t offset, bool softwareRead = true);
+		void Write16(size_t offset, uint16_t data);
+		void Write32(size_t offset, uint32_t data);
+		void Write64(size_t offset, uint64_t data);
 		size_t getRealOffset(size_t offset);
 
+		static const size_t watch_granule_shift = 4;
+		enum WatchKind
+		{
+			WATCH_READ = 1,
+			WATCH_WRITE = 2
+		};
+		/**
+		 * Marks `length` bytes from `begin` as watched for the accesses in
+		 * `kinds`. Software accesses to a watched granule raise `on_memory_read`/
+		 * `on_memory_write` even while no listener asked for every access, and
+		 * never take the multi-byte fast path. Watched reads also raise
+		 * `on_watched_read` with the value read. Granules are 16 bytes wide, so
+		 * listeners still have to check the exact range themselves.
+		 */
+		void SetWatch(size_t begin, size_t length, int kinds);
+		void ClearWatches();
+		bool Watched(size_t offset, WatchKind kind) const
+		{
+			size_t granule = (offset & 0xFFFFFF) >> watch_granule_shift;
+			return (watch_bits[kind == WATCH_WRITE][granule >> 6] >> (granule & 63)) & 1;
+		}
+
+
+		/**
+		 * Calls `written` with the host memory behind every page written since
+		 * `epoch`, 0 for every page ever written, and returns the epoch to pass
+		 * next time. Save states use it to compare only those pages with their
+		 * previous capture.
+		 */
+		uint32_t WrittenSince(uint32_t epoch, const std::function<void(const uint8_t *data, size_t size)> &written);
+		/**
+		 * Counts changes to emulated memory made around the MMU, such as flash
+		 * programming or the debugger patching RAM. Any thread may call it.
+		 * After one, save states compare every page again.
+		 */
+		void MarkHostWrite()
+		{
+			++host_writes;
+		}
+		std::atomic<uint32_t> host_writes{};
 
 		std::vector<MMURegion*> GetRegions();
 		void RegisterRegion(MMURegion *region);
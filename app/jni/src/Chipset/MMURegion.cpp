@@ -10,6 +10,9 @@ namespace casioemu
 	MMURegion::MMURegion()
 	{
 		setup_done = false;
+		wait_states = 0;
+		direct_data = nullptr;
+		direct_writable = false;
 	}
 
 	MMURegion::~MMURegion()
@@ -35,10 +38,19 @@ namespace casioemu
 		setup_done = true;
 	}
 
+	void MMURegion::SetupDirect(size_t _base, size_t _size, std::string _description, uint8_t *_data, WriteFunction _write, Emulator &_emulator)
+	{
+		direct_data = _data;
+		direct_writable = !_write;
+		Setup(_base, _size, _description, _data, DirectRead, _write ? _write : DirectWrite, _emulator);
+	}
+
 	void MMURegion::Kill()
 	{
 		emulator->chipset.mmu.UnregisterRegion(this);
 		setup_done = false;
+		direct_data = nullptr;
+		direct_writable = false;
 	}
 }
 
@@ -17,6 +17,17 @@ namespace casioemu {
 		void* userdata;
 		ReadFunction read;
 		WriteFunction write;
+		/**
+		 * Extra CPU cycles taken by every data read from this region.
+		 */
+		size_t wait_states;
+		/**
+		 * Host memory holding the region byte for byte, see `SetupDirect`.
+		 * The MMU reads it without going through `read`, and writes it without
+		 * going through `write` if `direct_writable` is set.
+		 */
+		uint8_t* direct_data;
+		bool direct_writable;
 		bool setup_done;
 		Emulator* emulator;
 
@@ -30,6 +41,11 @@ namespace casioemu {
 		MMURegion& operator=(MMURegion&&) = delete;
 		~MMURegion();
 		void Setup(size_t base, size_t size, std::string description, void* userdata, ReadFunction read, WriteFunction write, Emulator& emulator);
+		/**
+		 * Sets up a region that is plain memory at `data`. Writes go to `data`
+		 * too, unless a `write` handler is given (e.g. for ROM).
+		 */
+		void SetupDirect(size_t base, size_t size, std::string description, uint8_t* data, WriteFunction write, Emulator& emulator);
 		void Kill();
 
 		template <uint8_t read_value>
@@ -40,6 +56,14 @@ namespace casioemu {
 		static void IgnoreWrite(MMURegion*, size_t, uint8_t) {
 		}
 
+		static uint8_t DirectRead(MMURegion* region, size_t offset) {
+			return region->direct_data[offset - region->base];
+		}
+
+		static void DirectWrite(MMURegion* region, size_t offset, uint8_t data) {
+			region->direct_data[offset - region->base] = data;
+		}
+
 		template <typename value_type, value_type mask = (value_type)-1>
 		static uint8_t DefaultRead(MMURegion* region, size_t offset) {
 			value_type* value = (value_type*)(region->userdata);
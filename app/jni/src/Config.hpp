@@ -15,7 +15,7 @@
 #define FUNCTION_NAME __func__
 #endif
 
-#ifdef __clang__
+#ifndef _MSC_VER
 #define __debugbreak __builtin_trap
 #endif
 
@@ -24,6 +24,7 @@
 #define PANIC(...)           \
 	{                        \
 		printf(__VA_ARGS__); \
+		fflush(stdout);      \
 		__debugbreak();      \
 	}
 #else
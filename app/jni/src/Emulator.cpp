@@ -1,9 +1,17 @@
 ﻿#include <SDL.h>
 #include "Emulator.hpp"
+#include "Chipset/CPU.hpp"
 #include "Chipset/Chipset.hpp"
+#include "FramePacer.hpp"
+#include "Gui/Hooks.h"
 #include "Logger.hpp"
 #include "ModelInfo.h"
+#include "Peripheral/Screen.hpp"
+#include "Replay.hpp"
+#include "Rewind.hpp"
+#include "SaveState.hpp"
 #include <cassert>
+#include <climits>
 #include <chrono>
 #include <filesystem>
 #include <fstream>
@@ -12,7 +20,10 @@
 #include <string>
 
 namespace casioemu {
-	Emulator::Emulator(std::map<std::string, std::string>& _argv_map, bool _paused) : Paused(_paused), argv_map(_argv_map), chipset(*new Chipset(*this)) {
+	// * How often `Chipset::EmulatorTick` runs when not emulating real hardware.
+	constexpr unsigned int EMULATOR_TICK_INTERVAL_MS = 25;
+
+	Emulator::Emulator(std::map<std::string, std::string>& _argv_map, bool _paused) : Paused(_paused), argv_map(_argv_map), hooks(*new EmulatorHooks), chipset(*new Chipset(*this)), save_states(*new SaveStates(*this)), rewind(*new RewindBuffer(*this)), replay(*new Replay(*this)), frame_pacer(*new FramePacer(*this)) {
 		// std::lock_guard<decltype(access_mx)> access_lock(access_mx);
 
 		running = true;
@@ -34,8 +45,32 @@ namespace casioemu {
 		}
 		timer_interval = 20;
 
+		headless = argv_map.find("headless") != argv_map.end();
+		deterministic = headless || argv_map.find("deterministic") != argv_map.end() || argv_map.find("record") != argv_map.end() || argv_map.find("replay") != argv_map.end();
+		random_seed = 0;
+		try {
+			std::size_t pos;
+			auto seed_iter = argv_map.find("seed");
+			if (seed_iter != argv_map.end()) {
+				auto seed = std::stoul(seed_iter->second, &pos, 0);
+				if (pos != seed_iter->second.size())
+					PANIC("seed parameter has extraneous trailing characters\n");
+				if (seed > UINT_MAX)
+					throw std::out_of_range("seed");
+				random_seed = (unsigned int)seed;
+			}
+		}
+		catch (std::invalid_argument const&) {
+			PANIC("invalid seed parameter\n");
+		}
+		catch (std::out_of_range const&) {
+			PANIC("out of range seed parameter\n");
+		}
+
 		cycles.Setup(cycles_per_second, timer_interval);
 		chipset.Setup();
+		rewind.Setup();
+		ScheduleEmulatorTick();
 
 		BatteryVoltage = 1.5;
 		SolarPanelVoltage = 1.5;
@@ -69,27 +104,43 @@ namespace casioemu {
 		catch (std::out_of_range const&) {
 			PANIC("out of range width/height parameter\n");
 		}
-		SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "best");
-		window = SDL_CreateWindow(
-			std::string(ModelDefinition.model_name).c_str(),
-			SDL_WINDOWPOS_UNDEFINED,
-			SDL_WINDOWPOS_UNDEFINED,
-			width, height,
-			SDL_WINDOW_SHOWN | (SDL_WINDOW_RESIZABLE));
-		if (!window)
-			PANIC("SDL_CreateWindow failed: %s\n", SDL_GetError());
-		renderer = SDL_CreateRenderer(window, -1, 0);
-		if (!renderer)
-			PANIC("SDL_CreateRenderer failed: %s\n", SDL_GetError());
-
-		interface_surface = IMG_Load(GetModelFilePath(ModelDefinition.interface_path).c_str());
-		if (!interface_surface)
-			PANIC("IMG_Load failed: %s\n", IMG_GetError());
-		interface_texture = SDL_CreateTextureFromSurface(renderer, interface_surface);
+		if (headless) {
+			window = nullptr;
+			renderer = nullptr;
+			interface_surface = nullptr;
+			interface_texture = nullptr;
+		}
+		else {
+#ifdef CASIOEMU_HEADLESS
+			// Built without SDL_image, so there is no calculator face to draw.
+			PANIC("this build only runs headless\n");
+#else
+			SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "best");
+			window = SDL_CreateWindow(
+				std::string(ModelDefinition.model_name).c_str(),
+				SDL_WINDOWPOS_UNDEFINED,
+				SDL_WINDOWPOS_UNDEFINED,
+				width, height,
+				SDL_WINDOW_SHOWN | (SDL_WINDOW_RESIZABLE));
+			if (!window)
+				PANIC("SDL_CreateWindow failed: %s\n", SDL_GetError());
+			renderer = SDL_CreateRenderer(window, -1, frame_pacer.vsync ? SDL_RENDERER_PRESENTVSYNC : 0);
+			if (!renderer)
+				PANIC("SDL_CreateRenderer failed: %s\n", SDL_GetError());
+			frame_pacer.Setup();
+
+			interface_surface = IMG_Load(GetModelFilePath(ModelDefinition.interface_path).c_str());
+			if (!interface_surface)
+				PANIC("IMG_Load failed: %s\n", IMG_GetError());
+			interface_texture = SDL_CreateTextureFromSurface(renderer, interface_surface);
+#endif
+		}
 
 		SetupInternals();
 		cycles.Reset();
-		if (ModelDefinition.real_hardware) {
+		if (headless)
+			tick_thread = nullptr;
+		else if (ModelDefinition.real_hardware) {
 			tick_thread = new std::thread([this] {
 				auto iteration_end = std::chrono::steady_clock::now();
 				while (1) {
@@ -115,19 +166,27 @@ namespace casioemu {
 					{
 						if (!Running())
 							break;
-						if (!Paused)
+						if (tick_tasks_pending)
+							RunTickTasks();
+						if (!Paused) {
 							Tick();
+							// Nothing happens until another thread raises an interrupt.
+							// In deterministic mode the next `EmulatorTick` is a number of ticks away instead.
+							if (!deterministic && chipset.IsIdle())
+								std::this_thread::sleep_for(std::chrono::milliseconds(1));
+						}
 					}
 				}
 			});
-			SDL_AddTimer(
-				25,
-				[](Uint32 interval, void* param) -> Uint32 {
-					auto emu = ((Emulator*)param);
-					emu->chipset.EmulatorTick();
-					return interval;
-				},
-				this);
+			if (!deterministic)
+				SDL_AddTimer(
+					EMULATOR_TICK_INTERVAL_MS,
+					[](Uint32 interval, void* param) -> Uint32 {
+						auto emu = ((Emulator*)param);
+						emu->chipset.EmulatorTick();
+						return interval;
+					},
+					this);
 		}
 
 		RunStartupScript();
@@ -138,20 +197,34 @@ namespace casioemu {
 			SetPaused(true);
 
 		pause_on_mem_error = argv_map.find("pause_on_mem_error") != argv_map.end();
+
+		replay.Start();
 	}
 
 	Emulator::~Emulator() {
-		if (tick_thread->joinable())
+		if (tick_thread && tick_thread->joinable())
 			tick_thread->join();
 		delete tick_thread;
 
 		// std::lock_guard<decltype(access_mx)> access_lock(access_mx);
 
-		SDL_DestroyTexture(interface_texture);
-		SDL_DestroyRenderer(renderer);
-		SDL_DestroyWindow(window);
+		if (!headless) {
+			if (frame_texture)
+				SDL_DestroyTexture(frame_texture);
+			if (face_texture)
+				SDL_DestroyTexture(face_texture);
+			SDL_DestroyTexture(interface_texture);
+			SDL_DestroyRenderer(renderer);
+			SDL_DestroyWindow(window);
+		}
 
+		replay.Stop();
+		delete &replay;
+		delete &frame_pacer;
+		delete &rewind;
+		delete &save_states;
 		delete &chipset;
+		delete &hooks;
 	}
 
 	void Emulator::HandleMemoryError() {
@@ -225,10 +298,29 @@ namespace casioemu {
 	void Emulator::TimerCallback() {
 		// std::lock_guard<decltype(access_mx)> access_lock(access_mx);
 
+		if (tick_tasks_pending)
+			RunTickTasks();
+
 		Uint64 cycles_to_emulate = cycles.GetDelta();
-		for (Uint64 ix = 0; ix != cycles_to_emulate; ++ix)
-			if (!Paused)
-				Tick();
+		for (Uint64 ix = 0; ix < cycles_to_emulate; ++ix) {
+			if (Paused)
+				continue;
+			// * While the CPU sleeps, jump straight to the next clock edge that matters,
+			// but not past the next replayed key action.
+			ix += chipset.SkipIdleTicks(std::min<Uint64>(cycles_to_emulate - ix - 1, replay.next_event_tick - chipset.GetTickCount() - 1));
+			Tick();
+		}
+	}
+
+	void Emulator::RunTicks(uint64_t ticks) {
+		uint64_t end = chipset.GetTickCount() + ticks;
+		while (chipset.GetTickCount() < end) {
+			if (tick_tasks_pending)
+				RunTickTasks();
+			uint64_t now = chipset.GetTickCount();
+			chipset.SkipIdleTicks(std::min(end - now - 1, replay.next_event_tick - now - 1));
+			Tick();
+		}
 	}
 
 	void Emulator::Repaint() {
@@ -238,19 +330,40 @@ namespace casioemu {
 	void Emulator::Frame() {
 		// std::lock_guard<decltype(access_mx)> access_lock(access_mx);
 
-		// create texture `tx` with the same format as `interface_texture`
-		Uint32 format;
-		SDL_QueryTexture(interface_texture, &format, nullptr, nullptr, nullptr);
-		SDL_Texture* tx = SDL_CreateTexture(renderer, format, SDL_TEXTUREACCESS_TARGET, interface_background.dest.w, interface_background.dest.h);
+		// (re)create the cached targets with the same format as `interface_texture`
+		if (!frame_texture || frame_width != interface_background.dest.w || frame_height != interface_background.dest.h) {
+			SDL_DestroyTexture(frame_texture);
+			SDL_DestroyTexture(face_texture);
+			frame_width = interface_background.dest.w;
+			frame_height = interface_background.dest.h;
+			Uint32 format;
+			SDL_QueryTexture(interface_texture, &format, nullptr, nullptr, nullptr);
+			frame_texture = SDL_CreateTexture(renderer, format, SDL_TEXTUREACCESS_TARGET, frame_width, frame_height);
+			face_texture = SDL_CreateTexture(renderer, format, SDL_TEXTUREACCESS_TARGET, frame_width, frame_height);
+			if (!frame_texture || !face_texture)
+				PANIC("SDL_CreateTexture failed: %s\n", SDL_GetError());
+			// The face replaces whatever was in `frame_texture`.
+			SDL_SetTextureBlendMode(face_texture, SDL_BLENDMODE_NONE);
+			face_valid = false;
+		}
+
+		// the face only changes with the model, so it is drawn once
+		if (!face_valid) {
+			SDL_SetRenderTarget(renderer, face_texture);
+			SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+			SDL_RenderClear(renderer);
+			SDL_SetTextureColorMod(interface_texture, 255, 255, 255);
+			SDL_SetTextureAlphaMod(interface_texture, 255);
+			SDL_Rect tmp = interface_background.src;
+			SDL_RenderCopy(renderer, interface_texture, &tmp, nullptr);
+			face_valid = true;
+		}
 
-		// render on `tx`
-		SDL_SetRenderTarget(renderer, tx);
-		SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-		SDL_RenderClear(renderer);
+		// render the LCD and key overlays on a copy of it
+		SDL_SetRenderTarget(renderer, frame_texture);
+		SDL_RenderCopy(renderer, face_texture, nullptr, nullptr);
 		SDL_SetTextureColorMod(interface_texture, 255, 255, 255);
 		SDL_SetTextureAlphaMod(interface_texture, 255);
-		SDL_Rect tmp = interface_background.src;
-		SDL_RenderCopy(renderer, interface_texture, &tmp, nullptr);
 		chipset.Frame();
 		
 		// resize and copy `tx` to screen
@@ -265,17 +378,82 @@ namespace casioemu {
 		dest.h = interface_background.src.h * uf;
 		dest.x = (w - dest.w) / 2;
 		dest.y = (h - dest.h) / 2; // Centre it
-		SDL_RenderCopy(renderer, tx, nullptr, &dest);
+		SDL_RenderCopy(renderer, frame_texture, nullptr, &dest);
 		emu_rect = dest;
-		SDL_DestroyTexture(tx);
 		Repaint();
 	}
 
+	void Emulator::InvalidateFrameCache() {
+		face_valid = false;
+	}
+
+	void Emulator::RecreateTextures() {
+		if (headless)
+			return;
+		// Frame creates these again at the next opportunity.
+		SDL_DestroyTexture(frame_texture);
+		SDL_DestroyTexture(face_texture);
+		frame_texture = face_texture = nullptr;
+		face_valid = false;
+
+		SDL_DestroyTexture(interface_texture);
+		interface_texture = SDL_CreateTextureFromSurface(renderer, interface_surface);
+		if (!interface_texture)
+			PANIC("SDL_CreateTextureFromSurface failed: %s\n", SDL_GetError());
+		auto screen = chipset.QueryInterface<IScreen>();
+		if (screen)
+			screen->DeviceReset();
+	}
+
+	bool Emulator::FramePending() {
+		auto screen = chipset.QueryInterface<IScreen>();
+		return !screen || screen->FramePending();
+	}
+
 	void Emulator::WindowResize(int _width, int _height) {
 	}
 
 	void Emulator::Tick() {
 		chipset.Tick();
+		uint64_t tick_count = chipset.GetTickCount();
+		if (tick_count >= next_emulator_tick) {
+			chipset.EmulatorTick();
+			ScheduleEmulatorTick();
+		}
+		if (tick_count >= replay.next_event_tick)
+			replay.Play();
+		if (tick_count >= rewind.next_capture_tick)
+			rewind.Capture();
+	}
+
+	void Emulator::ScheduleEmulatorTick() {
+		if (!deterministic || ModelDefinition.real_hardware) {
+			next_emulator_tick = UINT64_MAX;
+			return;
+		}
+		// * On multiples of the interval, so that a restored state gets the same ones.
+		uint64_t interval = (uint64_t)cycles_per_second * EMULATOR_TICK_INTERVAL_MS / 1000;
+		next_emulator_tick = (chipset.GetTickCount() / interval + 1) * interval;
+	}
+
+	void Emulator::RunOnTickThread(std::function<void()> task) {
+		std::lock_guard<std::mutex> lock(tick_tasks_mx);
+		tick_tasks.push_back(std::move(task));
+		tick_tasks_pending = true;
+	}
+
+	void Emulator::RunTickTasks() {
+		std::vector<std::function<void()>> tasks;
+		{
+			std::lock_guard<std::mutex> lock(tick_tasks_mx);
+			tasks.swap(tick_tasks);
+			tick_tasks_pending = false;
+		}
+		for (auto& task : tasks)
+			task();
+		// * A task may have run instructions, e.g. `RewindBuffer::StepBack`.
+		if (Paused)
+			chipset.cpu.MaterializeFlags();
 	}
 
 	bool Emulator::Running() {
@@ -296,7 +474,19 @@ namespace casioemu {
 	}
 
 	void Emulator::SetPaused(bool _paused) {
-		Paused = _paused;
+		if (!tick_thread || std::this_thread::get_id() == tick_thread->get_id()) {
+			// The debugger shows and edits PSW while paused.
+			if (_paused)
+				chipset.cpu.MaterializeFlags();
+			Paused = _paused;
+			return;
+		}
+		// * Both ways through the queue, so a pause and a resume take effect in order.
+		RunOnTickThread([this, _paused] {
+			if (_paused)
+				chipset.cpu.MaterializeFlags();
+			Paused = _paused;
+		});
 	}
 
 	void Emulator::Cycles::Setup(Uint64 _cycles_per_second, unsigned int _timer_interval) {
@@ -331,6 +521,18 @@ namespace casioemu {
 		return cycles.cycles_per_second;
 	}
 
+	Uint64 Emulator::GetTicks() {
+		if (!deterministic)
+			return SDL_GetTicks64();
+		return chipset.GetTickCount() * 1000 / cycles_per_second;
+	}
+
+	unsigned int Emulator::GetRandomSeed() {
+		if (!deterministic)
+			return (unsigned int)SDL_GetPerformanceCounter();
+		return random_seed;
+	}
+
 	void Emulator::SetClockSpeed(float speed) {
 		cycles.Setup((unsigned int)(cycles_per_second * speed), timer_interval);
 	}
@@ -4,18 +4,27 @@
 #include <string>
 #include <map>
 #include <SDL.h>
+#ifndef CASIOEMU_HEADLESS
 #include <SDL_image.h>
+#endif
 
 #include <mutex>
 #include <thread>
 #include <condition_variable>
+#include <functional>
 #include <queue>
 
+struct EmulatorHooks;
+
 namespace casioemu
 {
 	class Chipset;
 	class CPU;
 	class MMU;
+	class SaveStates;
+	class RewindBuffer;
+	class Replay;
+	class FramePacer;
 
 	/**
 	 * A mutex that ensures that a thread cannot get the mutex right after it's released if there are another waiting thread.
@@ -46,14 +55,41 @@ namespace casioemu
 		unsigned int last_frame_tick_count;
 		std::string model_path;
 		bool pause_on_mem_error;
+		/**
+		 * Set through the `deterministic` key, or by recording or playing a
+		 * replay. Emulation then only depends on the input it is given: time
+		 * comes from the tick count, random fills use `GetRandomSeed`, and
+		 * keyboard input is applied between ticks on the tick thread.
+		 */
+		bool deterministic;
+		unsigned int random_seed;
+		/**
+		 * Set through the `headless` key, for `BatchRunner`. There is no window,
+		 * renderer, sound or tick thread, `RunTicks` drives the machine
+		 * instead, and deterministic mode is on.
+		 */
+		bool headless;
 
 		std::atomic<bool> screenshot_requested{};
 		std::atomic<bool> mirroring_requested{};
 
 		std::thread *tick_thread;
 
+		std::mutex tick_tasks_mx;
+		std::vector<std::function<void()>> tick_tasks;
+		std::atomic<bool> tick_tasks_pending{};
+		void RunTickTasks();
+
 		SpriteInfo interface_background;
 		SDL_Rect emu_rect{};
+		/**
+		 * Frame renders into frame_texture at the size of the interface, and
+		 * starts each frame from face_texture, the calculator face composited
+		 * once. Both are kept until the size changes.
+		 */
+		SDL_Texture *frame_texture = nullptr, *face_texture = nullptr;
+		int frame_width = 0, frame_height = 0;
+		bool face_valid = false;
 
 		/**
 		 * A bunch of internally used methods for encapsulation purposes.
@@ -95,12 +131,25 @@ namespace casioemu
 			Uint64 ticks_now, cycles_emulated, cycles_per_second;
 			unsigned int timer_interval;
 		} cycles;
+		/**
+		 * Debugger and plugin hooks into this emulator's execution, see
+		 * Gui/Hooks.h. Constructed before the chipset, which raises them.
+		 */
+		EmulatorHooks &hooks;
 		/**
 		 * A reference to the emulator chipset. This object holds all CPU, MMU, memory and
 		 * peripheral state. The emulator interfaces with the chipset by issuing interrupts
 		 * and rendering the screen buffer. It may also read internal state for testing purposes.
 		 */
 		Chipset &chipset;
+		SaveStates &save_states;
+		RewindBuffer &rewind;
+		Replay &replay;
+		FramePacer &frame_pacer;
+
+		// * In deterministic mode, where `Emulator::Tick` calls `Chipset::EmulatorTick` instead of a host timer.
+		uint64_t next_emulator_tick = UINT64_MAX;
+		void ScheduleEmulatorTick();
 
 		float BatteryVoltage, SolarPanelVoltage;
 
@@ -108,21 +157,59 @@ namespace casioemu
 		void HandleMemoryError();
 		void Shutdown();
 		void Tick();
+		/**
+		 * Runs `ticks` ticks on the calling thread as fast as possible,
+		 * whether paused or not. Only for headless use, where nothing else
+		 * ticks the machine.
+		 */
+		void RunTicks(uint64_t ticks);
 		/**
 		 * Called when SDL_WINDOWEVENT_EXPOSED event is received. Does not re-frame.
 		 */
 		void Repaint();
 		void Frame();
+		/**
+		 * Whether the LCD has changed since the last `Frame`, see
+		 * `IScreen::FramePending`.
+		 */
+		bool FramePending();
+		/**
+		 * Redraws the cached calculator face on the next `Frame`, e.g. after
+		 * SDL_RENDER_TARGETS_RESET lost the contents of render targets.
+		 */
+		void InvalidateFrameCache();
+		/**
+		 * Recreates every texture after SDL_RENDER_DEVICE_RESET, which loses
+		 * their contents along with the device.
+		 */
+		void RecreateTextures();
 		void WindowResize(int width, int height);
 		void ExecuteCommand(std::string command);
 		unsigned int GetCyclesPerSecond();
+		/**
+		 * Milliseconds for peripherals that go by time rather than by clock
+		 * ticks. Emulated time in deterministic mode, host time otherwise.
+		 */
+		Uint64 GetTicks();
+		unsigned int GetRandomSeed();
 		void SetClockSpeed(float speed);
 		bool GetPaused();
+		/**
+		 * From any other thread the change is queued with `RunOnTickThread`,
+		 * so `GetPaused` only turns true once PSW holds every lazy flag and
+		 * the debugger can read and write it.
+		 */
 		void SetPaused(bool paused);
 		void UIEvent(SDL_Event &event);
 		SDL_Renderer *GetRenderer();
 		SDL_Texture *GetInterfaceTexture();
 		std::string GetModelFilePath(std::string relative_path);
+		/**
+		 * Queues `task` to run on the tick thread between two ticks, also while
+		 * paused. Use it for anything that has to see or change the machine in
+		 * a consistent state, such as `SaveStates::Capture`.
+		 */
+		void RunOnTickThread(std::function<void()> task);
 
 		friend class CPU;
 		friend class MMU;
@@ -1,6 +1,9 @@
 ﻿#include "GameBuffer.h"
 #include <concepts>
 #include <array>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
 template <std::integral Int, typename CharT>
 inline void itoa_2(Int num, CharT* out) {
 	int j = 0;
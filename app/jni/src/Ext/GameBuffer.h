@@ -4,6 +4,7 @@
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <climits>
 #include <functional>
 #include <cstring>
 #include <utility>
@@ -11,7 +11,7 @@ namespace casioemu
 		{
 			va_list args;
 			va_start(args, format);
-			printf(format, args);
+			vprintf(format, args);
 			va_end(args);
 			
 		}
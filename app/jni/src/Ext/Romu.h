@@ -1,4 +1,5 @@
 ﻿#pragma once
+#include <cmath>
 #include <vector>
 using word = unsigned short;
 using byte = unsigned char;
@@ -0,0 +1,137 @@
+﻿#include "FramePacer.hpp"
+
+#include "Emulator.hpp"
+#include "Logger.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <stdexcept>
+#include <string>
+
+namespace casioemu {
+	// * Used when the display doesn't report its refresh rate.
+	constexpr unsigned int DEFAULT_FPS = 60;
+
+	FramePacer::FramePacer(Emulator& _emulator) : emulator(_emulator) {
+		frequency = SDL_GetPerformanceFrequency();
+		auto fps_iter = emulator.argv_map.find("fps");
+		try {
+			std::size_t pos;
+			if (fps_iter != emulator.argv_map.end()) {
+				auto fps = std::stoul(fps_iter->second, &pos, 0);
+				if (pos != fps_iter->second.size())
+					PANIC("fps parameter has extraneous trailing characters\n");
+				if (fps > UINT_MAX)
+					throw std::out_of_range("fps");
+				target_fps = (unsigned int)fps;
+			}
+		}
+		catch (std::invalid_argument const&) {
+			PANIC("invalid fps parameter\n");
+		}
+		catch (std::out_of_range const&) {
+			PANIC("out of range fps parameter\n");
+		}
+		vsync = !target_fps;
+	}
+
+	void FramePacer::Setup() {
+		unsigned int fps = target_fps;
+		if (!fps) {
+			SDL_DisplayMode mode;
+			int display = SDL_GetWindowDisplayIndex(emulator.window);
+			if (display >= 0 && SDL_GetCurrentDisplayMode(display, &mode) == 0 && mode.refresh_rate > 0)
+				fps = mode.refresh_rate;
+			else
+				fps = DEFAULT_FPS;
+		}
+		// * With vsync this only keeps a renderer that doesn't wait for it from spinning.
+		interval = frequency / fps;
+		logger::Info("[FramePacer][Info] %u fps%s\n", fps, vsync ? ", vsync" : "");
+
+		wake_event = SDL_RegisterEvents(1);
+	}
+
+	void FramePacer::RequestFrame() {
+		++requests;
+		Uint32 type = wake_event.load();
+		if (!type)
+			return;
+		if (wake_queued.exchange(true)) {
+			++coalesced;
+			return;
+		}
+		SDL_Event event{};
+		event.type = type;
+		SDL_PushEvent(&event);
+	}
+
+	bool FramePacer::IsWakeEvent(const SDL_Event& event) {
+		if (!wake_event.load() || event.type != wake_event.load())
+			return false;
+		wake_queued = false;
+		return true;
+	}
+
+	bool FramePacer::FrameDue(bool wanted) {
+		if (!wanted)
+			idled = true;
+		return wanted && SDL_GetPerformanceCounter() >= next_frame;
+	}
+
+	Uint32 FramePacer::WaitTimeout(bool wanted, Uint32 idle_ms) {
+		if (!wanted)
+			return idle_ms;
+		Uint64 now = SDL_GetPerformanceCounter();
+		if (now >= next_frame)
+			return 0;
+		// * Rounded up, waking early would only mean waiting again.
+		return (Uint32)(((next_frame - now) * 1000 + frequency - 1) / frequency);
+	}
+
+	void FramePacer::BeginFrame() {
+		frame_start = SDL_GetPerformanceCounter();
+		// * Keep to the grid, unless the loop fell more than a frame behind it.
+		next_frame = std::max(next_frame + interval, frame_start);
+		// * The first frame, and any after an idle stretch, have no interval to go by.
+		if (!idled) {
+			frame_times[frame_next] = frame_start - last_frame_start;
+			frame_next = (frame_next + 1) % history_size;
+			frame_count = std::min(frame_count + 1, history_size);
+		}
+		idled = false;
+		last_frame_start = frame_start;
+	}
+
+	void FramePacer::EndFrame() {
+		render_times[render_next] = SDL_GetPerformanceCounter() - frame_start;
+		render_next = (render_next + 1) % history_size;
+		render_count = std::min(render_count + 1, history_size);
+		++presented;
+	}
+
+	FramePacer::Stats FramePacer::GetStats() const {
+		Stats stats{};
+		stats.presented = presented;
+		stats.requests = requests;
+		stats.coalesced = coalesced;
+		double ms = 1000.0 / frequency;
+		if (frame_count) {
+			Uint64 total = 0, worst = 0;
+			for (size_t ix = 0; ix != frame_count; ++ix) {
+				total += frame_times[ix];
+				worst = std::max(worst, frame_times[ix]);
+			}
+			stats.average_ms = total * ms / frame_count;
+			stats.worst_ms = worst * ms;
+			stats.fps = stats.average_ms > 0 ? 1000 / stats.average_ms : 0;
+		}
+		if (render_count) {
+			Uint64 render = 0;
+			for (size_t ix = 0; ix != render_count; ++ix)
+				render += render_times[ix];
+			stats.render_ms = render * ms / render_count;
+		}
+		return stats;
+	}
+} // namespace casioemu
@@ -0,0 +1,85 @@
+﻿#pragma once
+#include "Config.hpp"
+
+#include <SDL.h>
+#include <atomic>
+#include <cstdint>
+
+namespace casioemu {
+	class Emulator;
+
+	/**
+	 * Decides when the main loop presents a frame. By default the renderer
+	 * waits for vsync and frames are spaced at the display's refresh rate;
+	 * with the `fps` key they are spaced 1/fps apart on the performance
+	 * counter instead, and the renderer is created without vsync.
+	 *
+	 * Anything that changes what is shown calls `RequestFrame`, from any
+	 * thread, to wake the main loop. Requests made while an earlier one is
+	 * still queued are folded into it, so there is never more than one
+	 * wake-up event in SDL's queue, and however many come in, at most one
+	 * frame is presented per interval.
+	 *
+	 * All other methods must be called on the main thread.
+	 */
+	class FramePacer {
+		Emulator& emulator;
+		std::atomic<Uint32> wake_event{};
+		std::atomic<bool> wake_queued{};
+		std::atomic<uint64_t> requests{}, coalesced{};
+
+		Uint64 frequency, interval = 0, next_frame = 0, frame_start = 0, last_frame_start = 0;
+		// * Whether nothing was wanted since the last frame. The gap before the next one is then idle time, not a frame interval.
+		bool idled = true;
+
+		/**
+		 * Performance counter ticks between frames presented back to back,
+		 * and spent rendering each frame, the newest at `*_next - 1`.
+		 */
+		static constexpr size_t history_size = 120;
+		Uint64 frame_times[history_size]{}, render_times[history_size]{};
+		size_t frame_next = 0, frame_count = 0, render_next = 0, render_count = 0;
+		uint64_t presented = 0;
+
+	public:
+		bool vsync;
+		// * Set through the `fps` key, 0 goes by the display's refresh rate.
+		unsigned int target_fps = 0;
+
+		struct Stats {
+			double fps, average_ms, worst_ms, render_ms;
+			uint64_t presented, requests, coalesced;
+		};
+
+		FramePacer(Emulator& emulator);
+
+		/**
+		 * Registers the wake-up event and works out the frame interval. Called
+		 * once the window exists.
+		 */
+		void Setup();
+
+		void RequestFrame();
+		/**
+		 * Whether `event` is the wake-up event, which carries nothing else and
+		 * needn't be handled further.
+		 */
+		bool IsWakeEvent(const SDL_Event& event);
+
+		/**
+		 * Whether to present now, given whether there is anything `wanted`.
+		 */
+		bool FrameDue(bool wanted);
+		/**
+		 * How long the main loop can wait for events before the next frame is
+		 * due, or before `idle_ms` have passed if nothing is `wanted`.
+		 */
+		Uint32 WaitTimeout(bool wanted, Uint32 idle_ms);
+
+		void BeginFrame();
+		void EndFrame();
+
+		// * Over the last `history_size` frames.
+		Stats GetStats() const;
+	};
+} // namespace casioemu
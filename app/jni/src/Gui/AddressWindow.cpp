@@ -1,6 +1,7 @@
 ﻿#include "AddressWindow.h"
 #include <Hooks.h>
 #include <Localization.h>
+#include <algorithm>
 struct AddressInfo {
 	uint32_t address;
 	uint8_t value;
@@ -22,10 +23,17 @@ public:
 		ImGui::Separator();
 
 		RenderAddAddressControls();
+
+		// * Locked addresses are enforced from the memory hooks.
+		bool locked = std::any_of(addresses.begin(), addresses.end(), [](const AddressInfo& info) { return info.locked; });
+		SetHookInterest(m_emu->hooks.on_memory_read_listeners, reads_hooked, locked);
+		SetHookInterest(m_emu->hooks.on_memory_write_listeners, writes_hooked, locked);
 	}
 
 private:
 	std::vector<AddressInfo> addresses;
+	bool reads_hooked = false;
+	bool writes_hooked = false;
 	uint32_t newAddress = 0;
 
 	void RenderAddressTable() {
@@ -46,7 +54,7 @@ private:
 				ImGui::TableSetColumnIndex(1);
 				uint8_t value = info.value;
 				if (!info.locked)
-					value = m_emu->chipset.mmu.ReadData(info.address);
+					value = m_emu->chipset.mmu.ReadData(info.address, false);
 				if (ImGui::InputScalar("##value", ImGuiDataType_U8, &value, 0, 0, "%x")) {
 					info.value = value;
 					UpdateMemoryValue(info.address, info.value);
@@ -83,14 +91,14 @@ private:
 	}
 
 	void SetupHooks() {
-		SetupHook(on_memory_write, [this](casioemu::MMU& mmu, MemoryEventArgs& args) {
+		SetupHook(m_emu->hooks.on_memory_write, [this](casioemu::MMU& mmu, MemoryEventArgs& args) {
 			for (const auto& info : addresses) {
 				if (info.locked && info.address == args.offset) {
 					args.handled = true;
 				}
 			}
 		});
-		SetupHook(on_memory_read, [this](casioemu::MMU& mmu, MemoryEventArgs& args) {
+		SetupHook(m_emu->hooks.on_memory_read, [this](casioemu::MMU& mmu, MemoryEventArgs& args) {
 			for (const auto& info : addresses) {
 				if (info.locked && info.address == args.offset) {
 					args.value = info.value;
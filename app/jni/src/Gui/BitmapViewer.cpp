@@ -62,7 +62,7 @@ public:
 			ImVec2 pixelBottomRight = ImVec2(pixelTopLeft.x + size, pixelTopLeft.y + size);
 
 			if (byteIndex != currentByteIndex) {
-				currentByte = me_mmu->ReadData((addr + byteIndex) & 0xfffff);
+				currentByte = me_mmu->ReadData((addr + byteIndex) & 0xfffff, false);
 				currentByteIndex = byteIndex;
 			}
 			bool isSet = ((currentByte >> bitIndex) & 1) != 0;
@@ -7,6 +7,7 @@
 
 struct CallAnalysis : public UIWindow {
 	bool is_call_recoding = false;
+	bool calls_hooked = false;
 	bool check_caller = false;
 	char caller[260]{};
 	uint32_t caller_v{};
@@ -23,7 +24,7 @@ struct CallAnalysis : public UIWindow {
 	std::map<uint32_t, std::vector<FunctionCall>> funcs;
 	std::vector<FunctionCall> viewing_calls;
 	CallAnalysis() : UIWindow("Funcs") {
-		SetupHook(on_call_function, [this](casioemu::CPU& sender, const FunctionEventArgs& ea) {
+		SetupHook(m_emu->hooks.on_call_function, [this](casioemu::CPU& sender, const FunctionEventArgs& ea) {
 			OnCallFunction(sender, ea.pc, ea.lr);
 		});
 	}
@@ -67,6 +68,7 @@ struct CallAnalysis : public UIWindow {
 		}
 	}
 	void RenderCore() override {
+		SetHookInterest(m_emu->hooks.on_call_function_listeners, calls_hooked, is_call_recoding);
 		if (is_call_recoding) {
 			if (ImGui::Button("CallAnalysis.Stop"_lc)) {
 				is_call_recoding = false;
@@ -148,6 +150,7 @@ struct CallAnalysis : public UIWindow {
 			}
 			if (ImGui::Button("CallAnalysis.StartRec"_lc)) {
 				is_call_recoding = true;
+				SetHookInterest(m_emu->hooks.on_call_function_listeners, calls_hooked, true);
 				funcs.clear();
 			}
 			ImGui::SameLine();
@@ -29,7 +29,7 @@ void CasioData::RenderCore() {
 		return;
 	}
 	auto ram = casioemu::GetRamBaseAddr(hwid);
-	auto mode = me_mmu->ReadData(casioemu::GetModeOffset(hwid));
+	auto mode = me_mmu->ReadData(casioemu::GetModeOffset(hwid), false);
 	if (mode == 0xd) {
 		static char formula[200]{}; // TODO: instance data
 		static int row{}, col{};
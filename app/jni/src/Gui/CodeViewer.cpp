@@ -5,6 +5,7 @@
 #include "Emulator.hpp"
 #include "Hooks.h"
 #include "Logger.hpp"
+#include "Rewind.hpp"
 #include "U8Disas.h"
 #include "imgui/imgui.h"
 #include <algorithm>
@@ -40,7 +41,7 @@ CodeElem CodeViewer::LookUp(uint32_t offset, int* idx) {
 CodeViewer* cv_a;
 
 void CodeViewer::SetupHooks() {
-	SetupHook(on_instruction,
+	SetupHook(m_emu->hooks.on_instruction,
 		[&](casioemu::CPU& cup, InstructionEventArgs& iea) {
 			pc_cache = iea.pc_after;
 			if (stepping) {
@@ -222,7 +223,20 @@ bool CodeViewer::TryTrigBP(uint8_t seg, uint16_t offset, bool bp_mode) {
 	return false;
 }
 
+/**
+ * Only listen to every instruction while something can actually break on
+ * one: a pending step/trace or an armed breakpoint.
+ */
+void CodeViewer::UpdateHookInterest() {
+	bool interested = stepping || tracing || trace_bp || (debug_flags & (DEBUG_STEP | DEBUG_RET_TRACE));
+	for (auto& bp : break_points)
+		interested |= bp.second == 1;
+	SetHookInterest(m_emu->hooks.on_instruction_listeners, instruction_hooked, interested);
+}
+
 void CodeViewer::ExternalBP() {
+	if (!instruction_hooked)
+		pc_cache = m_emu->chipset.cpu.reg_csr << 16 | m_emu->chipset.cpu.reg_pc;
 	JumpTo(pc_cache);
 	return;
 }
@@ -300,6 +314,9 @@ void CodeViewer::JumpTo(uint32_t offset) {
 }
 
 void CodeViewer::RenderCore() {
+	UpdateHookInterest();
+	if (!instruction_hooked)
+		pc_cache = m_emu->chipset.cpu.reg_csr << 16 | m_emu->chipset.cpu.reg_pc;
 
 	int h = ImGui::GetTextLineHeight() + 4;
 	int w = ImGui::CalcTextSize("F").x;
@@ -348,13 +365,24 @@ void CodeViewer::RenderCore() {
 	}
 	ImGui::SameLine();
 	if (m_emu->GetPaused()) {
+		if (ImGui::Button("CodeViewer.StepBack"_lc)) {
+			m_emu->RunOnTickThread([this] {
+				if (!m_emu->rewind.StepBack(1))
+					return;
+				pc_cache = m_emu->chipset.cpu.reg_csr << 16 | m_emu->chipset.cpu.reg_pc;
+				JumpTo(pc_cache);
+			});
+		}
+		ImGui::SameLine();
 		if (ImGui::Button("CodeViewer.Step"_lc)) {
 			stepping = true;
+			UpdateHookInterest();
 			m_emu->SetPaused(false);
 		}
 		ImGui::SameLine();
 		if (ImGui::Button("CodeViewer.Trace"_lc)) {
 			tracing = true;
+			UpdateHookInterest();
 			m_emu->SetPaused(false);
 		}
 		ImGui::SameLine();
@@ -368,12 +396,14 @@ void CodeViewer::RenderCore() {
 					else {
 						trace_bp = m_emu->chipset.cpu.reg_lcsr << 16 | m_emu->chipset.cpu.reg_lr;
 					}
+					UpdateHookInterest();
 					m_emu->SetPaused(false);
 				}
 			}
 		}
 		ImGui::SameLine();
 		if (ImGui::Button("CodeViewer.Continue"_lc)) {
+			UpdateHookInterest();
 			m_emu->SetPaused(false);
 		}
 		ImGui::SameLine();
@@ -32,6 +32,7 @@ private:
 	bool stepping = false;
 	bool tracing = false;
 	uint32_t trace_bp = 0;
+	bool instruction_hooked = false;
 
 	bool is_loaded = false;
 	bool need_roll = false;
@@ -47,6 +48,7 @@ public:
 	void PrepareDisasm();
 	bool TryTrigBP(uint8_t seg, uint16_t offset, bool bp_mode = true);
 	void ExternalBP();
+	void UpdateHookInterest();
 	CodeElem LookUp(uint32_t offset, int* idx = 0);
 	void RenderCore() override;
 	void DrawContent();
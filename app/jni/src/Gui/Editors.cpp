@@ -14,6 +14,8 @@ struct HexEditor : public UIWindow, public MemoryEditor {
 	size_t display_base{};
 	bool open_popup = false;
 	size_t popup_p = 0;
+	bool drawn = false;
+	bool writes_hooked = false;
 	HexEditor(const char* name, void* data, size_t size, size_t base) : UIWindow(name), data(data), size(size), display_base(base) {
 		flags = ImGuiWindowFlags_NoScrollbar;
 		this->ram_edit_ov = ::ram_edit_ov;
@@ -23,7 +25,14 @@ struct HexEditor : public UIWindow, public MemoryEditor {
 			((HexEditor*)userdata)->popup_p = where;
 		};
 	}
+	void Render() override {
+		drawn = false;
+		UIWindow::Render();
+		// * Recent writes are highlighted from the write hook, so only listen while the editor is shown.
+		SetHookInterest(m_emu->hooks.on_memory_write_listeners, writes_hooked, drawn);
+	}
 	void RenderCore() override {
+		drawn = true;
 		this->DrawContents(data, size, display_base);
 		if (open_popup) {
 			ImGui::OpenPopup("ContextMenu");
@@ -48,6 +57,8 @@ struct SpansHexEditor : public UIWindow, public MemoryEditor {
 	std::vector<MarkedSpan> spans{};
 	bool open_popup = false;
 	size_t popup_p = 0;
+	bool drawn = false;
+	bool writes_hooked = false;
 	SpansHexEditor(const char* name, void* data, size_t size, size_t base, std::vector<MarkedSpan> spans) : UIWindow(name), data(data), size(size), display_base(base), spans(spans) {
 		flags = ImGuiWindowFlags_NoScrollbar;
 		this->ram_edit_ov = ::ram_edit_ov;
@@ -58,7 +69,14 @@ struct SpansHexEditor : public UIWindow, public MemoryEditor {
 			// ImGui::OpenPopup("ContextMenu");
 		};
 	}
+	void Render() override {
+		drawn = false;
+		UIWindow::Render();
+		// * Recent writes are highlighted from the write hook, so only listen while the editor is shown.
+		SetHookInterest(m_emu->hooks.on_memory_write_listeners, writes_hooked, drawn);
+	}
 	void RenderCore() override {
+		drawn = true;
 		this->DrawContents(data, size, display_base, spans);
 		if (open_popup) {
 			ImGui::OpenPopup("ContextMenu");
@@ -86,6 +104,15 @@ inline auto MMU_Hex(auto he) {
 	};
 	return he;
 }
+inline auto Code_Hex(auto he) {
+	he->WriteFn = [](ImU8* data, size_t off, ImU8 d) {
+		m_emu->RunOnTickThread([data, off, d] {
+			data[off] = d;
+			m_emu->chipset.cpu.InvalidateDecodeCache();
+		});
+	};
+	return he;
+}
 inline auto Highlight_Default(auto he) {
 	he->HighlightFn = [](const ImU8* data, size_t off) -> bool {
 		if ((size_t)(data + off) == m_emu->chipset.cpu.reg_sp) {
@@ -100,7 +127,7 @@ inline auto Highlight_Default(auto he) {
 }
 
 std::vector<UIWindow*> GetEditors() {
-	SetupHook(on_memory_write, [](casioemu::MMU& mmu, MemoryEventArgs& mea) {
+	SetupHook(m_emu->hooks.on_memory_write, [](casioemu::MMU& mmu, MemoryEventArgs& mea) {
 		if (mea.offset < 0x80000)
 			ram_edit_ov[mea.offset] = 255;
 	});
@@ -114,10 +141,10 @@ std::vector<UIWindow*> GetEditors() {
 					0x10000 - casioemu::GetRamBaseAddr(m_emu->hardware_id),
 					casioemu::GetRamBaseAddr(m_emu->hardware_id),
 					GetCommonMemLabels(m_emu->hardware_id)})));
-	windows.push_back(new HexEditor{"Rom", m_emu->chipset.rom_data.data(), m_emu->chipset.rom_data.size(), 0});
+	windows.push_back(Code_Hex(new HexEditor{"Rom", m_emu->chipset.rom_data.data(), m_emu->chipset.rom_data.size(), 0}));
 	if (m_emu->hardware_id == casioemu::HW_FX_5800P) {
 		windows.push_back(MMU_Hex(new SpansHexEditor{"PRam", (void*)0x40000, 0x8000, 0x40000, GetCommonMemLabels(m_emu->hardware_id)}));
-		windows.push_back(new HexEditor{"Flash", m_emu->chipset.flash_data.data(), m_emu->chipset.flash_data.size(), 0});
+		windows.push_back(Code_Hex(new HexEditor{"Flash", m_emu->chipset.flash_data.data(), m_emu->chipset.flash_data.size(), 0}));
 	}
 	windows.push_back(MMU_Hex(new HexEditor{"All", 0, 0xfffff, 0}));
 	return windows;
@@ -1,5 +1,6 @@
 ﻿#pragma once
 #include "Chipset/Chipset.hpp"
+#include <atomic>
 #include <functional>
 
 // this is the new cpp style hook library
@@ -24,18 +25,56 @@ struct InstructionEventArgs {
 	bool should_break{};
 };
 
-extern std::function<void(casioemu::CPU&, InstructionEventArgs&)> on_instruction;
+/**
+ * The hooks of one emulator, see `Emulator::hooks`. Instances don't share
+ * any, so that several can run in one process.
+ */
+struct EmulatorHooks {
+	std::function<void(casioemu::CPU&, InstructionEventArgs&)> on_instruction;
 
-extern std::function<void(casioemu::CPU&, const FunctionEventArgs&)> on_call_function;
-extern std::function<void(casioemu::CPU&, const FunctionEventArgs&)> on_function_return;
+	std::function<void(casioemu::CPU&, const FunctionEventArgs&)> on_call_function;
+	std::function<void(casioemu::CPU&, const FunctionEventArgs&)> on_function_return;
 
-extern std::function<void(casioemu::MMU&, MemoryEventArgs&)> on_memory_read;
-extern std::function<void(casioemu::MMU&, MemoryEventArgs&)> on_memory_write;
+	std::function<void(casioemu::MMU&, MemoryEventArgs&)> on_memory_read;
+	std::function<void(casioemu::MMU&, MemoryEventArgs&)> on_memory_write;
+	// * After a read of a granule marked by MMU::SetWatch, with the value read.
+	std::function<void(casioemu::MMU&, MemoryEventArgs&)> on_watched_read;
 
-extern std::function<void(casioemu::Chipset&, InterruptEventArgs&)> on_brk;
-extern std::function<void(casioemu::Chipset&, InterruptEventArgs&)> on_interrupt;
+	std::function<void(casioemu::Chipset&, InterruptEventArgs&)> on_brk;
+	std::function<void(casioemu::Chipset&, InterruptEventArgs&)> on_interrupt;
 
-extern std::function<void(casioemu::Chipset&)> on_reset;
+	std::function<void(casioemu::Chipset&)> on_reset;
+
+	// * Hooks are installed once at startup, but most listeners only need their events some of the time.
+	// * The hooks raised per instruction, per call/return and per memory access are only raised while
+	// * some listener has registered interest through SetHookInterest; the rest of the time the
+	// * interpreter stays on its hook-free paths. The UI thread changes the counts while the tick
+	// * thread reads them.
+	std::atomic<int> on_instruction_listeners{};
+	std::atomic<int> on_call_function_listeners{};
+	std::atomic<int> on_function_return_listeners{};
+	std::atomic<int> on_memory_read_listeners{};
+	std::atomic<int> on_memory_write_listeners{};
+	// * Tick thread only. Silences the counted hooks without touching the counts, see `MutedHooks`.
+	bool muted{};
+
+	// * Whether to raise a counted hook. Only for the tick thread.
+	bool Wants(const std::atomic<int>& listeners) const {
+		return !muted && listeners.load(std::memory_order_relaxed);
+	}
+};
+
+/**
+ * Adds or removes one listener's interest in a hook. `held` keeps track of
+ * whether this listener is currently counted, so it may be called again with
+ * an unchanged `interested` (e.g. once per frame).
+ */
+inline void SetHookInterest(std::atomic<int>& listeners, bool& held, bool interested) {
+	if (held == interested)
+		return;
+	held = interested;
+	listeners += interested ? 1 : -1;
+}
 
 #define RaiseEvent(func, ...) \
 	if (func)                 \
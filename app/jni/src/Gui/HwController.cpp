@@ -2,13 +2,12 @@
 #include "../Config.hpp"
 #include "Ui.hpp"
 #include "imgui/imgui.h"
+#include "CPU.hpp"
 #include "Chipset.hpp"
+#include "FramePacer.hpp"
 #include "Localization.h"
-int screen_flashing_threshold = 20;
-float screen_fading_blending_coefficient = 0;
-bool enable_screen_fading = false;
-float screen_flashing_brightness_coeff = 1.5f;
-int screen_buffer_select = 0;
+#include "SaveState.hpp"
+#include <algorithm>
 bool audio_enable = false;
 void HwController::RenderCore() {
 
@@ -48,6 +47,11 @@ void HwController::RenderCore() {
 		m_emu->cycles.Setup((Uint64)1 << cps, m_emu->cycles.timer_interval);
 	}
 	ImGui::Text("%.6f MHz", (double)m_emu->cycles.cycles_per_second / 1024 / 1024);
+	auto frame_stats = m_emu->frame_pacer.GetStats();
+	ImGui::Text("%s: %.2f ms (%.1f fps), max %.2f ms, render %.2f ms", "HwController.FrameTime"_lc,
+		frame_stats.average_ms, frame_stats.fps, frame_stats.worst_ms, frame_stats.render_ms);
+	ImGui::Text("%s: %llu (%llu), %llu frames", "HwController.FrameRequests"_lc,
+		(unsigned long long)frame_stats.requests, (unsigned long long)frame_stats.coalesced, (unsigned long long)frame_stats.presented);
 	static int pd = m_emu->ModelDefinition.pd_value;
 	static bool pdx[8];
 
@@ -92,7 +96,25 @@ void HwController::RenderCore() {
 		std::ifstream rom_handle(m_emu->GetModelFilePath(m_emu->ModelDefinition.rom_path), std::ifstream::binary);
 		if (rom_handle.fail())
 			PANIC("std::ifstream failed: %s\n", std::strerror(errno));
-		m_emu->chipset.rom_data = std::vector<unsigned char>((std::istreambuf_iterator<char>(rom_handle)), std::istreambuf_iterator<char>());
+		std::vector<unsigned char> rom_data((std::istreambuf_iterator<char>(rom_handle)), std::istreambuf_iterator<char>());
+		// The tick thread fetches through the code pages, swap them out between two ticks.
+		m_emu->RunOnTickThread([rom_data = std::move(rom_data)] {
+			// The ROM window's MMU pages point into the buffer, so it is overwritten in place.
+			// Like `ROMWindow::Initialise`, a shorter image is padded with zeros and a longer one cut off.
+			auto& rom = m_emu->chipset.rom_data;
+			size_t size = std::min(rom.size(), rom_data.size());
+			std::copy(rom_data.begin(), rom_data.begin() + size, rom.begin());
+			std::fill(rom.begin() + size, rom.end(), 0);
+			m_emu->chipset.mmu.UpdateCodePages();
+			m_emu->chipset.cpu.InvalidateDecodeCache();
+		});
+	}
+	if (ImGui::Button("HwController.SaveState"_lc)) {
+		m_emu->save_states.SaveFile(m_emu->GetModelFilePath("state.bin"));
+	}
+	ImGui::SameLine();
+	if (ImGui::Button("HwController.LoadState"_lc)) {
+		m_emu->save_states.LoadFile(m_emu->GetModelFilePath("state.bin"));
 	}
 	//	static char buf4[40];
 	//	ImGui::InputText("##cps_in", buf4, 40);
@@ -547,6 +547,7 @@ void Injector::RenderCore() {
                 }
                 *(base_addr + inputbase + off) = 0xfd;
                 *(base_addr + inputbase + off + 1) = 0x20;
+                me_mmu->MarkHostWrite();
                 info_msg = "Rop.AnInputed"_l;
                 show_info = true;
             }
@@ -593,6 +594,7 @@ void Injector::RenderCore() {
             
             if (ImGui::Button("Rop.LoadToInputArea"_lc)) {
                 memcpy(base_addr + inputbase, data_buf, range);
+                me_mmu->MarkHostWrite();
                 info_msg = "Rop.LoadedTip"_l;
                 show_info = true;
             }
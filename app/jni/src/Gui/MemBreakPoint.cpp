@@ -5,6 +5,7 @@
 #include "Gui/Hooks.h"
 #include "Ui.hpp"
 #include "imgui/imgui.h"
+#include <algorithm>
 #include <cstdint>
 #include <cstdlib>
 #include <stdlib.h>
@@ -16,12 +17,15 @@ void MemBreakPoint::DrawContent() {
 	ImGuiListClipper c;
 	static int selected = -1;
 	c.Begin(break_point_hash.size());
-	char buf[5] = {0};
+	char buf[40] = {0};
 	while (c.Step()) {
 
 		for (int i = c.DisplayStart; i < c.DisplayEnd; i++) {
 			MemBPData_t& data = break_point_hash[i];
-            sprintf(buf, "%lx", (unsigned long)data.addr);
+			int len = data.length > 1 ? snprintf(buf, sizeof(buf), "%06x+%x", (unsigned int)data.addr, (unsigned int)data.length) : snprintf(buf, sizeof(buf), "%06x", (unsigned int)data.addr);
+			len += snprintf(buf + len, sizeof(buf) - len, " %s%s", data.kinds & casioemu::MMU::WATCH_READ ? "R" : "", data.kinds & casioemu::MMU::WATCH_WRITE ? "W" : "");
+			if (data.match_value)
+				snprintf(buf + len, sizeof(buf) - len, " =%02x", data.value);
 			ImGui::PushID(i);
 			if (ImGui::Selectable(buf, selected == i)) {
 				selected = i;
@@ -31,25 +35,30 @@ void MemBreakPoint::DrawContent() {
 				selected = i;
 
                 ImGui::TextUnformatted("MemBP.BPType"_lc);
-				if (ImGui::Button("HexEditors.ContextMenu.MonitorRead"_lc)) {
+				int kinds = 0;
+				if (ImGui::Button("HexEditors.ContextMenu.MonitorRead"_lc))
+					kinds = casioemu::MMU::WATCH_READ;
+				if (ImGui::Button("HexEditors.ContextMenu.MonitorWrite"_lc))
+					kinds = casioemu::MMU::WATCH_WRITE;
+				if (ImGui::Button("MemBP.MonitorBoth"_lc))
+					kinds = casioemu::MMU::WATCH_READ | casioemu::MMU::WATCH_WRITE;
+				if (kinds) {
+					data.kinds = kinds;
 					target_addr = i;
-					data.enableWrite = 0;
-					data.records.clear();
-					ImGui::CloseCurrentPopup();
-				}
-				if (ImGui::Button("HexEditors.ContextMenu.MonitorWrite"_lc)) {
-					data.enableWrite = true;
-					target_addr = i;
-					data.records.clear();
+					data.records = std::make_shared<RecordSet>();
+					watches_dirty = true;
 					ImGui::CloseCurrentPopup();
 				}
 				ImGui::Separator();
 				if (ImGui::Button("MemBP.Delete"_lc)) {
-					data.records.clear();
 					if (target_addr == i) {
 						target_addr = -1;
 					}
+					else if (target_addr > i) {
+						target_addr--;
+					}
 					break_point_hash.erase(break_point_hash.begin() + i);
+					watches_dirty = true;
 					ImGui::CloseCurrentPopup();
 				}
 				ImGui::EndPopup();
@@ -63,14 +72,20 @@ void MemBreakPoint::DrawFindContent() {
 		ImGui::TextColored(ImVec4(255, 255, 0, 255), "%s", "MemBP.NoBPHint"_lc);
 		return;
 	}
-	int write = break_point_hash[target_addr].enableWrite;
 	static ImGuiTableFlags flags = ImGuiTableFlags_ScrollY | ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersOuter | ImGuiTableFlags_BordersV | ImGuiTableFlags_Resizable | ImGuiTableFlags_Reorderable | ImGuiTableFlags_Hideable;
 	ImGui::Text("MemBP.MonitoringHint"_lc,
 		break_point_hash[target_addr].addr);
 	ImGui::SameLine();
-	static const char* fx = "";
+	static std::string fx;
+	auto& record_set = *break_point_hash[target_addr].records;
 	if (ImGui::Button("MemBP.ClearRec"_lc)) {
-		break_point_hash[target_addr].records.clear();
+		std::lock_guard<std::mutex> lock(record_set.mx);
+		record_set.records.clear();
+	}
+	std::unordered_map<uint32_t, Record> records;
+	{
+		std::lock_guard<std::mutex> lock(record_set.mx);
+		records = record_set.records;
 	}
 	if (ImGui::BeginTable("##outputtable", 2, flags)) {
 		ImGui::TableSetupScrollFreeze(0, 1);
@@ -84,7 +99,7 @@ void MemBreakPoint::DrawFindContent() {
 		);
 		ImGui::TableHeadersRow();
 		int i = 0;
-		for (auto kv : break_point_hash[target_addr].records) {
+		for (auto& kv : records) {
 			ImGui::TableNextRow();
 			ImGui::TableSetColumnIndex(0);
 			ImGui::TextColored(ImVec4(0, 200, 0, 200), "%01x:%04x", kv.first >> 16, kv.first & 0x0ffff);
@@ -97,8 +112,8 @@ void MemBreakPoint::DrawFindContent() {
 					"View callstack"
 #endif
 					)) {
-				fx = kv.second.stacktrace.c_str();
-				SDL_ShowSimpleMessageBox(0, "", fx, 0);
+				fx = kv.second.stacktrace;
+				SDL_ShowSimpleMessageBox(0, "", fx.c_str(), 0);
 			}
 			ImGui::PopID();
 		}
@@ -107,49 +122,72 @@ void MemBreakPoint::DrawFindContent() {
 }
 
 void MemBreakPoint::SetupHooks() {
-	SetupHook(on_memory_read, [&](casioemu::MMU& sender, MemoryEventArgs& mea) {
-		if (break_on_cv) {
-			if (target_addr == -1) {
-				return;
-			}
-			MemBPData_t& bp = break_point_hash.at(target_addr);
-			if (bp.addr == mea.offset && !bp.enableWrite) {
-				SetDebugbreak();
-			}
-		}
-		else {
-			TryTrigBp(mea.offset, 0);
-		}
+	// * The MMU only raises these for every access while some other listener wants them;
+	// * otherwise only for the granules marked by UpdateWatches.
+	SetupHook(m_emu->hooks.on_watched_read, [&](casioemu::MMU& sender, MemoryEventArgs& mea) {
+		if (TryTrigBp(mea, casioemu::MMU::WATCH_READ) && break_on_cv)
+			SetDebugbreak();
 	});
-	SetupHook(on_memory_write, [&](casioemu::MMU& sender, MemoryEventArgs& mea) {
-		if (break_on_cv) {
-			if (target_addr == -1) {
-				return;
-			}
-			MemBPData_t& bp = break_point_hash.at(target_addr);
-			if (bp.addr == mea.offset && bp.enableWrite) {
-				SetDebugbreak();
-			}
-		}
-		else {
-			TryTrigBp(mea.offset, 1);
-		}
+	SetupHook(m_emu->hooks.on_memory_write, [&](casioemu::MMU& sender, MemoryEventArgs& mea) {
+		if (sender.Watched(mea.offset, casioemu::MMU::WATCH_WRITE) && TryTrigBp(mea, casioemu::MMU::WATCH_WRITE) && break_on_cv)
+			SetDebugbreak();
 	});
 	membp_cv = this;
 }
 
-void MemBreakPoint::TryTrigBp(uint32_t addr, bool write) {
-	if (target_addr == -1) {
-		return;
+/**
+ * Checks an access to a watched granule against the breakpoints overlapping
+ * it. Hits are recorded unless the emulator is going to break on them anyway.
+ * Runs on the tick thread.
+ */
+bool MemBreakPoint::TryTrigBp(MemoryEventArgs& mea, casioemu::MMU::WatchKind kind) {
+	if (!index)
+		return false;
+	auto granule = index->granules.find((mea.offset & 0xFFFFFF) >> casioemu::MMU::watch_granule_shift);
+	if (granule == index->granules.end())
+		return false;
+	bool hit = false;
+	for (auto& bp : granule->second) {
+		if (!(bp.kinds & kind) || mea.offset - bp.addr >= bp.length)
+			continue;
+		if (bp.match_value && mea.value != bp.value)
+			continue;
+		hit = true;
+		if (!break_on_cv) {
+			auto& cpu = m_emu->chipset.cpu;
+			std::lock_guard<std::mutex> lock(bp.records->mx);
+			bp.records->records[(cpu.reg_csr << 16) | cpu.reg_pc] = Record{cpu.GetBacktrace(), (unsigned int)(cpu.reg_lcsr << 16) | cpu.reg_lr};
+		}
 	}
-	MemBPData_t& bp = break_point_hash.at(target_addr);
-	if (bp.addr == addr && bp.enableWrite == write) {
-		bp.records[(m_emu->chipset.cpu.reg_csr << 16) | m_emu->chipset.cpu.reg_pc] = Record{m_emu->chipset.cpu.GetBacktrace(), (unsigned int)(m_emu->chipset.cpu.reg_lcsr << 16) | m_emu->chipset.cpu.reg_lr};
+	return hit;
+}
+
+void MemBreakPoint::UpdateWatches() {
+	if (!watches_dirty)
+		return;
+	watches_dirty = false;
+	auto new_index = std::make_shared<MemBPIndex>();
+	for (auto& bp : break_point_hash) {
+		uint32_t first = (bp.addr & 0xFFFFFF) >> casioemu::MMU::watch_granule_shift;
+		uint32_t last = std::min<uint32_t>(bp.addr + bp.length - 1, 0xFFFFFF) >> casioemu::MMU::watch_granule_shift;
+		for (uint32_t granule = first; granule <= last; ++granule)
+			new_index->granules[granule].push_back(bp);
 	}
+	// * The tick thread reads the watch bits and the index on every access, so both change between two ticks.
+	m_emu->RunOnTickThread([this, new_index, watches = break_point_hash] {
+		auto& mmu = m_emu->chipset.mmu;
+		mmu.ClearWatches();
+		for (auto& bp : watches)
+			mmu.SetWatch(bp.addr, bp.length, bp.kinds);
+		index = new_index;
+	});
 }
 
 void MemBreakPoint::RenderCore() {
 	static char buf[10] = {0};
+	static char len_buf[10] = {0};
+	static char value_buf[4] = {0};
+	static bool match_value = false;
 	ImGui::BeginChild("##srcollingmbp", ImVec2(0, break_on_cv ? ImGui::GetWindowHeight() - ImGui::GetTextLineHeightWithSpacing() * 6 : ImGui::GetWindowHeight() / 3));
 	DrawContent();
 	ImGui::EndChild();
@@ -158,8 +196,27 @@ void MemBreakPoint::RenderCore() {
 		"##addressin",
 		buf, 10, ImGuiInputTextFlags_CharsHexadecimal);
 	ImGui::SameLine();
+	ImGui::TextUnformatted("MemBP.Length"_lc);
+	ImGui::SameLine();
+	ImGui::SetNextItemWidth(ImGui::CalcTextSize("F").x * 6);
+	ImGui::InputText(
+		"##lengthin",
+		len_buf, 10, ImGuiInputTextFlags_CharsHexadecimal);
+	ImGui::SameLine();
+	ImGui::Checkbox("MemBP.IfValue"_lc, &match_value);
+	ImGui::SameLine();
+	ImGui::SetNextItemWidth(ImGui::CalcTextSize("F").x * 3);
+	ImGui::InputText(
+		"##valuein",
+		value_buf, 3, ImGuiInputTextFlags_CharsHexadecimal);
+	ImGui::SameLine();
 	if (ImGui::Button("MemBP.AddAddr"_lc)) {
-		break_point_hash.push_back({.addr = (uint32_t)strtol(buf, nullptr, 16)});
+		uint32_t length = (uint32_t)strtol(len_buf, nullptr, 16);
+		break_point_hash.push_back({.addr = (uint32_t)strtol(buf, nullptr, 16),
+			.length = length ? length : 1,
+			.match_value = match_value,
+			.value = (uint8_t)strtol(value_buf, nullptr, 16)});
+		watches_dirty = true;
 	}
 	ImGui::Checkbox("MemBP.BreakWhenHit"_lc,
 		&break_on_cv);
@@ -168,11 +225,14 @@ void MemBreakPoint::RenderCore() {
 		DrawFindContent();
 		ImGui::EndChild();
 	}
+	UpdateWatches();
 }
 
 void MemBreakPoint::ExternalAddBp(uint32_t addr, bool write) {
-	break_point_hash.push_back({.enableWrite = write, .addr = addr});
+	break_point_hash.push_back({.kinds = write ? casioemu::MMU::WATCH_WRITE : casioemu::MMU::WATCH_READ, .addr = addr});
 	target_addr = break_point_hash.size() - 1;
+	watches_dirty = true;
+	UpdateWatches();
 }
 
 void SetMemBp(uint32_t addr, bool write) {
@@ -1,6 +1,9 @@
 ﻿#pragma once
+#include "Chipset/MMU.hpp"
 #include "Ui.hpp"
 #include <cstdint>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -10,23 +13,47 @@ struct Record {
 	uint32_t lr;
 };
 
+// * Filled in on the tick thread, shown on the UI thread.
+struct RecordSet {
+	std::mutex mx;
+	std::unordered_map<uint32_t, Record> records;
+};
+
 struct MemBPData_t {
-	bool enableWrite = false;
+	int kinds = casioemu::MMU::WATCH_READ;
 	uint32_t addr;
-	std::unordered_map<uint32_t, Record> records;
+	uint32_t length = 1;
+	bool match_value = false;
+	uint8_t value = 0;
+	std::shared_ptr<RecordSet> records = std::make_shared<RecordSet>();
 };
 
+/**
+ * The breakpoints overlapping each watched granule, keyed by granule. Built
+ * on the UI thread and never changed afterwards, the tick thread only swaps
+ * in a new one.
+ */
+struct MemBPIndex {
+	std::unordered_map<uint32_t, std::vector<MemBPData_t>> granules;
+};
+
+struct MemoryEventArgs;
+
 void SetMemBp(uint32_t addr, bool write);
 
 class MemBreakPoint : public UIWindow {
 
 private:
 	std::vector<MemBPData_t> break_point_hash;
+	// * Only used on the tick thread.
+	std::shared_ptr<const MemBPIndex> index;
 
 	int target_addr = -1;
 
 	bool break_on_cv = false;
 
+	bool watches_dirty = false;
+
 	void DrawFindContent();
 
 	void DrawContent();
@@ -38,7 +65,9 @@ public:
 
 	void SetupHooks();
 
-	void TryTrigBp(uint32_t addr_edit, bool write);
+	bool TryTrigBp(MemoryEventArgs& mea, casioemu::MMU::WatchKind kind);
+
+	void UpdateWatches();
 
 	void RenderCore() override;
 
@@ -63,14 +63,16 @@ void WatchWindow::ShowRX() {
 	ImGui::SameLine();
 	show_sfr(reg_dsr, "DSR: ", 6, 2);
 }
-void WatchWindow::ModRX() {
+uint32_t WatchWindow::ModRX() {
 	char id[10];
+	uint32_t edited = 0;
 	ImGui::TextColored(ImVec4(0, 200, 0, 255), "RXn: ");
 	for (int i = 0; i < 16; i++) {
 		ImGui::SameLine();
 		sprintf(id, "##data%d", i);
 		ImGui::SetNextItemWidth(char_width * 3);
-		ImGui::InputText(id, (char*)&reg_rx[i][0], 3, ImGuiInputTextFlags_CharsHexadecimal);
+		if (ImGui::InputText(id, (char*)&reg_rx[i][0], 3, ImGuiInputTextFlags_CharsHexadecimal))
+			edited |= 1u << i;
 	}
 	// ERn
 	// 不可编辑，必须通过Rn编辑
@@ -88,7 +90,8 @@ void WatchWindow::ModRX() {
 		ImGui::SameLine();
 		sprintf(id, "##sfr%d", i);
 		ImGui::SetNextItemWidth(char_width * width + 2);
-		ImGui::InputText(id, (char*)ptr, width + 1, ImGuiInputTextFlags_CharsHexadecimal);
+		if (ImGui::InputText(id, (char*)ptr, width + 1, ImGuiInputTextFlags_CharsHexadecimal))
+			edited |= 1u << (15 + i);
 	});
 	show_sfr(reg_pc, "PC: ", 1, 6);
 	ImGui::SameLine();
@@ -101,21 +104,31 @@ void WatchWindow::ModRX() {
 	show_sfr(reg_psw, "PSW: ", 5, 2);
 	ImGui::SameLine();
 	show_sfr(reg_dsr, "DSR: ", 6, 2);
+	return edited;
 }
 
-void WatchWindow::UpdateRX() {
+void WatchWindow::UpdateRX(uint32_t edited) {
+	// Only what was typed into goes back, the rest may have changed under the window.
 	for (int i = 0; i < 16; i++) {
-		m_emu->chipset.cpu.reg_r[i] = (uint8_t)strtol((char*)reg_rx[i], nullptr, 16);
+		if (edited & (1u << i))
+			m_emu->chipset.cpu.reg_r[i] = (uint8_t)strtol((char*)reg_rx[i], nullptr, 16);
 	}
-	auto pc = strtol((char*)reg_pc, nullptr, 16);
-	m_emu->chipset.cpu.reg_pc = (uint16_t)pc;
-	m_emu->chipset.cpu.reg_csr = pc >> 16;
-	 pc = strtol((char*)reg_lr, nullptr, 16);
-	m_emu->chipset.cpu.reg_lr = (uint16_t)pc;
-	m_emu->chipset.cpu.reg_lcsr = pc >> 16;
-	m_emu->chipset.cpu.reg_ea = (uint16_t)strtol((char*)reg_ea, nullptr, 16);
-	m_emu->chipset.cpu.reg_sp = (uint16_t)strtol((char*)reg_sp, nullptr, 16);
-	m_emu->chipset.cpu.reg_psw = (uint16_t)strtol((char*)reg_psw, nullptr, 16);
+	if (edited & EDITED_PC) {
+		auto pc = strtol((char*)reg_pc, nullptr, 16);
+		m_emu->chipset.cpu.reg_pc = (uint16_t)pc;
+		m_emu->chipset.cpu.reg_csr = pc >> 16;
+	}
+	if (edited & EDITED_LR) {
+		auto lr = strtol((char*)reg_lr, nullptr, 16);
+		m_emu->chipset.cpu.reg_lr = (uint16_t)lr;
+		m_emu->chipset.cpu.reg_lcsr = lr >> 16;
+	}
+	if (edited & EDITED_EA)
+		m_emu->chipset.cpu.reg_ea = (uint16_t)strtol((char*)reg_ea, nullptr, 16);
+	if (edited & EDITED_SP)
+		m_emu->chipset.cpu.reg_sp = (uint16_t)strtol((char*)reg_sp, nullptr, 16);
+	if (edited & EDITED_PSW)
+		m_emu->chipset.cpu.reg_psw = (uint16_t)strtol((char*)reg_psw, nullptr, 16);
 }
 inline static std::string lookup_symbol(uint32_t addr) {
 	auto iter = std::lower_bound(g_labels.begin(), g_labels.end(), addr,
@@ -180,8 +193,7 @@ void WatchWindow::RenderCore() {
 		}
 	}
 	else {
-		ModRX();
-		UpdateRX();
+		UpdateRX(ModRX());
 		if (ImGui::Button("WatchWindow.Continue"_lc)) {
 			m_emu->SetPaused(0);
 		}
@@ -243,7 +255,7 @@ void WatchWindow::RenderCore() {
 	ImGui::SliderInt("##range", &range, 64, 2048);
 	uint16_t offset = chipset.cpu.reg_sp & 0xffff;
 	mem_editor.ReadFn = [](const ImU8* data, size_t off) -> ImU8 {
-		return me_mmu->ReadData((size_t)data + off);
+		return me_mmu->ReadData((size_t)data + off, false);
 	};
 	mem_editor.WriteFn = [](ImU8* data, size_t off, ImU8 d) {
 		return me_mmu->WriteData((size_t)data + off, d);
@@ -19,8 +19,17 @@ public:
 
 	void ShowRX();
 
+	// Bits 0-15 are R0-R15, the rest follow the order `ModRX` shows them in.
+	enum : uint32_t {
+		EDITED_PC = 1u << 16,
+		EDITED_LR = 1u << 17,
+		EDITED_EA = 1u << 18,
+		EDITED_SP = 1u << 19,
+		EDITED_PSW = 1u << 20,
+	};
+
 	void PrepareRX();
-	void ModRX();
+	uint32_t ModRX();
 
-	void UpdateRX();
+	void UpdateRX(uint32_t edited);
 };
\ No newline at end of file
@@ -25,10 +25,12 @@
 // for each static/DLL boundary you are calling from. Read "Context and Memory Allocators" section of imgui.cpp for more details.
 //#define IMGUI_API __declspec( dllexport )
 //#define IMGUI_API __declspec( dllimport )
-#ifdef __ANDROID__
+#if defined(__ANDROID__)
 #define IMGUI_API
-#else
+#elif defined(_WIN32)
 #define IMGUI_API __declspec( dllexport )
+#else
+#define IMGUI_API __attribute__((visibility("default")))
 #endif
 
 //---- Don't define obsolete functions/enums/behaviors. Consider enabling from time to time after updating to clean your code of obsolete function/names.
@@ -1,5 +1,7 @@
 ﻿#pragma once
+#ifndef CASIOEMU_HEADLESS
 #include "Gui/hex.hpp"
+#endif
 #include "ModelInfo.h"
 #include <vector>
 
@@ -16,6 +18,7 @@ namespace casioemu {
 		return (hid == HW_FX_5800P || hid == HW_ES_PLUS) ? 0x0E00 : hid == HW_CLASSWIZ ? 0x2000
 																					   : 0x6000;
 	}
+#ifndef CASIOEMU_HEADLESS
 	inline std::vector<MemoryEditor::MarkedSpan> GetCommonMemLabels(HardwareId hid) {
 		int i = 0;
 #define SColor \
@@ -541,6 +544,7 @@ namespace casioemu {
 		}
 #undef SColor
 	}
+#endif
 	inline constexpr size_t GetInputAreaOffset(HardwareId hid) {
 		if (hid == HW_TI)
 			return 0xC33C;
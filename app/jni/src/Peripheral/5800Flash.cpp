@@ -1,7 +1,9 @@
 ﻿#include "5800Flash.h"
+#include "Chipset/CPU.hpp"
 #include "Chipset/MMU.hpp"
 #include "Chipset/Chipset.hpp"
 #include "Emulator.hpp"
+#include "SaveState.hpp"
 #include <fstream>
 #include <cstring>
 
@@ -62,6 +64,8 @@ namespace casioemu {
 						break;
 					case 3:
 						flash->emulator.chipset.flash_data[fo] = data;
+						flash->emulator.chipset.cpu.InvalidateDecodeCache();
+						flash->emulator.chipset.mmu.MarkHostWrite();
 						flash->flash_mode = 0;
 						return;
 					case 4:
@@ -81,6 +85,8 @@ namespace casioemu {
 							memset(&flash->emulator.chipset.flash_data[fo], 0xff, 0x7fff);
 						if (fo == 0x20000 || fo == 0x30000)
 							memset(&flash->emulator.chipset.flash_data[fo], 0xff, 0xffff);
+						flash->emulator.chipset.cpu.InvalidateDecodeCache();
+						flash->emulator.chipset.mmu.MarkHostWrite();
 						return;
 					case 7:
 						if (fo == 0xaaa && data == 0xaa) {
@@ -104,6 +110,10 @@ namespace casioemu {
 			SaveFlashData();
 		}
 
+		void Serialize(StateStream& state) override {
+			state(flash_mode);
+		}
+
 		void SaveFlashData() {
 			std::ofstream out_file(emulator.GetModelFilePath(FLASH_SAVE_PATH), std::ios::binary);
 			if (out_file) {
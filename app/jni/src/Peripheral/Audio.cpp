@@ -2,6 +2,7 @@
 #include "Chipset/Chipset.hpp"
 #include "Chipset/MMU.hpp"
 #include "Emulator.hpp"
+#include "SaveState.hpp"
 namespace casioemu {
 	class AudioDriver : public Peripheral {
 		uint8_t control{}, tempo{};
@@ -35,8 +36,11 @@ namespace casioemu {
 				}
 				else if (tempo == 2) {
 					if (count > 441000 / 32) {
-						control = 0;
-						tempo = 0;
+						// In deterministic mode the tone is ended on emulated time instead, see Tick.
+						if (!emulator.deterministic) {
+							control = 0;
+							tempo = 0;
+						}
 						memset(stream, 0, len << 1);
 						return;
 					}
@@ -88,20 +92,34 @@ namespace casioemu {
 		}
 	public:
 		AudioDriver(Emulator& emu) : Peripheral(emu) {
-			SDL_Init(SDL_INIT_AUDIO);
+			// Batch runs have no sound, `audio_device` stays 0 there.
+			if (!emulator.headless) {
+				SDL_Init(SDL_INIT_AUDIO);
 
-			SDL_AudioSpec desired_spec{};
-			desired_spec.freq = 44100;
-			desired_spec.format = AUDIO_S16SYS;
-			desired_spec.channels = 1;
-			desired_spec.samples = 64;
-			desired_spec.userdata = this;
-			desired_spec.callback = audio_callback;
+				SDL_AudioSpec desired_spec{};
+				desired_spec.freq = 44100;
+				desired_spec.format = AUDIO_S16SYS;
+				desired_spec.channels = 1;
+				desired_spec.samples = 64;
+				desired_spec.userdata = this;
+				desired_spec.callback = audio_callback;
 
-			audio_device = SDL_OpenAudioDevice(
-				NULL, 0, &desired_spec, NULL, 0);
+				audio_device = SDL_OpenAudioDevice(
+					NULL, 0, &desired_spec, NULL, 0);
+			}
 			block_bit = 4;
-			MD0CON.Setup(0xF2C0, 1, "Buzzer/MD0CON", &control, MMURegion::DefaultRead<uint8_t, 0x1>, MMURegion::DefaultWrite<uint8_t, 0x1>, emulator);
+			MD0CON.Setup(
+				0xF2C0, 1, "Buzzer/MD0CON", this,
+				[](MMURegion* region, size_t) {
+					return ((AudioDriver*)region->userdata)->control;
+				},
+				[](MMURegion* region, size_t, uint8_t data) {
+					AudioDriver* audio = (AudioDriver*)region->userdata;
+					audio->control = data & 0x1;
+					if (audio->control && audio->tempo == 2 && audio->emulator.deterministic)
+						audio->emulator.chipset.Schedule(audio, audio->emulator.cycles_per_second * 5 / 16);
+				},
+				emulator);
 			MD0TMP.Setup(0xF2C1, 1, "Buzzer/MD0TMP", &tempo, MMURegion::DefaultRead<uint8_t, 0x3>, MMURegion::DefaultWrite<uint8_t, 0x3>, emulator);
 			MD0TL.Setup(0xF2C2, 2, "Buzzer/MD0TL", &length, MMURegion::DefaultRead<uint16_t, 0xF07>, MMURegion::DefaultWrite<uint16_t, 0xF07>, emulator);
 		}
@@ -109,11 +127,20 @@ namespace casioemu {
 		void Initialise() override {
 			SDL_PauseAudioDevice(audio_device, 0);
 		}
+		/**
+		 * Ends a one-shot tone after the 312.5ms it lasts, only scheduled in
+		 * deterministic mode.
+		 */
 		void Tick() override {
+			if (tempo == 2)
+				control = tempo = 0;
 		}
 		void Uninitialise() override {
 			SDL_PauseAudioDevice(audio_device, 1);
 		}
+		void Serialize(StateStream& state) override {
+			state(control, tempo, length);
+		}
 	};
 	Peripheral* CreateBuzzerDriver(Emulator& emu) {
 		return new AudioDriver(emu);
@@ -6,6 +6,7 @@
 #include "Emulator.hpp"
 #include "Logger.hpp"
 #include "ModelInfo.h"
+#include "SaveState.hpp"
 
 namespace casioemu {
 	class BCDCalc : public Peripheral {
@@ -29,6 +30,7 @@ namespace casioemu {
 		void Initialise();
 		void Reset();
 		void Tick();
+		void Serialize(StateStream& state) override;
 
 		uint16_t CalcAddr(uint8_t base, uint8_t offset) {
 			if (offset > 12) {
@@ -51,6 +53,7 @@ namespace casioemu {
 		}
 
 		void GenerateParams();
+		void ScheduleWrites();
 		void F405control();
 		void ShiftLeft(int param);
 		void ShiftRight(int param);
@@ -59,6 +62,7 @@ namespace casioemu {
 	void BCDCalc::Initialise() {
 		if (emulator.hardware_id != HW_CLASSWIZ_II)
 			return;
+		clock_type = CLOCK_SCHEDULED;
 		F400_write = false;
 		F402_write = false;
 		F404_write = false;
@@ -74,6 +78,7 @@ namespace casioemu {
 				BCDCalc* bcdcalc = (BCDCalc*)region->userdata;
 				bcdcalc->data_F400 = data;
 				bcdcalc->F400_write = true;
+				bcdcalc->ScheduleWrites();
 			},
 			emulator);
 
@@ -96,21 +101,24 @@ namespace casioemu {
 			return bcdcalc->data_F402; }, [](MMURegion* region, size_t, uint8_t data) {
 			BCDCalc* bcdcalc = (BCDCalc*)region->userdata;
 			bcdcalc->data_F402 = data;
-			bcdcalc->F402_write = true; }, emulator);
+			bcdcalc->F402_write = true;
+			bcdcalc->ScheduleWrites(); }, emulator);
 		region_F404.Setup(
 			0xF404, 1, "BCDCalc/F404", this, [](MMURegion* region, size_t offset) {
 		 	BCDCalc* bcdcalc = (BCDCalc*)region->userdata;
 		 	return bcdcalc->data_F404; }, [](MMURegion* region, size_t, uint8_t data) {
 		 	BCDCalc* bcdcalc = (BCDCalc*)region->userdata;
 		 	bcdcalc->data_F404 = data;
-		 	bcdcalc->F404_write = true; }, emulator);
+		 	bcdcalc->F404_write = true;
+		 	bcdcalc->ScheduleWrites(); }, emulator);
 		region_F405.Setup(
 			0xF405, 1, "BCDCalc/F405", this, [](MMURegion* region, size_t offset) {
 		 	BCDCalc* bcdcalc = (BCDCalc*)region->userdata;
 		 	return bcdcalc->data_F405; }, [](MMURegion* region, size_t, uint8_t data) {
 		 	BCDCalc* bcdcalc = (BCDCalc*)region->userdata;
 		 	bcdcalc->data_F405 = data;
-		 	bcdcalc->F405_write = true; }, emulator);
+		 	bcdcalc->F405_write = true;
+		 	bcdcalc->ScheduleWrites(); }, emulator);
 	}
 
 	void BCDCalc::GenerateParams() {
@@ -1058,6 +1066,15 @@ namespace casioemu {
 		return;
 	}
 
+	/**
+	 * Register writes take effect on the tick after they happen, one register
+	 * per tick. Nothing else happens in between, so only those ticks are run.
+	 */
+	void BCDCalc::ScheduleWrites() {
+		if (F400_write || F402_write || F404_write || F405_write)
+			emulator.chipset.Schedule(this, 1);
+	}
+
 	void BCDCalc::Tick() {
 		if (F402_write) {
 			if (data_F402 == 0)
@@ -1065,11 +1082,13 @@ namespace casioemu {
 			if (data_F402 > 6)
 				data_F402 = 6;
 			F402_write = false;
+			ScheduleWrites();
 			return;
 		}
 		if (F404_write) {
 			data_F404 &= 0x1F;
 			F404_write = false;
+			ScheduleWrites();
 			return;
 		}
 		if (F400_write || F405_write) {
@@ -1124,6 +1143,12 @@ namespace casioemu {
 		data_F404 = 0;
 		data_F405 = 0;
 	}
+	void BCDCalc::Serialize(StateStream& state) {
+		state(data_F400, data_F402, data_F404, data_F405, data_F410, data_F414, data_F415, data_datas);
+		state(F400_write, F402_write, F404_write, F405_write);
+		state(data_operator, data_type_1, data_type_2, param1, param2, param3, param4, data_F404_copy);
+		state(data_mode, data_repeat_flag, data_a, data_b, data_c, data_d, data_F402_copy, data_F405_copy);
+	}
 	Peripheral* CreateBcdCalc(Emulator& emu) {
 		return new BCDCalc(emu);
 	}
@@ -2,18 +2,19 @@
 #include "Emulator.hpp"
 #include "MMURegion.hpp"
 #include "Peripheral.hpp"
-#include "Ui.hpp"
 #include <Models.h>
 #include <SDL.h>
 #include <cstring>
 #include <fstream>
 #include <algorithm>
+#include <random>
 
 namespace casioemu {
-	inline void fillRandomData(unsigned char* buf, size_t size) {
-		std::srand(static_cast<unsigned int>(SDL_GetPerformanceCounter())); // 使用当前时间作为随机种子
-		std::generate(buf, buf + size, []() {
-			return static_cast<unsigned char>(std::rand() % 256); // 生成0到255之间的随机数
+	inline void fillRandomData(unsigned char* buf, size_t size, unsigned int seed) {
+		// Not std::rand, which is shared by every emulator in the process.
+		std::minstd_rand random(seed); // Fixed in deterministic mode, see Emulator::GetRandomSeed
+		std::generate(buf, buf + size, [&random]() {
+			return static_cast<unsigned char>(random() % 256); // 生成0到255之间的随机数
 		});
 	}
 
@@ -42,6 +43,8 @@ namespace casioemu {
 
 		void* GetRam() override { return ram_buffer; }
 		void* GetPRam() override { return pram_buffer; }
+		size_t GetRamBufferSize() override { return ram_size; }
+		size_t GetPRamBufferSize() override { return pram_buffer ? 0x8000 : 0; }
 		void* QueryInterface(const char* name) override {
 			return strcmp(name, typeid(IRam).name()) == 0 ? static_cast<IRam*>(this) : nullptr;
 		}
@@ -52,40 +55,32 @@ namespace casioemu {
 		ram_size = GetRamSize(emulator.hardware_id) + (real_hardware ? 0 : 0x100);
 
 		ram_buffer = new uint8_t[ram_size];
-		fillRandomData(ram_buffer, ram_size);
+		fillRandomData(ram_buffer, ram_size, emulator.GetRandomSeed());
 
-		LoadRAMImage();
+		// * Batch runs start from a known state and leave the model's images alone.
+		if (!emulator.headless)
+			LoadRAMImage();
 
-		region.Setup(
+		region.SetupDirect(
 			GetRamBaseAddr(emulator.hardware_id), GetRamSize(emulator.hardware_id),
-			"BatteryBackedRAM", ram_buffer,
-			[](MMURegion* r, size_t o) { return static_cast<uint8_t*>(r->userdata)[o - r->base]; },
-			[](MMURegion* r, size_t o, uint8_t d) { static_cast<uint8_t*>(r->userdata)[o - r->base] = d; },
-			emulator);
+			"BatteryBackedRAM", ram_buffer, nullptr, emulator);
 
 		if (emulator.hardware_id == HW_FX_5800P) {
 			pram_buffer = new uint8_t[0x8000];
-			fillRandomData(pram_buffer, 0x8000);
-			region_5.Setup(
-				0x40000, 0x8000, "Segment4", pram_buffer,
-				[](MMURegion* r, size_t o) { return static_cast<uint8_t*>(r->userdata)[o - r->base]; },
-				[](MMURegion* r, size_t o, uint8_t d) { static_cast<uint8_t*>(r->userdata)[o - r->base] = d; },
-				emulator);
+			fillRandomData(pram_buffer, 0x8000, emulator.GetRandomSeed());
+			region_5.SetupDirect(0x40000, 0x8000, "Segment4", pram_buffer, nullptr, emulator);
 		}
 
 		if (!real_hardware) {
-			region_2.Setup(
+			region_2.SetupDirect(
 				emulator.hardware_id == HW_ES_PLUS	  ? 0x9800
 				: emulator.hardware_id == HW_CLASSWIZ ? 0x49800
 													  : 0x89800,
-				0x0100, "BatteryBackedRAM/2", ram_buffer + ram_size - 0x100,
-				[](MMURegion* r, size_t o) { return static_cast<uint8_t*>(r->userdata)[o - r->base]; },
-				[](MMURegion* r, size_t o, uint8_t d) { static_cast<uint8_t*>(r->userdata)[o - r->base] = d; },
-				emulator);
+				0x0100, "BatteryBackedRAM/2", ram_buffer + ram_size - 0x100, nullptr, emulator);
 		}
 
-		SDL_AddTimer(SAVE_INTERVAL_MS, SaveRamCallback, this);
-		n_ram_buffer = (char*)ram_buffer;
+		if (!emulator.headless)
+			SDL_AddTimer(SAVE_INTERVAL_MS, SaveRamCallback, this);
 	}
 
 	void BatteryBackedRAM::SaveRAMImage() {
@@ -137,7 +132,8 @@ namespace casioemu {
 	}
 
 	void BatteryBackedRAM::Uninitialise() {
-		SaveRAMImage();
+		if (!emulator.headless)
+			SaveRAMImage();
 		delete[] ram_buffer;
 		delete[] pram_buffer;
 	}
@@ -1,4 +1,5 @@
 ﻿#pragma once
+#include <cstddef>
 namespace casioemu {
 	class Peripheral* CreateBatteryBackedRAM(class Emulator& emu);
 }
@@ -6,4 +7,6 @@ class IRam {
 public:
 	virtual void* GetRam() = 0;
 	virtual void* GetPRam() = 0;
+	virtual size_t GetRamBufferSize() = 0;
+	virtual size_t GetPRamBufferSize() = 0;
 };
\ No newline at end of file
@@ -59,6 +59,26 @@ namespace casioemu
         }
     }
 
+    bool ExternalInterrupts::IsIdle() {
+        // Level-triggered pins raise their interrupt every tick the level holds.
+        for(int index = 0; index < 3; index++) {
+            switch ((emulator.chipset.data_EXICON >> (2 * index + 2)) & 0x03)
+            {
+            case 2:
+                if(emulator.chipset.Port0Inputlevel[index])
+                    return false;
+                break;
+            case 3:
+                if(!emulator.chipset.Port0Inputlevel[index])
+                    return false;
+                break;
+            default:
+                break;
+            }
+        }
+        return true;
+    }
+
     void ExternalInterrupts::Reset() {
         emulator.chipset.data_EXICON = 0;
     }
@@ -1,8 +1,11 @@
-﻿#include "Chipset/Chipset.hpp"
+﻿#include "Chipset/CPU.hpp"
+#include "Chipset/Chipset.hpp"
 #include "Chipset/MMURegion.hpp"
 #include "Emulator.hpp"
 #include "Peripheral.hpp"
+#include "SaveState.hpp"
 #include <cstdint>
+#include <map>
 namespace casioemu {
 	class Flash : public Peripheral {
 		MMURegion region_flash_addr, region_flash_data,
@@ -12,7 +15,17 @@ namespace casioemu {
 		uint8_t data_flash_control = 0,
 				data_flash_segment = 0;
 		int flashing_status = 0;
+		/**
+		 * Words programmed into the ROM image, with what the image had there
+		 * before. Save states leave the ROM out and carry these instead.
+		 */
+		struct ProgrammedWord {
+			uint16_t original, value;
+		};
+		std::map<uint32_t, ProgrammedWord> programmed;
+		void Program(uint32_t index, uint16_t value);
 		void Initialise() override;
+		void Serialize(StateStream& state) override;
 
 	public:
 		Flash(Emulator& emulator) : Peripheral(emulator) {
@@ -45,10 +58,8 @@ void casioemu::Flash::Initialise() {
 			}
 			if (offset == 0xf0e3 && flash->flashing_status == 2) {
 				auto index = (flash->data_flash_segment << 16) | flash->data_flash_addr;
-				if (index <= region->emulator->chipset.rom_data.size() - 2) {
-					*((uint8_t*)&region->emulator->chipset.rom_data[index]) = flash->data_flash_data & 0xff;
-					*((uint8_t*)&region->emulator->chipset.rom_data[index + 1]) = flash->data_flash_data >> 8;
-				}
+				if (index <= region->emulator->chipset.rom_data.size() - 2)
+					flash->Program(index, flash->data_flash_data);
 				flash->flashing_status = 0;
 			}
 		},
@@ -73,4 +84,40 @@ void casioemu::Flash::Initialise() {
 		},
 		emulator);
 	flash_segment.Setup(0xF0E6, 1, "Flash/FLASHSEG", &data_flash_segment, casioemu::MMURegion::DefaultRead<uint8_t, 0x1F>, casioemu::MMURegion::DefaultWrite<uint8_t, 0x1F>, emulator);
+}
+void casioemu::Flash::Program(uint32_t index, uint16_t value) {
+	auto& rom = emulator.chipset.rom_data;
+	auto word = programmed.try_emplace(index, ProgrammedWord{(uint16_t)(rom[index] | rom[index + 1] << 8), 0});
+	word.first->second.value = value;
+	rom[index] = value & 0xff;
+	rom[index + 1] = value >> 8;
+	emulator.chipset.cpu.InvalidateDecodeCache();
+}
+void casioemu::Flash::Serialize(StateStream& state) {
+	state(data_flash_addr, data_flash_data, data_flash_control, data_flash_segment, flashing_status);
+	uint32_t count = programmed.size();
+	state(count);
+	if (!state.Loading()) {
+		for (auto& [index, word] : programmed) {
+			uint32_t word_index = index;
+			uint16_t value = word.value;
+			state(word_index, value);
+		}
+		return;
+	}
+	// * Back to the ROM image as loaded, then program what the state had.
+	auto& rom = emulator.chipset.rom_data;
+	for (auto& [index, word] : programmed) {
+		rom[index] = word.original & 0xff;
+		rom[index + 1] = word.original >> 8;
+	}
+	programmed.clear();
+	emulator.chipset.cpu.InvalidateDecodeCache();
+	for (uint32_t ix = 0; ix != count && state.Good(); ++ix) {
+		uint32_t index = 0;
+		uint16_t value = 0;
+		state(index, value);
+		if (state.Good() && rom.size() >= 2 && index <= rom.size() - 2)
+			Program(index, value);
+	}
 }
\ No newline at end of file
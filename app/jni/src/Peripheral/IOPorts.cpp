@@ -5,7 +5,7 @@
 #include "Chipset/CPU.hpp"
 #include "Emulator.hpp"
 #include "Logger.hpp"
-#include "Gui/Ui.hpp"
+#include "SaveState.hpp"
 
 namespace casioemu {
 	void IOPorts::Initialise() {
@@ -178,4 +178,10 @@ namespace casioemu {
 			emulator.chipset.Port1Outputlevel[i] = false;
 		}
 	}
+
+	void IOPorts::Serialize(StateStream& state) {
+		state(port0_mode, port0_control_0, port0_control_1, port0_direction, port0_unk);
+		state(port1_mode_0, port1_mode_1, port1_control_0, port1_control_1, port1_direction);
+		state(port0_output, port1_output);
+	}
 } // namespace casioemu
\ No newline at end of file
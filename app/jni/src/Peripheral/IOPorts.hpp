@@ -38,5 +38,6 @@ namespace casioemu {
 
 		void Initialise();
 		void Reset();
+		void Serialize(StateStream& state);
 	};
 } // namespace casioemu
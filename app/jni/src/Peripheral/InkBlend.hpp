@@ -0,0 +1,144 @@
+﻿#pragma once
+#include "Config.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CASIOEMU_INK_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define CASIOEMU_INK_NEON
+#include <arm_neon.h>
+#endif
+
+namespace casioemu {
+	// * A row whose dots are all this close to their targets is left alone until the controller changes it.
+	constexpr float ink_settle_distance = 1.0f / 16;
+
+	/**
+	 * Fades one row of LCD dots towards the alpha the controller drives them
+	 * at, `alpha = alpha * ratio + target * (1 - ratio)`, 4 dots at a time.
+	 *
+	 * Each byte of `plane0` is 8 dots, most significant bit first. A dot's
+	 * target is `target[bit]`, or `target[bit0 | bit1 << 1]` when the model
+	 * has a second plane for greyscale. `flip` mirrors the row, so that the
+	 * last bit of the last byte ends up in `alpha[0]`.
+	 *
+	 * Returns how far the furthest dot still is from its target, see
+	 * `ink_settle_distance`.
+	 */
+	inline float BlendInkRow(float* alpha, const uint8_t* plane0, const uint8_t* plane1, size_t bytes, const float target[4], float ratio, bool flip) {
+		const float inverse = 1 - ratio;
+#if defined(CASIOEMU_INK_SSE2)
+		const __m128i masks[2][2] = {
+			{_mm_setr_epi32(0x80, 0x40, 0x20, 0x10), _mm_setr_epi32(0x08, 0x04, 0x02, 0x01)},
+			{_mm_setr_epi32(0x01, 0x02, 0x04, 0x08), _mm_setr_epi32(0x10, 0x20, 0x40, 0x80)},
+		};
+		const __m128 t0 = _mm_set1_ps(target[0]), t1 = _mm_set1_ps(target[1]), t2 = _mm_set1_ps(target[2]), t3 = _mm_set1_ps(target[3]);
+		const __m128 r = _mm_set1_ps(ratio), ri = _mm_set1_ps(inverse), sign = _mm_set1_ps(-0.0f);
+		__m128 distance = _mm_setzero_ps();
+		auto select = [](__m128 mask, __m128 on, __m128 off) {
+			return _mm_or_ps(_mm_and_ps(mask, on), _mm_andnot_ps(mask, off));
+		};
+		for (size_t n = 0; n != bytes; ++n) {
+			size_t ix = flip ? bytes - 1 - n : n;
+			__m128i b0 = _mm_set1_epi32(plane0[ix]);
+			__m128i b1 = _mm_set1_epi32(plane1 ? plane1[ix] : 0);
+			for (int half = 0; half != 2; ++half) {
+				auto& mask = masks[flip][half];
+				__m128 m0 = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(b0, mask), mask));
+				__m128 t = select(m0, t1, t0);
+				if (plane1) {
+					__m128 m1 = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(b1, mask), mask));
+					t = select(m1, select(m0, t3, t2), t);
+				}
+				float* dat = alpha + n * 8 + half * 4;
+				__m128 blended = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(dat), r), _mm_mul_ps(t, ri));
+				_mm_storeu_ps(dat, blended);
+				distance = _mm_max_ps(distance, _mm_andnot_ps(sign, _mm_sub_ps(t, blended)));
+			}
+		}
+		float lanes[4];
+		_mm_storeu_ps(lanes, distance);
+		return std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+#elif defined(CASIOEMU_INK_NEON)
+		static const uint32_t mask_bits[2][2][4] = {
+			{{0x80, 0x40, 0x20, 0x10}, {0x08, 0x04, 0x02, 0x01}},
+			{{0x01, 0x02, 0x04, 0x08}, {0x10, 0x20, 0x40, 0x80}},
+		};
+		const float32x4_t t0 = vdupq_n_f32(target[0]), t1 = vdupq_n_f32(target[1]), t2 = vdupq_n_f32(target[2]), t3 = vdupq_n_f32(target[3]);
+		const float32x4_t r = vdupq_n_f32(ratio), ri = vdupq_n_f32(inverse);
+		float32x4_t distance = vdupq_n_f32(0);
+		for (size_t n = 0; n != bytes; ++n) {
+			size_t ix = flip ? bytes - 1 - n : n;
+			uint32x4_t b0 = vdupq_n_u32(plane0[ix]);
+			uint32x4_t b1 = vdupq_n_u32(plane1 ? plane1[ix] : 0);
+			for (int half = 0; half != 2; ++half) {
+				uint32x4_t mask = vld1q_u32(mask_bits[flip][half]);
+				uint32x4_t m0 = vtstq_u32(b0, mask);
+				float32x4_t t = vbslq_f32(m0, t1, t0);
+				if (plane1)
+					t = vbslq_f32(vtstq_u32(b1, mask), vbslq_f32(m0, t3, t2), t);
+				float* dat = alpha + n * 8 + half * 4;
+				float32x4_t blended = vaddq_f32(vmulq_f32(vld1q_f32(dat), r), vmulq_f32(t, ri));
+				vst1q_f32(dat, blended);
+				distance = vmaxq_f32(distance, vabdq_f32(t, blended));
+			}
+		}
+		float lanes[4];
+		vst1q_f32(lanes, distance);
+		return std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+#else
+		float distance = 0;
+		for (size_t n = 0; n != bytes; ++n) {
+			size_t ix = flip ? bytes - 1 - n : n;
+			for (int bit = 0; bit != 8; ++bit) {
+				uint8_t mask = flip ? 1 << bit : 0x80 >> bit;
+				int level = (plane0[ix] & mask ? 1 : 0) | (plane1 && plane1[ix] & mask ? 2 : 0);
+				float& dat = alpha[n * 8 + bit];
+				dat = dat * ratio + target[level] * inverse;
+				distance = std::max(distance, std::abs(target[level] - dat));
+			}
+		}
+		return distance;
+#endif
+	}
+
+	/**
+	 * Fades a row of dots towards 0, for rows the controller isn't driving.
+	 * Returns the highest alpha left, like `BlendInkRow`.
+	 */
+	inline float FadeInkRow(float* alpha, size_t count, float ratio) {
+		float distance = 0;
+		for (size_t ix = 0; ix != count; ++ix) {
+			alpha[ix] *= ratio;
+			distance = std::max(distance, alpha[ix]);
+		}
+		return distance;
+	}
+
+	/**
+	 * Turns 8 bytes of a column-major display (byte `j` is column `j`, bit
+	 * `r` is row `r`) into 8 rows for `BlendInkRow`, so `rows[r]` has
+	 * column 0 in its most significant bit.
+	 */
+	inline void TransposeInkBlock(const uint8_t* columns, uint8_t* rows) {
+		uint64_t x = 0;
+		for (int j = 0; j != 8; ++j)
+			x = x << 8 | columns[j];
+		uint64_t t;
+		t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AA;
+		x = x ^ t ^ (t << 7);
+		t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCC;
+		x = x ^ t ^ (t << 14);
+		t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0;
+		x = x ^ t ^ (t << 28);
+		// * Row 7 is now the most significant byte.
+		for (int r = 0; r != 8; ++r)
+			rows[r] = (uint8_t)(x >> (r * 8));
+	}
+} // namespace casioemu
@@ -5,17 +5,22 @@
 #include "Emulator.hpp"
 #include "Logger.hpp"
 #include "ModelInfo.h"
+#include "Replay.hpp"
+#include "Rewind.hpp"
+#include "SaveState.hpp"
 
 #include <ML620Ports.h>
 #include <SDL.h>
 #include <chrono>
+#include <cmath>
+#include <cstring>
 #include <fstream>
 #include <thread>
 #include <unordered_map>
 #include "vibration.h"
 
 namespace casioemu {
-	class Keyboard : public Peripheral {
+	class Keyboard : public Peripheral, public IKeyboard {
 		MMURegion region_ko_mask, region_ko, region_ki, region_input_mode, region_input_filter;
 		uint16_t keyboard_out, keyboard_out_mask;
 		uint8_t keyboard_in, input_mode, input_filter, keyboard_ghost[8], ki_ghost[8];
@@ -57,6 +62,7 @@ namespace casioemu {
 		void Initialise();
 		void Reset();
 		void Tick();
+		bool IsIdle() override;
 		void Frame();
 		void UIEvent(SDL_Event& event);
 		void Uninitialise();
@@ -68,6 +74,19 @@ namespace casioemu {
 		void ReleaseAll();
 		void RecalculateKI();
 		void RecalculateGhost();
+		void Serialize(StateStream& state) override;
+
+		/**
+		 * Input from the UI goes through here. In deterministic mode it is
+		 * applied on the tick thread and recorded, see `Replay`.
+		 */
+		void Dispatch(uint8_t action, uint8_t button);
+		void ApplyKeyAction(uint8_t action, uint8_t button) override;
+		int FindButton(const std::string& name) override;
+		size_t ButtonIndex(int kiko);
+		void* QueryInterface(const char* name) override {
+			return strcmp(name, typeid(IKeyboard).name()) == 0 ? static_cast<IKeyboard*>(this) : nullptr;
+		}
 	};
 	void Keyboard::Initialise() {
 		renderer = emulator.GetRenderer();
@@ -236,20 +255,9 @@ namespace casioemu {
 				printf("[Keyboard][Warn] Key %x is being bind to a invalid or empty key '%s'\n", btn.kiko, button_name);
 
 			uint8_t code = btn.kiko;
-			size_t button_ix;
-			if (code == 0xFF) {
-				button_ix = 63;
-			}
-			else {
-				if (emulator.hardware_id == HW_TI) {
-					button_ix = btn.kiko;
-				}
-				else {
-					button_ix = ((code >> 1) & 0x38) | (code & 0x07);
-				}
-				if (button_ix >= 64)
-					PANIC("button index doesn't fit 6 bits\n");
-			}
+			size_t button_ix = ButtonIndex(btn.kiko);
+			if (button_ix >= 64)
+				PANIC("button index doesn't fit 6 bits\n");
 
 			if (button_key != SDLK_UNKNOWN) {
 				bool insert_success = keyboard_map.emplace(button_key, button_ix).second;
@@ -373,6 +381,26 @@ namespace casioemu {
 		keyboard_in_last = keyboard_in;
 	}
 
+	bool Keyboard::IsIdle() {
+		if (emulator.ModelDefinition.hardware_id == HW_TI)
+			return true;
+		if (factory_test)
+			return keyboard_in == (uint8_t)~0b00011000;
+		if (!real_hardware)
+			return keyboard_ready_emu <= 1;
+		// * Tick has to see every change of the latch, or an edge is missed.
+		if (keyboard_in != keyboard_in_last || input_filter != input_filter_last)
+			return false;
+		switch (emulator.chipset.data_EXICON & 0x03) {
+		case 2:
+			return !(input_filter & keyboard_in);
+		case 3:
+			return !(input_filter & ~keyboard_in);
+		default:
+			return true;
+		}
+	}
+
 	void Keyboard::Frame() {
 		SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
 		for (auto& button : buttons) {
@@ -398,7 +426,7 @@ namespace casioemu {
                     SDL_Log("Pressed at: %f %f",event.tfinger.x , event.tfinger.y);
                     PressAt(event.tfinger.x , event.tfinger.y, false);
                 } else {
-                    ReleaseAll();
+                    Dispatch(KA_RELEASE_ALL, 0);
                 }
                 break;
 		case SDL_MOUSEBUTTONDOWN:
@@ -408,7 +436,7 @@ namespace casioemu {
 				if (event.button.state == SDL_PRESSED)
 					PressAt(event.button.x, event.button.y, false);
 				else
-					ReleaseAll();
+					Dispatch(KA_RELEASE_ALL, 0);
 				break;
 
 			case SDL_BUTTON_RIGHT:
@@ -424,22 +452,52 @@ namespace casioemu {
 			auto iterator = keyboard_map.find(keycode);
 			printf("[Keyboard][Info] SDL_Keycode: %x(%s)\n", keycode, SDL_GetKeyName(keycode));
 			if (event.key.keysym.sym == SDLK_F11 && event.key.state) {
-				if (event.key.keysym.mod & KMOD_LCTRL) {
-					emulator.chipset.Reset();
-					return;
-				}
-				factory_test = !factory_test;
-				emulator.chipset.tiDiagMode = factory_test;
-				emulator.chipset.tiKey = 0xfe;
-				printf("Factory test/Ti Diag status: %d\n", factory_test);
+				Dispatch(event.key.keysym.mod & KMOD_LCTRL ? KA_RESET : KA_FACTORY_TEST, 0);
 				return;
 			}
 			if (iterator == keyboard_map.end())
 				break;
 			if (event.key.state == SDL_PRESSED)
-				PressButton(buttons[iterator->second], false);
+				Dispatch(KA_PRESS, (uint8_t)iterator->second);
 			else
-				ReleaseAll();
+				Dispatch(KA_RELEASE_ALL, 0);
+			break;
+		}
+	}
+
+	void Keyboard::Dispatch(uint8_t action, uint8_t button) {
+		if (!emulator.deterministic) {
+			ApplyKeyAction(action, button);
+			return;
+		}
+		emulator.RunOnTickThread([this, action, button] {
+			// * A replay decides the input by itself.
+			if (emulator.replay.Playing())
+				return;
+			ApplyKeyAction(action, button);
+			emulator.replay.Record(action, button);
+		});
+	}
+
+	void Keyboard::ApplyKeyAction(uint8_t action, uint8_t button) {
+		emulator.rewind.LogInput(action, button);
+		switch (action) {
+		case KA_PRESS:
+		case KA_STICK:
+			if (button < 64)
+				PressButton(buttons[button], action == KA_STICK);
+			break;
+		case KA_RELEASE_ALL:
+			ReleaseAll();
+			break;
+		case KA_RESET:
+			emulator.chipset.Reset();
+			break;
+		case KA_FACTORY_TEST:
+			factory_test = !factory_test;
+			emulator.chipset.tiDiagMode = factory_test;
+			emulator.chipset.tiKey = 0xfe;
+			printf("Factory test/Ti Diag status: %d\n", factory_test);
 			break;
 		}
 	}
@@ -498,9 +556,10 @@ namespace casioemu {
 	}
 
 	void Keyboard::PressAt(int x, int y, bool stick) {
-		for (auto& button : buttons) {
+		for (size_t ix = 0; ix != 64; ++ix) {
+			auto& button = buttons[ix];
 			if (button.rect.x <= x && button.rect.y <= y && button.rect.x + button.rect.w > x && button.rect.y + button.rect.h > y) {
-				PressButton(button, stick);
+				Dispatch(stick ? KA_STICK : KA_PRESS, (uint8_t)ix);
 				break;
 			}
 		}
@@ -521,6 +580,24 @@ namespace casioemu {
 		}
 	}
 
+	size_t Keyboard::ButtonIndex(int kiko) {
+		uint8_t code = kiko;
+		if (code == 0xFF)
+			return 63;
+		if (emulator.hardware_id == HW_TI)
+			return kiko;
+		return ((code >> 1) & 0x38) | (code & 0x07);
+	}
+
+	int Keyboard::FindButton(const std::string& name) {
+		bool by_code = name.starts_with("0x");
+		int code = by_code ? (int)std::stoul(name, nullptr, 16) : -1;
+		for (auto& btn : emulator.ModelDefinition.buttons)
+			if (by_code ? btn.kiko == code : btn.keyname == name)
+				return (int)ButtonIndex(btn.kiko);
+		return -1;
+	}
+
 	void Keyboard::StartInject() {
 	}
 
@@ -675,6 +752,16 @@ namespace casioemu {
 				has_input = keyboard_in_emu = keyboard_out_emu = 0;
 		}
 	}
+
+	void Keyboard::Serialize(StateStream& state) {
+		state(keyboard_out, keyboard_out_mask, keyboard_in, input_mode, input_filter, keyboard_ghost, ki_ghost);
+		state(keyboard_in_last, input_filter_last);
+		state(keyboard_ready_emu, keyboard_out_emu, keyboard_in_emu, keyboard_pd_emu, emu_ki_readcount, emu_ko_readcount);
+		state(has_input, p0, p1, p146);
+		for (auto& button : buttons)
+			state(button.pressed, button.stuck);
+	}
+
 	Peripheral* CreateKeyboard(Emulator& emu) {
 		return new Keyboard(emu);
 	}
@@ -1,4 +1,27 @@
 ﻿#pragma once
+#include <cstdint>
+#include <string>
 namespace casioemu {
 	class Peripheral* CreateKeyboard(class Emulator& emu);
-}
\ No newline at end of file
+}
+/**
+ * Keyboard input boiled down to what the machine sees of it, so that it can
+ * be recorded and replayed. `button` is an index into the keyboard's buttons.
+ */
+class IKeyboard {
+public:
+	enum KeyAction : uint8_t {
+		KA_PRESS,
+		KA_STICK,
+		KA_RELEASE_ALL,
+		KA_RESET,
+		KA_FACTORY_TEST,
+		KA_END = 0xFF // Only in replay files, see `Replay`.
+	};
+	virtual void ApplyKeyAction(uint8_t action, uint8_t button) = 0;
+	/**
+	 * The button bound to the key `name` in the model's config, or with the
+	 * KI/KO code `name` if it is written as 0x... Returns -1 if there is none.
+	 */
+	virtual int FindButton(const std::string& name) = 0;
+};
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "Emulator.hpp"
 #include "MMURegion.hpp"
 #include "Peripheral.hpp"
+#include "SaveState.hpp"
 #define DefSfr(x)        \
 	MMURegion reg_##x{}; \
 	uint8_t dat_##x{};
@@ -196,6 +197,10 @@ namespace casioemu {
 			output_callback = callback;
 		}
 		void UpdateInterrupt(int pi_tmp);
+		void Serialize(StateStream& state) {
+			state(dat_data, dat_dir, dat_mode0, dat_mode1, dat_con, dat_exicon, dat_ie, dat_is);
+			state(PortLevel, PortInput, PortInputExists, PortInputOld, TriggerWhenRise, TriggerWhenFall, SamplingMode);
+		}
 	};
 	class Ports : public Peripheral, IPortProvider {
 	public:
@@ -244,6 +249,12 @@ namespace casioemu {
 			}
 			return 0;
 		}
+		void Serialize(StateStream& state) override {
+			state(ExiSelect_d, ExiCon_d);
+			for (auto port : ports)
+				if (port)
+					port->Serialize(state);
+		}
 		void* QueryInterface(const char* name) override {
 			if (strcmp(name, typeid(IPortProvider).name()) == 0) {
 				return (IPortProvider*)this;
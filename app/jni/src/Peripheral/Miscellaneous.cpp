@@ -2,6 +2,7 @@
 
 #include "Chipset/CPU.hpp"
 #include "Chipset/Chipset.hpp"
+#include "Chipset/MMU.hpp"
 #include "Emulator.hpp"
 #include "Logger.hpp"
 
@@ -31,7 +32,11 @@ namespace casioemu {
 			region_F004.Setup(
 				0xF004, 1, "Miscellaneous/DataSegAccess", this, [](MMURegion* region, size_t) { return (uint8_t)((Miscellaneous*)region->userdata)->emulator.chipset.SegmentAccess; }, [](MMURegion* region, size_t, uint8_t data) {
 				Miscellaneous* self = (Miscellaneous *)region->userdata;
-				self->emulator.chipset.SegmentAccess = data & 1; }, emulator);
+				if (self->emulator.chipset.SegmentAccess != (data & 1)) {
+					self->emulator.chipset.SegmentAccess = data & 1;
+					self->emulator.chipset.mmu.UpdateCodePages();
+					self->emulator.chipset.cpu.InvalidateDecodeCache();
+				} }, emulator);
 		}
 	}
 
@@ -6,6 +6,7 @@
 
 namespace casioemu {
 	class Emulator;
+	class StateStream;
 
 	enum ClockType {
 		CLOCK_UNDEFINED = 0,
@@ -13,7 +14,9 @@ namespace casioemu {
 		CLOCK_HSCLK,
 		CLOCK_SYSCLK,
 		CLOCK_EMUCLK,
-		CLOCK_STOPPED
+		CLOCK_STOPPED,
+		// Only ticked when an event queued through `Chipset::Schedule` falls due.
+		CLOCK_SCHEDULED
 	};
 
 	class Peripheral {
@@ -24,8 +27,10 @@ namespace casioemu {
 		bool enabled = false;
 
 	public:
-		int clock_type = CLOCK_SYSCLK;
+		int clock_type = CLOCK_SCHEDULED;
 		int block_bit = -1;
+		// Tick count of this peripheral's pending scheduled event, 0 if there is none.
+		uint64_t scheduled_cycle = 0;
 		Peripheral(Emulator& emulator) : emulator(emulator) {}
 		virtual void Initialise() {}
 		virtual void Uninitialise() {}
@@ -35,6 +40,19 @@ namespace casioemu {
 		virtual void UIEvent(SDL_Event& event) {}
 		virtual void Reset() {}
 		virtual void ResetLSCLK() {}
+		/**
+		 * Whether calls to `Tick` may be left out while the CPU is halted or
+		 * stopped without the guest noticing. Peripherals whose `Tick` raises
+		 * interrupts from input levels or edges must return false while one
+		 * would be raised. See `Chipset::SkipIdleTicks`.
+		 */
+		virtual bool IsIdle() { return true; }
+		/**
+		 * Writes or reads back everything the guest could observe about this
+		 * peripheral, in the same order both ways. `scheduled_cycle` and memory
+		 * blocks are taken care of by `Chipset::Serialize` and `SaveStates`.
+		 */
+		virtual void Serialize(StateStream& state) {}
 		virtual void* QueryInterface(const char*) { return 0; }
 		virtual ~Peripheral() {}
 	};
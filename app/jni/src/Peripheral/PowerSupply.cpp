@@ -4,6 +4,7 @@
 #include "Chipset/MMU.hpp"
 #include "Emulator.hpp"
 #include "Logger.hpp"
+#include "SaveState.hpp"
 
 #include <cmath>
 
@@ -43,6 +44,10 @@ namespace casioemu {
 		void Initialise();
 		void Tick();
 		void Reset();
+		bool IsIdle() override {
+			return !isTestRoutineRunning && !BLDControl;
+		}
+		void Serialize(StateStream& state) override;
 	};
 	void PowerSupply::Initialise() {
 		clock_type = CLOCK_UNDEFINED;
@@ -183,6 +188,12 @@ namespace casioemu {
 		isTestRoutineRunning = false;
 		BLDFlag = emulator.BatteryVoltage >= ThreshVoltage[0] ? 1 : 0;
 	}
+
+	void PowerSupply::Serialize(StateStream& state) {
+		state(threshold, data_BLDCON2, data_SPIndicator, BLDMode, BLDFlag, BLDControl);
+		state(isTestRoutineRunning, TestTimer, CurrentTestMode, CurrentRepMode, HasResult, CurrentThresh, DelayTicks);
+	}
+
 	Peripheral* CreatePowerSupply(Emulator& emu) {
 		return new PowerSupply(emu);
 	}
@@ -19,7 +19,6 @@ namespace casioemu {
 	};
 	static void SetupROMRegion(MMURegion& region, size_t region_base, size_t size, size_t rom_base, bool strict_memory, Emulator& emulator, std::string description = {}) {
 		uint8_t* data = emulator.chipset.rom_data.data();
-		auto offset = (long long)rom_base - (long long)region_base;
 		if (description.empty())
 			description = "ROM/Segment" + std::to_string(region_base >> 16);
 
@@ -31,18 +30,10 @@ namespace casioemu {
 																	  // printf("ROM::[region write lambda]: attempt to write %02hhX to %06zX\n", data, address);
 																  };
 
-		if (offset >= 0)
-			region.Setup(
-				region_base, size, description, data + offset, [](MMURegion* region, size_t address) {
-					return ((uint8_t*)(region->userdata))[address];
-				},
-				write_function, emulator);
-		else
-			region.Setup(
-				region_base, size, description, data + rom_base, [](MMURegion* region, size_t address) {
-					return ((uint8_t*)(region->userdata))[address - region->base];
-				},
-				write_function, emulator);
+		region.SetupDirect(region_base, size, description, data + rom_base, write_function, emulator);
+
+		// * Reading program memory as data inserts a wait cycle.
+		region.wait_states = 1;
 	}
 
 	void ROMWindow::Initialise() {
@@ -4,6 +4,7 @@
 #include "Chipset/MMU.hpp"
 #include "Emulator.hpp"
 #include "Logger.hpp"
+#include "SaveState.hpp"
 
 namespace casioemu {
 	class RealTimeClock : public Peripheral {
@@ -49,6 +50,7 @@ namespace casioemu {
 		void Initialise();
 		void Reset();
 		void Tick();
+		void Serialize(StateStream& state) override;
 	};
 	void RealTimeClock::Initialise() {
 		clock_type = CLOCK_LSCLK;
@@ -240,6 +242,12 @@ namespace casioemu {
 	void RealTimeClock::Reset() {
 		// RTCCON = 0;
 	}
+
+	void RealTimeClock::Serialize(StateStream& state) {
+		state(RTCSEC, RTCMIN, RTCHOUR, RTCWEEK, RTCDAY, RTCMON, RTCYEAR, RTCCON);
+		state(AL0MIN, AL0HOUR, AL0WEEK, AL1MIN, AL1HOUR, AL1DAY, AL1MON, RTCSEC_carry);
+	}
+
 	Peripheral* CreateRtc(Emulator& emu) {
 		return new RealTimeClock(emu);
 	}
@@ -18,22 +18,27 @@
 
 */
 #include "Screen.hpp"
+#include "BatteryBackedRAM.hpp"
+#include "InkBlend.hpp"
 #include "Chipset/Chipset.hpp"
 #include "Chipset/MMU.hpp"
 #include "Chipset/MMURegion.hpp"
 #include "Emulator.hpp"
-#include "Gui/HwController.h"
+#include "FramePacer.hpp"
 #include "Logger.hpp"
 #include "ML620Ports.h"
 #include "ModelInfo.h"
 #include "Models.h"
+#include "SaveState.hpp"
 #include "PopUpDisplay.h"
-#include "Ui.hpp"
 #include <algorithm> // for std::generate
 #include <array>
+#include <atomic>
 #include <cstdlib> // for std::rand
+#include <cstring>
 #include <ctime>   // for std::time
 #include <iomanip>
+#include <random>
 #include <vector>
 
 #ifdef __ANDROID__
@@ -101,22 +106,32 @@ inline constexpr std::array<uint8_t, 256> generate_lookup_table() {
 // 定义查找表
 constexpr auto bit_lookup_table = generate_lookup_table();
 
-inline void fillRandomData(unsigned char* buf, size_t size) {
-        std::srand(static_cast<unsigned int>(SDL_GetPerformanceCounter())); // 使用当前时间作为随机种子
-        std::generate(buf, buf + size, []() {
-                return static_cast<unsigned char>(std::rand() % 256); // 生成0到255之间的随机数
+inline void fillRandomData(unsigned char* buf, size_t size, unsigned int seed) {
+        // Not std::rand, which is shared by every emulator in the process.
+        std::minstd_rand random(seed); // Fixed in deterministic mode, see Emulator::GetRandomSeed
+        std::generate(buf, buf + size, [&random]() {
+                return static_cast<unsigned char>(random() % 256); // 生成0到255之间的随机数
         });
 }
 
 #pragma warning(disable : 4244)
 
+int screen_flashing_threshold = 20;
+float screen_fading_blending_coefficient = 0;
+bool enable_screen_fading = false;
+float screen_flashing_brightness_coeff = 1.5f;
+int screen_buffer_select = 0;
+
 namespace casioemu {
         struct SpriteBitmap {
                 const char* name;
                 uint8_t mask, offset;
         };
+        inline int screen_scan_line(Uint64 t, int screen_refresh_rate) {
+                return (static_cast<Uint64>((t * screen_refresh_rate) / 250)) % 64;
+        }
         inline int update_screen_scan_alpha(float* screen_scan_alpha, Uint64 t, int screen_refresh_rate) {
-                int n = (static_cast<Uint64>((t * screen_refresh_rate) / 250)) % 64;
+                int n = screen_scan_line(t, screen_refresh_rate);
 
                 if (screen_refresh_rate < screen_flashing_threshold) {
                         for (size_t i = 0; i < 64; i++) {
@@ -142,7 +157,7 @@ namespace casioemu {
                 return n;
         }
         template <HardwareId hardware_id>
-        class Screen : public Peripheral {
+        class Screen : public Peripheral, public IScreen {
                 static int const N_ROW,
                         ROW_SIZE,
                         OFFSET,
@@ -184,14 +199,78 @@ namespace casioemu {
                 bool inited = 0;
                 bool enabled_2 = 0;
 
+                // The dot matrix is composited on the CPU into lcd_texture and drawn with one copy, see Frame.
+                SDL_Texture* lcd_texture{};
+                // Each dot is drawn dot_width * dot_height, the pixel sprite's dest size, and dot_step_x * dot_step_y apart, its src size.
+                int lcd_width{}, lcd_height{}, dot_width{}, dot_height{}, dot_step_x{}, dot_step_y{};
+                std::vector<Uint32> lcd_pixels;
+                // The pixel sprite scaled to its dest size and modulated by ink_colour at each alpha from 0 to 255, dot_width * dot_height each.
+                std::vector<Uint32> dot_sprite, dot_patterns;
+                void SetupLcdTexture();
+
+                // Rows of the display RAM written since tick last looked, pages on TI. Set by the write handlers.
+                std::atomic<uint64_t> vram_dirty{~0ull};
+                void MarkRowDirty(size_t row) {
+                        uint64_t bit = 1ull << row;
+                        if (!(vram_dirty.load(std::memory_order_relaxed) & bit))
+                                vram_dirty.fetch_or(bit, std::memory_order_relaxed);
+                }
+                // Rows of screen_ink_alpha that have reached their targets, row 0 is the status bar.
+                bool row_settled[66]{};
+                // The registers the ink was last worked out from.
+                std::array<int, 9> ink_config{};
+                // Which call to tick each row of screen_ink_alpha last changed in, row 0 is the status bar.
+                uint32_t ink_version = 0, row_version[66]{};
+
+                /**
+                 * screen_ink_alpha belongs to the ink thread. Frame draws from a copy
+                 * of it, handed over through three of these without either thread
+                 * waiting for the other: PublishInk fills `ink_back` and swaps it
+                 * with `ink_ready`, and Frame swaps `ink_front` with `ink_ready` if
+                 * that is newer, marked by `ink_fresh`. Only rows whose version
+                 * differs are copied.
+                 */
+                struct InkFrame {
+                        float alpha[66 * 192];
+                        uint32_t row_version[66];
+                };
+                InkFrame ink_frames[3]{};
+                static constexpr int ink_fresh = 4;
+                int ink_back = 0, ink_front = 1;
+                std::atomic<int> ink_ready{2};
+                void PublishInk();
+                // The version of each row of ink_frames[ink_front] that lcd_texture holds.
+                uint32_t composited_version[66]{};
+                void CompositeLcd(const InkFrame& ink);
+
+                // Some models keep display buffers in RAM, which is allocated by BatteryBackedRAM.
+                uint8_t* ram_buffer{};
+                uint8_t* GetRamBuffer() {
+                        if (!ram_buffer) {
+                                auto ram = emulator.chipset.QueryInterface<IRam>();
+                                if (ram)
+                                        ram_buffer = (uint8_t*)ram->GetRam();
+                        }
+                        return ram_buffer;
+                }
+
         public:
                 Screen(Emulator& emu)
                         : Peripheral(emu) {
+                        // Ink fading is only for display.
+                        if (emulator.headless)
+                                return;
                         std::thread thd([&]() {
                                 while (1) {
-                                        tick();
+                                        bool busy = tick();
+                                        if (busy)
+                                                PublishInk();
 #ifdef __ANDROID__
                                         SDL_Delay(10);
+#else
+                                        // Nothing is fading, so the next write can wait a moment.
+                                        if (!busy)
+                                                SDL_Delay(1);
 #endif
                                 }
                         });
@@ -207,54 +286,116 @@ namespace casioemu {
                 void Uninitialise() override;
                 void Frame() override;
                 void Reset() override;
-                void tick() {
+                void Serialize(StateStream& state) override;
+                bool FramePending() override {
+                        return ink_ready.load() & ink_fresh;
+                }
+                void DeviceReset() override {
+                        interface_texture = emulator.GetInterfaceTexture();
+                        // SetupLcdTexture marks every row as not composited.
+                        SDL_DestroyTexture(lcd_texture);
+                        lcd_texture = nullptr;
+                }
+                std::vector<uint8_t> GetScreenBuffer() override {
+                        size_t size = hardware_id == HW_TI ? 192 * 9 : (N_ROW + 1) * ROW_SIZE;
+                        std::vector<uint8_t> buffer(screen_buffer, screen_buffer + size);
+                        if (screen_buffer1)
+                                buffer.insert(buffer.end(), screen_buffer1, screen_buffer1 + (N_ROW + 1) * ROW_SIZE);
+                        return buffer;
+                }
+                void* QueryInterface(const char* name) override {
+                        return strcmp(name, typeid(IScreen).name()) == 0 ? static_cast<IScreen*>(this) : nullptr;
+                }
+                uint8_t ScanReport(int n) {
+                        return ((n / (screen_scan_report_en ? screen_scan_report_op1 : 64)) % 2 ? 3 : 0) ^ (n % 64 == 0 ? 1 : (n % 64 == 32 ? 2 : 0));
+                }
+                /**
+                 * Fades screen_ink_alpha towards what the controller shows. Only rows
+                 * that were written, or haven't settled yet, are blended, and any
+                 * register change redoes all of them. Returns false if there was
+                 * nothing to do.
+                 */
+                bool tick() {
                         float ratio = 0;
                         if constexpr (hardware_id == HW_ES_PLUS)
                                 ratio = 1 - 1e-4;
                         else
                                 ratio = 1 - 5e-4;
 
+                        uint64_t vram = vram_dirty.exchange(0);
+                        ++ink_version;
+                        bool busy = false;
+                        auto row_done = [&](int row, float distance) {
+                                row_settled[row] = distance < ink_settle_distance;
+                                row_version[row] = ink_version;
+                                busy = true;
+                        };
+
 			if constexpr (hardware_id == HW_TI) {
 				ratio = 1 - 1e-4;
+				std::array<int, 9> config{ti_enabled, ti_contrast};
+				bool all = config != ink_config;
+				ink_config = config;
 				if (!ti_enabled) {
-					for (size_t i = 0; i < 65 * 192; i++) {
-						screen_ink_alpha[i] *= ratio;
-					}
-					return;
+					for (int iy = 0; iy < 65; ++iy)
+						if (all || !row_settled[iy])
+							row_done(iy, FadeInkRow(screen_ink_alpha + iy * 192, 192, ratio));
+					return busy;
 				}
-				if (!n_ram_buffer) //  || !emulator.chipset.ti_status_buf) //  || !emulator.chipset.ti_screen_buf
-					return;
+				if (!GetRamBuffer()) //  || !emulator.chipset.ti_status_buf) //  || !emulator.chipset.ti_screen_buf
+					return false;
 				float ink_alpha_on = (ti_contrast - 100) * 20.0;
 				float ink_alpha_off = std::clamp(ink_alpha_on * 0.1, 0.0, 255.0);
 				ink_alpha_on = std::clamp(ink_alpha_on, 0.0f, 255.0f);
-				uint8_t* screen_buffer = (uint8_t*)n_ram_buffer - casioemu::GetRamBaseAddr(hardware_id) + 0xE708;
+				uint8_t* screen_buffer = GetRamBuffer() - casioemu::GetRamBaseAddr(hardware_id) + 0xE708;
 				if (emulator.ModelDefinition.real_hardware) {
 					screen_buffer = this->screen_buffer;
 				}
-				for (int ix = 0; ix < 192; ++ix) {
-					for (int iy = 0; iy < 64; ++iy) {
-						uint32_t i = (ix << 6) | iy;
-						int bIndx = (i >> 3);
-						int subIndx = (i & 7);
-						int mask = (1 << subIndx);
-						bool on = (screen_buffer[bIndx] & mask) != 0;
-						auto& data = screen_ink_alpha[(iy * 192 + 192) + ix];
-						data = data * ratio + (on ? ink_alpha_on : ink_alpha_off) * (1 - ratio);
+				else {
+					// Writes to the display in RAM aren't seen.
+					all = true;
+				}
+				// Each column of 64 dots is 8 bytes, so every 8x8 block is transposed into rows first.
+				float target[4] = {ink_alpha_off, ink_alpha_on, ink_alpha_off, ink_alpha_on};
+				for (int block = 0; block < 8; ++block) {
+					bool blend = all || (vram >> block & 1);
+					for (int r = 0; r < 8 && !blend; ++r)
+						blend = !row_settled[block * 8 + r + 1];
+					if (!blend)
+						continue;
+					uint8_t rows[8][24];
+					for (int ix = 0; ix < 24; ++ix) {
+						uint8_t columns[8], block_rows[8];
+						for (int j = 0; j < 8; ++j)
+							columns[j] = screen_buffer[(ix * 8 + j) * 8 + block];
+						TransposeInkBlock(columns, block_rows);
+						for (int r = 0; r < 8; ++r)
+							rows[r][ix] = block_rows[r];
+					}
+					for (int r = 0; r < 8; ++r) {
+						int iy2 = block * 8 + r + 1;
+						row_done(iy2, BlendInkRow(screen_ink_alpha + iy2 * 192, rows[r], nullptr, 24, target, ratio, false));
 					}
 				}
-				screen_buffer = (uint8_t*)n_ram_buffer - casioemu::GetRamBaseAddr(hardware_id) + 0xe5d4;
+				if (!all && !(vram >> 8 & 1) && row_settled[0])
+					return busy;
+				screen_buffer = GetRamBuffer() - casioemu::GetRamBaseAddr(hardware_id) + 0xe5d4;
 				if (emulator.ModelDefinition.real_hardware) {
 					screen_buffer = this->screen_buffer + 8 * 192;
 				}
 				int x = 0;
+				float distance = 0;
 				for (int ix = 1; ix != SPR_MAX; ++ix) {
 					auto off = sprite_bitmap[ix].offset;
 					auto& data = screen_ink_alpha[x];
-					data = data * ratio + ((screen_buffer[off] & sprite_bitmap[ix].mask) ? ink_alpha_on : ink_alpha_off) * (1 - ratio);
+					float ink_alpha = (screen_buffer[off] & sprite_bitmap[ix].mask) ? ink_alpha_on : ink_alpha_off;
+					data = data * ratio + ink_alpha * (1 - ratio);
+					distance = std::max(distance, std::abs(ink_alpha - data));
 					x++;
 				}
+				row_done(0, distance);
 
-                                return;
+                                return busy;
                         }
 
 #ifdef __ANDROID__
@@ -264,12 +405,29 @@ namespace casioemu {
                         if (screen_refresh_rate < screen_flashing_threshold && !enable_screen_fading)
                                 ;
                         else {
-                                int n = update_screen_scan_alpha(screen_scan_alpha, SDL_GetTicks64(), screen_refresh_rate);
-                                screen_scan_report = ((n / (screen_scan_report_en ? screen_scan_report_op1 : 64)) % 2 ? 3 : 0) ^ (n % 64 == 0 ? 1 : (n % 64 == 32 ? 2 : 0));
+                                int n = update_screen_scan_alpha(screen_scan_alpha, emulator.GetTicks(), screen_refresh_rate);
+                                // In deterministic mode this thread leaves the registers alone, the report is worked out when read.
+                                if (!emulator.deterministic)
+                                        screen_scan_report = ScanReport(n);
                         }
-                        if (screen_refresh_rate < 6) {
+                        if (screen_refresh_rate < 6 && !emulator.deterministic) {
                                 screen_refresh_rate = 6;
                         }
+                        std::array<int, 9> config{screen_mode, screen_range, screen_offset, screen_contrast, screen_brightness, screen_refresh_rate, enabled_2, screen_buffer_select};
+                        bool all = config != ink_config;
+                        ink_config = config;
+                        // Writes to a display in RAM aren't seen, and a flashing scan changes every row all the time.
+                        if (screen_buffer_select != 0 || screen_refresh_rate >= screen_flashing_threshold)
+                                all = true;
+                        auto row_written = [&](size_t row) {
+                                return all || row >= 64 || (vram >> row & 1);
+                        };
+                        auto fade_rows = [&](int first, int last) {
+                                for (int iy = first; iy != last; ++iy)
+                                        if (all || !row_settled[iy])
+                                                row_done(iy, FadeInkRow(screen_ink_alpha + iy * 192, 192, ratio));
+                        };
+
                         auto sb = screen_brightness;
                         if (sb < 3) {
                                 sb = 3;
@@ -304,7 +462,7 @@ namespace casioemu {
                                 screen_buffer1 = this->screen_buffer1;
                         }
                         if (screen_buffer_select != 0) {
-                                screen_buffer = (uint8_t*)n_ram_buffer - casioemu::GetRamBaseAddr(hardware_id) + casioemu::GetScreenBufferOffset(emulator.hardware_id, screen_buffer_select);
+                                screen_buffer = GetRamBuffer() - casioemu::GetRamBaseAddr(hardware_id) + casioemu::GetScreenBufferOffset(emulator.hardware_id, screen_buffer_select);
                                 if (hardware_id == HW_CLASSWIZ_II) {
                                         screen_buffer1 = screen_buffer + 0x600;
                                 }
@@ -352,8 +510,10 @@ namespace casioemu {
                                 ink_alpha_on *= (4 / rng1);
                                 int rng = rng1 * 8;
 
-                                if (enable_status) {
+                                // The status bar can be on any row, so any write redoes it.
+                                if (enable_status && (all || vram || !row_settled[0])) {
                                         int ink_alpha = ink_alpha_off;
+                                        float distance = 0;
                                         if constexpr (hardware_id == HW_CLASSWIZ_II) {
                                                 int x = 0;
                                                 for (int ix = 1; ix != SPR_MAX; ++ix) {
@@ -366,6 +526,7 @@ namespace casioemu {
                                                         if (screen_refresh_rate >= screen_flashing_threshold)
                                                                 ink_alpha *= screen_scan_alpha[0];
                                                         screen_ink_alpha[x] = screen_ink_alpha[x] * ratio + ink_alpha * (1 - ratio);
+                                                        distance = std::max(distance, std::abs(ink_alpha - screen_ink_alpha[x]));
                                                         x++;
                                                 }
                                         }
@@ -380,128 +541,71 @@ namespace casioemu {
                                                         if (screen_refresh_rate >= screen_flashing_threshold)
                                                                 ink_alpha *= screen_scan_alpha[0];
                                                         screen_ink_alpha[x] = screen_ink_alpha[x] * ratio + ink_alpha * (1 - ratio);
+                                                        distance = std::max(distance, std::abs(ink_alpha - screen_ink_alpha[x]));
                                                         x++;
                                                 }
                                         }
+                                        row_done(0, distance);
                                 }
-                                else {
-                                        if constexpr (hardware_id == HW_CLASSWIZ_II) {
-                                                for (size_t i = 0; i < 192; i++) {
-                                                        screen_ink_alpha[i] *= ratio;
-                                                }
-                                        }
-                                        else {
-                                                for (size_t i = 0; i < 192; i++) {
-                                                        screen_ink_alpha[i] *= ratio;
-                                                }
-                                        }
+                                else if (!enable_status) {
+                                        fade_rows(0, 1);
                                 }
 
                                 if (enable_dotmatrix) {
-                                        static constexpr auto SPR_PIXEL = 0;
-                                        SDL_Rect dest = Screen<hardware_id>::sprite_info[SPR_PIXEL].dest;
                                         int ink_alpha = ink_alpha_off;
                                         if (mode_6) {
                                                 ink_alpha_on = ink_alpha_off /= 2.55;
                                         }
-                                        if constexpr (hardware_id == HW_CLASSWIZ_II) {
-                                                for (int iy2 = 1; iy2 != (N_ROW + 1); ++iy2) {
-                                                        int iy = (iy2 + screen_offset) % (N_ROW + 1);
-                                                        bool clear = 0;
-                                                        if (iy2 >= rng && iy2 < 32)
-                                                                clear = 1;
-                                                        if (iy2 >= 32) {
-                                                                if (iy2 <= 32 + rng) {
-                                                                        iy = (iy2 - 32 + rng + screen_offset) % (N_ROW + 1);
-                                                                }
-                                                                else {
-                                                                        clear = 1;
-                                                                }
+                                        for (int iy2 = 1; iy2 != (N_ROW + 1); ++iy2) {
+                                                int iy = (iy2 + screen_offset) % (N_ROW + 1);
+                                                bool clear = 0;
+                                                if (iy2 >= rng && iy2 < 32)
+                                                        clear = 1;
+                                                if (iy2 >= 32) {
+                                                        if (iy2 <= 32 + rng) {
+                                                                iy = (iy2 - 32 + rng + screen_offset) % (N_ROW + 1);
                                                         }
-                                                        dest.x = sprite_info[SPR_PIXEL].dest.x;
-                                                        dest.y = sprite_info[SPR_PIXEL].dest.y + (iy2 - 1) * sprite_info[SPR_PIXEL].src.h;
-                                                        int x = 0;
-                                                        for (int ix = 0; ix != ROW_SIZE_DISP; ++ix) {
-                                                                auto index = (flip_screen_v ? N_ROW - iy : iy) * row_size + ix;
-                                                                for (uint8_t mask = 0x80; mask; mask >>= 1, dest.x += sprite_info[SPR_PIXEL].src.w) {
-                                                                        ink_alpha = ink_alpha_off;
-                                                                        if (!clear_dots && screen_buffer[index] & mask)
-                                                                                ink_alpha += (ink_alpha_on - ink_alpha_off) * 0.2;
-                                                                        if (!clear_dots && screen_buffer1[index] & mask)
-                                                                                ink_alpha += (ink_alpha_on - ink_alpha_off) * 0.8;
-                                                                        if (screen_refresh_rate >= screen_flashing_threshold)
-                                                                                ink_alpha *= screen_scan_alpha[iy];
-                                                                        if (clear)
-                                                                                ink_alpha = 0;
-                                                                        float& dat = screen_ink_alpha[(flip_screen_h ? (191 - x) : x) + iy2 * 192];
-                                                                        dat = dat * ratio + ink_alpha * (1 - ratio);
-                                                                        x++;
-                                                                }
+                                                        else {
+                                                                clear = 1;
                                                         }
                                                 }
-                                        }
-                                        else {
-                                                for (int iy2 = 1; iy2 != (N_ROW + 1); ++iy2) {
-                                                        int iy = (iy2 + screen_offset) % (N_ROW + 1);
-                                                        bool clear = 0;
-                                                        if (iy2 >= rng && iy2 < 32)
-                                                                clear = 1;
-                                                        if (iy2 >= 32) {
-                                                                if (iy2 <= 32 + rng) {
-                                                                        iy = (iy2 - 32 + rng + screen_offset) % (N_ROW + 1);
-                                                                }
-                                                                else {
-                                                                        clear = 1;
-                                                                }
+                                                size_t source_row = hardware_id == HW_CLASSWIZ_II ? (flip_screen_v ? N_ROW - iy : iy) : (flip_screen_v ? N_ROW + 1 - iy : iy);
+                                                if (!row_written(source_row) && row_settled[iy2])
+                                                        continue;
+                                                // The alpha of each grey level on this row, worked out in ints as the status bar above.
+                                                float target[4]{};
+                                                for (int level = 0; level != 4 && !clear; ++level) {
+                                                        if constexpr (hardware_id == HW_CLASSWIZ_II) {
+                                                                ink_alpha = ink_alpha_off;
+                                                                if (!clear_dots && level & 1)
+                                                                        ink_alpha += (ink_alpha_on - ink_alpha_off) * 0.2;
+                                                                if (!clear_dots && level & 2)
+                                                                        ink_alpha += (ink_alpha_on - ink_alpha_off) * 0.8;
                                                         }
-                                                        dest.x = sprite_info[SPR_PIXEL].dest.x;
-                                                        dest.y = sprite_info[SPR_PIXEL].dest.y + (iy2 - 1) * sprite_info[SPR_PIXEL].src.h;
-                                                        int x = 0;
-                                                        for (int ix = 0; ix != ROW_SIZE_DISP; ++ix) {
-                                                                auto index = (flip_screen_v ? N_ROW + 1 - iy : iy) * row_size + ix;
-                                                                for (uint8_t mask = 0x80; mask; mask >>= 1, dest.x += sprite_info[SPR_PIXEL].src.w) {
-                                                                        if (screen_buffer[index] & mask)
-                                                                                ink_alpha = ink_alpha_on;
-                                                                        else
-                                                                                ink_alpha = ink_alpha_off;
-                                                                        if (screen_refresh_rate >= screen_flashing_threshold)
-                                                                                ink_alpha *= screen_scan_alpha[iy];
-                                                                        if (clear)
-                                                                                ink_alpha = 0;
-                                                                        float& dat = screen_ink_alpha[(flip_screen_h ? (191 - x) : x) + iy2 * 192];
-                                                                        dat = dat * ratio + ink_alpha * (1 - ratio);
-                                                                        x++;
-                                                                }
+                                                        else {
+                                                                ink_alpha = level & 1 ? ink_alpha_on : ink_alpha_off;
                                                         }
+                                                        if (screen_refresh_rate >= screen_flashing_threshold)
+                                                                ink_alpha *= screen_scan_alpha[iy];
+                                                        target[level] = ink_alpha;
                                                 }
+                                                // Mirrored rows are right aligned, dot x goes to 191 - x.
+                                                float* row = screen_ink_alpha + iy2 * 192 + (flip_screen_h ? 192 - ROW_SIZE_DISP * 8 : 0);
+                                                auto index = source_row * row_size;
+                                                if constexpr (hardware_id == HW_CLASSWIZ_II)
+                                                        row_done(iy2, BlendInkRow(row, screen_buffer + index, screen_buffer1 + index, ROW_SIZE_DISP, target, ratio, flip_screen_h));
+                                                else
+                                                        row_done(iy2, BlendInkRow(row, screen_buffer + index, nullptr, ROW_SIZE_DISP, target, ratio, flip_screen_h));
                                         }
                                 }
                                 else {
-                                        if constexpr (hardware_id == HW_CLASSWIZ_II) {
-                                                for (size_t i = 192; i < 64 * 192; i++) {
-                                                        screen_ink_alpha[i] *= ratio;
-                                                }
-                                        }
-                                        else {
-                                                for (size_t i = 192; i < 64 * 192; i++) {
-                                                        screen_ink_alpha[i] *= ratio;
-                                                }
-                                        }
+                                        fade_rows(1, 64);
                                 }
                         }
-                        return;
+                        return busy;
                 clean_scr:
-                        if constexpr (hardware_id == HW_CLASSWIZ_II) {
-                                for (size_t i = 0; i < 64 * 192; i++) {
-                                        screen_ink_alpha[i] *= ratio;
-                                }
-                        }
-                        else {
-                                for (size_t i = 0; i < 64 * 192; i++) {
-                                        screen_ink_alpha[i] *= ratio;
-                                }
-                        }
-                        return;
+                        fade_rows(0, 64);
+                        return busy;
                 }
         };
 
@@ -652,7 +756,7 @@ namespace casioemu {
 			}
 			else {
 				screen_buffer = new uint8_t[(N_ROW + 1) * ROW_SIZE];
-				fillRandomData(screen_buffer, (N_ROW + 1) * ROW_SIZE);
+				fillRandomData(screen_buffer, (N_ROW + 1) * ROW_SIZE, emulator.GetRandomSeed());
 			}
 			if constexpr (hardware_id == HW_CLASSWIZ || hardware_id == HW_CLASSWIZ_II) {
 				region_power.Setup(
@@ -673,7 +777,7 @@ namespace casioemu {
 			}
 			if constexpr (hardware_id == HW_CLASSWIZ_II) {
 				screen_buffer1 = new uint8_t[(N_ROW + 1) * ROW_SIZE];
-				fillRandomData(screen_buffer1, (N_ROW + 1) * ROW_SIZE);
+				fillRandomData(screen_buffer1, (N_ROW + 1) * ROW_SIZE, emulator.GetRandomSeed());
 			}
 			inited = true;
 		}
@@ -695,6 +799,8 @@ namespace casioemu {
 							std::cout << std::dec << off - 192 * 8 << " <- 0x" << std::hex << ti_port7 << "\n";
 						}
 						screen_buffer[off] = ti_port7;
+						// tick reads the buffer as 8 bytes per column, and the status bar from 8 * 192 on.
+						MarkRowDirty(off >= 8 * 192 ? 8 : off % 8);
 						ti_col++;
 						if (ti_col >= 192) {
 							ti_col = 0;
@@ -785,7 +891,8 @@ namespace casioemu {
 						return;
 
                                         auto this_obj = (Screen*)region->userdata;
-                                        this_obj->screen_buffer[offset] = data; },
+                                        this_obj->screen_buffer[offset] = data;
+                                        this_obj->MarkRowDirty(offset / ROW_SIZE); },
                                         emulator);
                         }
                         else {
@@ -808,6 +915,7 @@ namespace casioemu {
                                                         return;
 
 						auto this_obj = (Screen*)region->userdata;
+						this_obj->MarkRowDirty(offset / ROW_SIZE);
 						if (!(this_obj->screen_mode & 0x40)) {
 							this_obj->screen_buffer1[offset] = this_obj->screen_buffer[offset] = data;
 							return;
@@ -853,6 +961,7 @@ namespace casioemu {
 
                                                         auto this_obj = (Screen*)region->userdata;
                                                         this_obj->screen_buffer1[offset] = data;
+                                                        this_obj->MarkRowDirty(offset / ROW_SIZE);
                                                 },
                                                 emulator);
                                 }
@@ -964,7 +1073,14 @@ n为行扫描计数，[0xF03B] = ( ( n / ( [0xF036] == 0 ? 64 : [0xF035] ) ) % 2
                                 region_scan_report_en.Setup(0xF036, 1, "Screen/ScanReportOptionEnable", &screen_scan_report_en, MMURegion::DefaultRead<uint8_t, 0b1001>,
                                         MMURegion::DefaultWrite<uint8_t, 0b1001>, emulator);
 
-                                region_scan_report.Setup(0xF03B, 1, "Screen/ScanReport", &screen_scan_report, MMURegion::DefaultRead<uint8_t, 0x3>,
+                                region_scan_report.Setup(
+                                        0xF03B, 1, "Screen/ScanReport", this,
+                                        [](MMURegion* region, size_t) {
+                                                Screen* screen = (Screen*)region->userdata;
+                                                if (screen->emulator.deterministic)
+                                                        screen->screen_scan_report = screen->ScanReport(screen_scan_line(screen->emulator.GetTicks(), screen->screen_refresh_rate));
+                                                return (uint8_t)(screen->screen_scan_report & 0x3);
+                                        },
                                         MMURegion::IgnoreWrite, emulator);
                         }
                         else {
@@ -990,9 +1106,9 @@ n为行扫描计数，[0xF03B] = ( ( n / ( [0xF036] == 0 ? 64 : [0xF035] ) ) % 2
 
         template <HardwareId hardware_id>
         void Screen<hardware_id>::Uninitialise() {
-                fillRandomData(screen_buffer, (N_ROW + 1) * ROW_SIZE);
+                fillRandomData(screen_buffer, (N_ROW + 1) * ROW_SIZE, emulator.GetRandomSeed());
                 if constexpr (hardware_id == HW_CLASSWIZ_II) {
-                        fillRandomData(screen_buffer1, (N_ROW + 1) * ROW_SIZE);
+                        fillRandomData(screen_buffer1, (N_ROW + 1) * ROW_SIZE, emulator.GetRandomSeed());
                 }
                 if constexpr (hardware_id != HW_CLASSWIZ_II) {
                         region_buffer.Kill();
@@ -1091,9 +1207,13 @@ n为行扫描计数，[0xF03B] = ( ( n / ( [0xF036] == 0 ? 64 : [0xF035] ) ) % 2
                     screenSurface->pixels, screenSurface->pitch) == 0) {
                     // Save the surface as a PNG file using SDL_image
                     auto str = filename.str();
+        #ifndef CASIOEMU_HEADLESS
                     if (IMG_SavePNG(screenSurface, str.c_str()) != 0) {
                         SDL_Log("Error saving screenshot: %s", IMG_GetError());
                     }
+        #else
+                    SDL_Log("Error saving screenshot: built without SDL_image");
+        #endif
                 } else {
                     SDL_Log("Error capturing screen pixels: %s", SDL_GetError());
                 }
@@ -1175,7 +1295,140 @@ n为行扫描计数，[0xF03B] = ( ( n / ( [0xF036] == 0 ? 64 : [0xF035] ) ) % 2
                 int captureHeight = maxY - minY;
                 return {captureWidth, captureHeight};
         }
-        // Function to collect all sprite and pixel rectangles
+        // What SDL_SetTextureColorMod and SDL_SetTextureAlphaMod do to an ARGB8888 pixel.
+        inline Uint32 ModulateDot(Uint32 pixel, int r, int g, int b, int a) {
+                Uint32 pa = (pixel >> 24) * a / 255;
+                Uint32 pr = ((pixel >> 16) & 0xFF) * r / 255;
+                Uint32 pg = ((pixel >> 8) & 0xFF) * g / 255;
+                Uint32 pb = (pixel & 0xFF) * b / 255;
+                return pa << 24 | pr << 16 | pg << 8 | pb;
+        }
+
+        // Source-over for straight alpha, so that drawing the result is the same as drawing `under` and then `over`.
+        inline Uint32 BlendDot(Uint32 over, Uint32 under) {
+                Uint32 sa = over >> 24, da = under >> 24;
+                if (sa == 255 || !da)
+                        return over;
+                if (!sa)
+                        return under;
+                da = da * (255 - sa) / 255;
+                Uint32 oa = sa + da, out = oa << 24;
+                for (int shift = 0; shift != 24; shift += 8)
+                        out |= (((over >> shift) & 0xFF) * sa + ((under >> shift) & 0xFF) * da) / oa << shift;
+                return out;
+        }
+
+        template <HardwareId hardware_id>
+        void Screen<hardware_id>::SetupLcdTexture() {
+                // As the dots used to be drawn one by one: at the sprite's dest size, spaced by its src size.
+                static constexpr auto SPR_PIXEL = 0;
+                SDL_Rect src = sprite_info[SPR_PIXEL].src;
+                SDL_Rect dest = sprite_info[SPR_PIXEL].dest;
+                dot_width = dest.w;
+                dot_height = dest.h;
+                dot_step_x = src.w;
+                dot_step_y = src.h;
+                lcd_width = (ROW_SIZE_DISP * 8 - 1) * dot_step_x + dot_width;
+                lcd_height = (N_ROW - 1) * dot_step_y + dot_height;
+
+                SDL_Surface* interface = SDL_ConvertSurfaceFormat(emulator.interface_surface, SDL_PIXELFORMAT_ARGB8888, 0);
+                if (!interface)
+                        PANIC("SDL_ConvertSurfaceFormat failed: %s\n", SDL_GetError());
+                // Nearest neighbour, like SDL_RenderCopy at the default scale quality.
+                dot_sprite.resize(dot_width * dot_height);
+                for (int y = 0; y != dot_height; ++y)
+                        for (int x = 0; x != dot_width; ++x)
+                                dot_sprite[y * dot_width + x] = *(Uint32*)((uint8_t*)interface->pixels + (src.y + y * src.h / dot_height) * interface->pitch + (src.x + x * src.w / dot_width) * sizeof(Uint32));
+                SDL_FreeSurface(interface);
+
+                dot_patterns.resize(256 * dot_sprite.size());
+                for (int alpha = 0; alpha != 256; ++alpha)
+                        for (size_t ix = 0; ix != dot_sprite.size(); ++ix)
+                                dot_patterns[alpha * dot_sprite.size() + ix] = ModulateDot(dot_sprite[ix], ink_colour.r, ink_colour.g, ink_colour.b, alpha);
+
+                lcd_pixels.assign(lcd_width * lcd_height, 0);
+                std::fill(std::begin(composited_version), std::end(composited_version), UINT32_MAX);
+                // Freed along with the renderer.
+                lcd_texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, lcd_width, lcd_height);
+                if (!lcd_texture)
+                        PANIC("SDL_CreateTexture failed: %s\n", SDL_GetError());
+                SDL_SetTextureBlendMode(lcd_texture, SDL_BLENDMODE_BLEND);
+        }
+
+        template <HardwareId hardware_id>
+        void Screen<hardware_id>::PublishInk() {
+                auto& frame = ink_frames[ink_back];
+                for (int row = 0; row != 66; ++row) {
+                        if (frame.row_version[row] == row_version[row])
+                                continue;
+                        memcpy(frame.alpha + row * 192, screen_ink_alpha + row * 192, 192 * sizeof(float));
+                        frame.row_version[row] = row_version[row];
+                }
+                // Whichever copy comes back is one Frame is done with, or one it never took.
+                ink_back = ink_ready.exchange(ink_back | ink_fresh) & ~ink_fresh;
+                emulator.frame_pacer.RequestFrame();
+        }
+
+        template <HardwareId hardware_id>
+        void Screen<hardware_id>::CompositeLcd(const InkFrame& ink) {
+                bool changed[66]{};
+                int first = N_ROW, last = -1;
+                for (int iy = 0; iy != N_ROW; ++iy) {
+                        if (composited_version[iy + 1] == ink.row_version[iy + 1])
+                                continue;
+                        composited_version[iy + 1] = ink.row_version[iy + 1];
+                        changed[iy] = true;
+                        first = std::min(first, iy);
+                        last = iy;
+                }
+                if (last < 0)
+                        return;
+
+                // The lines of lcd_pixels the changed rows cover.
+                int top = first * dot_step_y, bottom = last * dot_step_y + dot_height;
+                // Dots larger than their spacing overlap their neighbours, which are then drawn again over a cleared band, in the order Frame used to draw them.
+                bool overlap = dot_width > dot_step_x || dot_height > dot_step_y;
+                if (overlap)
+                        std::fill(&lcd_pixels[top * lcd_width], &lcd_pixels[bottom * lcd_width], 0);
+
+                size_t dot_size = dot_sprite.size();
+                std::vector<Uint32> dark(dot_size);
+                for (int iy = 0; iy != N_ROW; ++iy) {
+                        int dot_top = iy * dot_step_y;
+                        if (overlap ? dot_top >= bottom || dot_top + dot_height <= top : !changed[iy])
+                                continue;
+                        const float* alpha = ink.alpha + (iy + 1) * 192;
+                        int y0 = std::max(top, dot_top) - dot_top, y1 = std::min(bottom, dot_top + dot_height) - dot_top;
+                        for (int ix = 0; ix != ROW_SIZE_DISP * 8; ++ix) {
+                                const Uint32* dot;
+                                if (alpha[ix] > 255) {
+                                        // Past full ink the dot darkens instead, as Frame used to do through the colour mod.
+                                        int r = std::max(0, ink_colour.r - (int)(alpha[ix] - 255));
+                                        int g = std::max(0, ink_colour.g - (int)((alpha[ix] - 255) * 0.8));
+                                        int b = std::max(0, ink_colour.b - (int)((alpha[ix] - 255) * 0.1));
+                                        for (size_t px = 0; px != dot_size; ++px)
+                                                dark[px] = ModulateDot(dot_sprite[px], r, g, b, 255);
+                                        dot = dark.data();
+                                }
+                                else {
+                                        dot = &dot_patterns[std::clamp((int)alpha[ix], 0, 255) * dot_size];
+                                }
+                                Uint32* out = &lcd_pixels[dot_top * lcd_width + ix * dot_step_x];
+                                for (int y = y0; y != y1; ++y) {
+                                        if (!overlap) {
+                                                memcpy(out + y * lcd_width, dot + y * dot_width, dot_width * sizeof(Uint32));
+                                                continue;
+                                        }
+                                        for (int x = 0; x != dot_width; ++x)
+                                                out[y * lcd_width + x] = BlendDot(dot[y * dot_width + x], out[y * lcd_width + x]);
+                                }
+                        }
+                }
+                // One upload covering every changed row.
+                SDL_Rect rect{0, top, lcd_width, bottom - top};
+                SDL_UpdateTexture(lcd_texture, &rect, &lcd_pixels[top * lcd_width], lcd_width * sizeof(Uint32));
+        }
+
         template <HardwareId hardware_id>
         void Screen<hardware_id>::Frame() {
                 int x = 0;
@@ -1188,13 +1441,19 @@ n为行扫描计数，[0xF03B] = ( ( n / ( [0xF036] == 0 ? 64 : [0xF035] ) ) % 2
 			SDL_SetTextureColorMod(interface_texture, ink_colour.r, ink_colour.g, ink_colour.b);
 		}
 
+                // Take the newest ink tick has published, if Frame hasn't seen it yet.
+                if (ink_ready.load() & ink_fresh)
+                        ink_front = ink_ready.exchange(ink_front) & ~ink_fresh;
+                const InkFrame& ink = ink_frames[ink_front];
+
                 // Store all the rendering rectangles (sprites and pixel areas)
                 std::vector<SDL_Rect> spriteRects;
                 std::vector<SDL_Rect> pixelRects;
 
                 // Set texture transparency and copy sprites as before
                 for (int ix = 1; ix != SPR_MAX; ++ix) {
-                        SDL_SetTextureAlphaMod(interface_texture, Uint8(std::clamp((int)screen_ink_alpha[x], 0, 255)));
+                        // The status bar is cheap enough to draw every time.
+                        SDL_SetTextureAlphaMod(interface_texture, Uint8(std::clamp((int)ink.alpha[x], 0, 255)));
                         x++;
 						SDL_Rect tmp1 = sprite_info[ix].src;
 						SDL_Rect tmp2 = sprite_info[ix].dest;
@@ -1204,33 +1463,12 @@ n为行扫描计数，[0xF03B] = ( ( n / ( [0xF036] == 0 ? 64 : [0xF035] ) ) % 2
                 }
 
                 static constexpr auto SPR_PIXEL = 0;
-                SDL_Rect dest = Screen<hardware_id>::sprite_info[SPR_PIXEL].dest;
-                for (int iy2 = 1; iy2 != (N_ROW + 1); ++iy2) {
-                        int x = 0;
-                        dest.x = sprite_info[SPR_PIXEL].dest.x;
-                        dest.y = sprite_info[SPR_PIXEL].dest.y + (iy2 - 1) * sprite_info[SPR_PIXEL].src.h;
-                        for (int ix = 0; ix != ROW_SIZE_DISP; ++ix) {
-                                for (uint8_t mask = 0x80; mask; mask >>= 1, dest.x += sprite_info[SPR_PIXEL].src.w) {
-                                        // Calculate pixel-specific colors and modify texture
-                                        if (screen_ink_alpha[x + iy2 * 192] > 255) {
-                                                SDL_SetTextureColorMod(interface_texture,
-                                                        std::max(0, ink_colour.r - (int)(screen_ink_alpha[x + iy2 * 192] - 255)),
-                                                        std::max(0, ink_colour.g - (int)((screen_ink_alpha[x + iy2 * 192] - 255) * 0.8)),
-                                                        std::max(0, ink_colour.b - (int)((screen_ink_alpha[x + iy2 * 192] - 255) * 0.1)));
-                                                SDL_SetTextureAlphaMod(interface_texture, 255);
-                                        }
-                                        else {
-                                                SDL_SetTextureColorMod(interface_texture, ink_colour.r, ink_colour.g, ink_colour.b);
-                                                SDL_SetTextureAlphaMod(interface_texture, Uint8(std::clamp((int)screen_ink_alpha[x + iy2 * 192], 0, 255)));
-                                        }
-                                        x++;
-										SDL_Rect tmp1 = sprite_info[SPR_PIXEL].src;
-                                        SDL_RenderCopy(renderer, interface_texture, &tmp1, &dest);
-                                        // Store the pixel rectangle for later
-                                        pixelRects.push_back(dest);
-                                }
-                        }
-                }
+                if (!lcd_texture)
+                        SetupLcdTexture();
+                CompositeLcd(ink);
+                SDL_Rect dest{sprite_info[SPR_PIXEL].dest.x, sprite_info[SPR_PIXEL].dest.y, lcd_width, lcd_height};
+                SDL_RenderCopy(renderer, lcd_texture, nullptr, &dest);
+                pixelRects.push_back(dest);
 
                 // If screenshot is requested, capture only the rendered screen region
                 if (emulator.screenshot_requested.load()) {
@@ -1255,6 +1493,23 @@ n为行扫描计数，[0xF03B] = ( ( n / ( [0xF036] == 0 ? 64 : [0xF035] ) ) % 2
         void Screen<hardware_id>::Reset() {
         }
 
+        template <HardwareId hardware_id>
+        void Screen<hardware_id>::Serialize(StateStream& state) {
+                // Ink fading and textures are derived from these on the render thread, so they are left out.
+                if constexpr (hardware_id == HW_TI)
+                        state.Bytes(screen_buffer, 192 * 9);
+                else
+                        state.Bytes(screen_buffer, (N_ROW + 1) * ROW_SIZE);
+                if (screen_buffer1)
+                        state.Bytes(screen_buffer1, (N_ROW + 1) * ROW_SIZE);
+                state(screen_contrast, screen_brightness, screen_scan_report_op1, screen_mode, screen_range, screen_select, screen_offset, screen_refresh_rate, screen_scan_report);
+                state(screen_power, screen_scan_report_en, unk_f034);
+                state(ti_contrast, ti_port_status, ti_enabled, ti_a0, ti_rw, ti_col, ti_page, ti_port7, ti_port5);
+                // The display RAM was replaced behind the write handlers' back.
+                if (state.Loading())
+                        vram_dirty = ~0ull;
+        }
+
         Peripheral* CreateScreen(Emulator& emulator) {
                 switch (emulator.hardware_id) {
                 case HW_FX_5800P:
@@ -1,4 +1,21 @@
 ﻿#pragma once
+#include <cstdint>
+#include <vector>
 namespace casioemu {
 	class Peripheral* CreateScreen(class Emulator& emulator);
-}
\ No newline at end of file
+}
+// * Display tuning, adjusted from the hardware controller window.
+extern int screen_flashing_threshold;
+extern float screen_fading_blending_coefficient;
+extern bool enable_screen_fading;
+extern float screen_flashing_brightness_coeff;
+extern int screen_buffer_select;
+class IScreen {
+public:
+	// * The display RAM as the ROM wrote it, followed by the second plane on models that have one.
+	virtual std::vector<uint8_t> GetScreenBuffer() = 0;
+	// * Whether the ink has changed since the last Frame. If not, the window needn't be presented again.
+	virtual bool FramePending() = 0;
+	// * The renderer lost its textures (SDL_RENDER_DEVICE_RESET), Frame recreates them and composites the whole LCD again.
+	virtual void DeviceReset() = 0;
+};
\ No newline at end of file
@@ -1,5 +1,6 @@
 ﻿#include "Spi.h"
 #include "Peripheral.hpp"
+#include "SaveState.hpp"
 #include <MMURegion.hpp>
 #include <coroutine>
 #include <future>
@@ -21,6 +22,7 @@ namespace casioemu {
 		using Peripheral::Peripheral;
 
 		void Initialise() {
+			clock_type = CLOCK_SYSCLK;
 			reg_SIO0BUF.Setup(0xF280, 1, "Spi/SIO0BUF", this, SpiRead, SpiWrite, emulator);
 			reg_SIO0CON.Setup(0xF282, 1, "Spi/SIO0CON", this, SpiRead, SpiWrite, emulator);
 			reg_SIO0MOD.Setup(0xF284, 2, "Spi/SIO0MOD", this, SpiRead, SpiWrite, emulator);
@@ -103,6 +105,14 @@ namespace casioemu {
 				}
 			}
 		}
+
+		void Serialize(StateStream& state) override {
+			state(buffer, control, mode0, mode1);
+			std::vector<uint8_t> rx(rx_queue.begin(), rx_queue.end());
+			state(rx);
+			if (state.Loading())
+				rx_queue.assign(rx.begin(), rx.end());
+		}
 	};
 
 	Peripheral* CreateSpi(Emulator& emu) {
@@ -4,6 +4,7 @@
 #include "Chipset/MMU.hpp"
 #include "Emulator.hpp"
 #include "Logger.hpp"
+#include "SaveState.hpp"
 
 namespace casioemu {
 	class StandbyControl : public Peripheral {
@@ -16,6 +17,7 @@ namespace casioemu {
 
 		void Initialise();
 		void Reset();
+		void Serialize(StateStream& state);
 	};
 	void StandbyControl::Initialise() {
 		region_stpacp.Setup(
@@ -78,6 +80,11 @@ namespace casioemu {
 		stop_acceptor_enabled = false;
 		shutdown_acceptor_enabled = false;
 	}
+
+	void StandbyControl::Serialize(StateStream& state) {
+		state(stpacp_last, F312_last, stop_acceptor_enabled, shutdown_acceptor_enabled);
+	}
+
 	Peripheral* CreateStbCtrl(Emulator& emu) {
 		return new StandbyControl(emu);
 	}
@@ -4,6 +4,7 @@
 #include "Chipset/MMU.hpp"
 #include "Emulator.hpp"
 #include "Logger.hpp"
+#include "SaveState.hpp"
 
 #include <cmath>
 
@@ -30,6 +31,7 @@ namespace casioemu {
 		void Reset();
 		void Tick();
 		void Uninitialise();
+		void Serialize(StateStream& state) override;
 	};
 	void Timer::Initialise() {
 		if (enabled)
@@ -140,6 +142,14 @@ namespace casioemu {
 		region_F024.Kill();
 		region_control.Kill();
 	}
+
+	void Timer::Serialize(StateStream& state) {
+		state(data_counter, data_interval, data_F024, data_control);
+		state(ext_to_int_counter, ext_to_int_next, ext_to_int_int_done, TimerFreqDiv);
+		// TM0CON0 bit 3 picks the clock the timer counts, as in its write handler.
+		if (state.Loading() && emulator.ModelDefinition.real_hardware)
+			clock_type = data_F024 & 0x08 ? CLOCK_HSCLK : CLOCK_LSCLK;
+	}
 	template <typename ReadFunc, typename WriteFunc>
 		requires requires(ReadFunc read, WriteFunc write, MMURegion* reg, size_t off, uint8_t dat) {
 			{ read(reg, off) } -> std::same_as<uint8_t>;
@@ -194,6 +204,7 @@ namespace casioemu {
 		uint16_t a{};
 		using Peripheral::Peripheral;
 		void Initialise() override {
+			clock_type = CLOCK_SYSCLK;
 			for (auto& unit : Units)
 				unit.Initialise(emulator);
 			TMStart.Setup(0xF350, 2, "Timer/StartReg",&a, MMURegion::DefaultRead<uint16_t>,MMURegion::DefaultWrite<uint16_t>,emulator);
@@ -209,6 +220,17 @@ namespace casioemu {
 			//	emulator.chipset.data_LTBR++;
 			//}
 		}
+		bool IsIdle() override {
+			for (auto& unit : Units)
+				if (unit.started)
+					return false;
+			return true;
+		}
+		void Serialize(StateStream& state) override {
+			state(a);
+			for (auto& unit : Units)
+				state(unit.tm_data_d, unit.tm_counter_d, unit.tm_mode_d, unit.tm_int_stat_d, unit.tm_int_clr_d, unit.tm_cnt, unit.started);
+		}
 	};
 	Peripheral* CreateTimer(Emulator& emu) {
 		if (emu.hardware_id == HW_TI) {
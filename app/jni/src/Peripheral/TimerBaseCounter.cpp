@@ -3,6 +3,7 @@
 #include "Chipset/Chipset.hpp"
 #include "Emulator.hpp"
 #include "Logger.hpp"
+#include "SaveState.hpp"
 
 namespace casioemu {
 	class TimerBaseCounter : public Peripheral {
@@ -24,6 +25,7 @@ namespace casioemu {
 		void Reset();
 		void Tick();
 		void ResetLSCLK();
+		void Serialize(StateStream& state) override;
 	};
 	void TimerBaseCounter::Initialise() {
 		clock_type = CLOCK_LSCLK;
@@ -73,6 +75,10 @@ namespace casioemu {
 		emulator.chipset.MaskableInterrupts[L4096SINT].TryRaise();
 		emulator.chipset.MaskableInterrupts[L16384SINT].TryRaise();
 	}
+
+	void TimerBaseCounter::Serialize(StateStream& state) {
+		state(current_output, LTBR_reset_tick, LTBRCounter);
+	}
 	class TBC2 : public Peripheral {
 		size_t LTB0INT = 55; // See Chipset.cpp
 		size_t LTB1INT = 56;
@@ -154,6 +160,9 @@ namespace casioemu {
 			emulator.chipset.MaskableInterrupts[LTB1INT].TryRaise();
 			emulator.chipset.MaskableInterrupts[LTB2INT].TryRaise();
 		}
+		void Serialize(StateStream& state) override {
+			state(current_output, LTBR_reset_tick, LTBRCounter, LTB0S, LTB1S, LTB2S);
+		}
 	};
 	Peripheral* CreateTimerBaseCounter(Emulator& emu) {
 		if (emu.hardware_id == HW_TI) {
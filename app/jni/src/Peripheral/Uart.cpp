@@ -1,4 +1,5 @@
 ﻿#include "Peripheral.hpp"
+#include "SaveState.hpp"
 #include <MMURegion.hpp>
 #include <iostream>
 #include <queue>
@@ -15,6 +16,7 @@ namespace casioemu {
 		using Peripheral::Peripheral;
 
 		void Initialise() {
+			clock_type = CLOCK_SYSCLK;
 			region_UA0BUF.Setup(0xF290, 1, "Uart0/Buffer", this, UartRead, UartWrite, emulator);
 			region_UA0CON.Setup(0xF291, 1, "Uart0/Control", &uart_control,
 				MMURegion::DefaultRead<uint8_t, 0x1>, MMURegion::DefaultWrite<uint8_t, 0x1>, emulator);
@@ -91,6 +93,11 @@ namespace casioemu {
 				uart_status = 0; // 始终可写
 			}
 		}
+
+		// Characters queued from stdin belong to the host, so they stay out of save states.
+		void Serialize(StateStream& state) override {
+			state(uart_control, uart_mod0, uart_mod1, uart_baud, uart_buf, uart_status);
+		}
 	};
 
 	Peripheral* CreateUart(Emulator& emu) {
@@ -4,6 +4,7 @@
 #include "Chipset/MMU.hpp"
 #include "Emulator.hpp"
 #include "Logger.hpp"
+#include "SaveState.hpp"
 
 #include <cmath>
 
@@ -23,6 +24,7 @@ namespace casioemu {
 		void Initialise();
 		void Reset();
 		void Tick();
+		void Serialize(StateStream& state);
 	};
 	void WatchdogTimer::Initialise() {
 		// Watchdog timer is normally disabled in casio calculators, but in some models parts of its function is reserved.
@@ -80,6 +82,11 @@ namespace casioemu {
 		WDT_counter = 0;
 		overflow_count = false;
 	}
+
+	void WatchdogTimer::Serialize(StateStream& state) {
+		state(data_WDTCON, data_WDTMOD, data_WDP, WDT_counter, overflow_count);
+	}
+
 	Peripheral* CreateWatchdog(Emulator& emu) {
 		return new WatchdogTimer(emu);
 	}
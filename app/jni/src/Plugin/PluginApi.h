@@ -62,7 +62,7 @@ public:
 	/// Get register's value.
 	/// </summary>
 	/// <param name="name">Register's name</param>
-	/// <returns>Pointer to the register</returns>
+	/// <returns>Pointer to the register. `r0`-`r15` only use the low byte.</returns>
 	virtual uint16_t* Register(const char* name) = 0;
 };
 class IMMU {
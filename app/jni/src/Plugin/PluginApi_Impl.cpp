@@ -9,7 +9,7 @@ class PluginApi_Impl : public PluginApi {
 
 	class IMMU_Impl : public IMMU {
 		uint8_t ReadData(size_t addr) override {
-			return me_mmu->ReadData(addr);
+			return me_mmu->ReadData(addr, false);
 		}
 		void WriteData(size_t addr, uint8_t dat) override {
 			me_mmu->WriteData(addr, dat);
@@ -18,13 +18,16 @@ class PluginApi_Impl : public PluginApi {
 			return me_mmu->ReadCode(addr);
 		}
 		void WriteCode(size_t addr, uint8_t dat) override {
-			m_emu->chipset.rom_data[addr] = dat;
+			m_emu->RunOnTickThread([addr, dat] {
+				m_emu->chipset.rom_data[addr] = dat;
+				m_emu->chipset.cpu.InvalidateDecodeCache();
+			});
 		}
 	} mmu_impl;
 	class ICPU_Impl : public ICPU {
 		// ͨ ICPU ̳
 		uint16_t* Register(const char* name) override {
-			return &m_emu->chipset.cpu.register_proxies[name]->raw;
+			return m_emu->chipset.cpu.PluginRegister(name);
 		}
 	} cpu_impl;
 	class IEmulator_Impl : public IEmulator {
@@ -88,7 +91,8 @@ class PluginApi_Impl : public PluginApi {
 
 		// עִָ hook handler ֻҪ InstructionEventArgs
 		void SetupOnInstructionHook(std::function<void(InstructionEventArgs&)> handler) override {
-			SetupHook(on_instruction,
+			++m_emu->hooks.on_instruction_listeners;
+			SetupHook(m_emu->hooks.on_instruction,
 				[handler](casioemu::CPU& /*cpu*/, InstructionEventArgs& args) {
 					handler(args);
 				});
@@ -96,7 +100,8 @@ class PluginApi_Impl : public PluginApi {
 
 		// עắ hook handler ֻҪ FunctionEventArgs
 		void SetupOnCallFunctionHook(std::function<void(const FunctionEventArgs&)> handler) override {
-			SetupHook(on_call_function,
+			++m_emu->hooks.on_call_function_listeners;
+			SetupHook(m_emu->hooks.on_call_function,
 				[handler](casioemu::CPU& /*cpu*/, const FunctionEventArgs& args) {
 					handler(args);
 				});
@@ -104,7 +109,8 @@ class PluginApi_Impl : public PluginApi {
 
 		// עắ hook handler ֻҪ FunctionEventArgs
 		void SetupOnFunctionReturnHook(std::function<void(const FunctionEventArgs&)> handler) override {
-			SetupHook(on_function_return,
+			++m_emu->hooks.on_function_return_listeners;
+			SetupHook(m_emu->hooks.on_function_return,
 				[handler](casioemu::CPU& /*cpu*/, const FunctionEventArgs& args) {
 					handler(args);
 				});
@@ -112,7 +118,8 @@ class PluginApi_Impl : public PluginApi {
 
 		// עڴȡ hook handler ֻҪ MemoryEventArgs
 		void SetupOnMemoryReadHook(std::function<void(MemoryEventArgs&)> handler) override {
-			SetupHook(on_memory_read,
+			++m_emu->hooks.on_memory_read_listeners;
+			SetupHook(m_emu->hooks.on_memory_read,
 				[handler](casioemu::MMU& /*mmu*/, MemoryEventArgs& args) {
 					handler(args);
 				});
@@ -120,7 +127,8 @@ class PluginApi_Impl : public PluginApi {
 
 		// עڴд hook handler ֻҪ MemoryEventArgs
 		void SetupOnMemoryWriteHook(std::function<void(MemoryEventArgs&)> handler) override {
-			SetupHook(on_memory_write,
+			++m_emu->hooks.on_memory_write_listeners;
+			SetupHook(m_emu->hooks.on_memory_write,
 				[handler](casioemu::MMU& /*mmu*/, MemoryEventArgs& args) {
 					handler(args);
 				});
@@ -128,7 +136,7 @@ class PluginApi_Impl : public PluginApi {
 
 		// עж϶ϵ hook handler ֻҪ InterruptEventArgs
 		void SetupOnBrkHook(std::function<void(InterruptEventArgs&)> handler) override {
-			SetupHook(on_brk,
+			SetupHook(m_emu->hooks.on_brk,
 				[handler](casioemu::Chipset& /*chipset*/, InterruptEventArgs& args) {
 					handler(args);
 				});
@@ -136,7 +144,7 @@ class PluginApi_Impl : public PluginApi {
 
 		// עж hook handler ֻҪ InterruptEventArgs
 		void SetupOnInterruptHook(std::function<void(InterruptEventArgs&)> handler) override {
-			SetupHook(on_interrupt,
+			SetupHook(m_emu->hooks.on_interrupt,
 				[handler](casioemu::Chipset& /*chipset*/, InterruptEventArgs& args) {
 					handler(args);
 				});
@@ -144,7 +152,7 @@ class PluginApi_Impl : public PluginApi {
 
 		// עḴλ hook handler ޲ڲ hook  Chipset 
 		void SetupOnResetHook(std::function<void()> handler) override {
-			SetupHook(on_reset,
+			SetupHook(m_emu->hooks.on_reset,
 				[handler](casioemu::Chipset& /*chipset*/) {
 					handler();
 				});
@@ -0,0 +1,180 @@
+﻿#include "Pool.hpp"
+
+#include "Batch.hpp"
+#include "Emulator.hpp"
+#include "Logger.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+namespace casioemu {
+	// * Upper bound for the `threads` key; each worker runs a whole emulator.
+	constexpr size_t MAX_POOL_THREADS = 256;
+
+	EmulatorPool::EmulatorPool(size_t threads) {
+		if (!threads)
+			threads = std::max(1u, std::thread::hardware_concurrency());
+		for (size_t ix = 0; ix != threads; ++ix)
+			workers.push_back(std::make_unique<Worker>());
+		for (size_t ix = 0; ix != threads; ++ix)
+			workers[ix]->thread = std::thread(&EmulatorPool::WorkerLoop, this, ix);
+	}
+
+	EmulatorPool::~EmulatorPool() {
+		{
+			LOCK(wake_mx);
+			stopping = true;
+		}
+		wake.notify_all();
+		for (auto& worker : workers)
+			worker->thread.join();
+	}
+
+	std::future<int> EmulatorPool::Submit(PoolJob job) {
+		std::packaged_task<int()> task([job = std::move(job)] {
+			return RunJob(job);
+		});
+		auto result = task.get_future();
+		{
+			LOCK(wake_mx);
+			auto& worker = *workers[next_worker++ % workers.size()];
+			std::lock_guard<std::mutex> worker_lock(worker.access_mx);
+			worker.jobs.push_back(std::move(task));
+			++queued;
+		}
+		wake.notify_one();
+		return result;
+	}
+
+	bool EmulatorPool::TakeJob(size_t self, std::packaged_task<int()>& task) {
+		{
+			auto& own = *workers[self];
+			std::lock_guard<std::mutex> lock(own.access_mx);
+			if (!own.jobs.empty()) {
+				task = std::move(own.jobs.back());
+				own.jobs.pop_back();
+				return true;
+			}
+		}
+		for (size_t ix = 1; ix != workers.size(); ++ix) {
+			auto& victim = *workers[(self + ix) % workers.size()];
+			std::lock_guard<std::mutex> lock(victim.access_mx);
+			if (!victim.jobs.empty()) {
+				task = std::move(victim.jobs.front());
+				victim.jobs.pop_front();
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void EmulatorPool::WorkerLoop(size_t self) {
+		while (true) {
+			{
+				std::unique_lock<std::mutex> lock(wake_mx);
+				wake.wait(lock, [this] { return queued || stopping; });
+				if (!queued)
+					return;
+				--queued;
+			}
+			// * `queued` counted this job in, so some queue still holds one.
+			std::packaged_task<int()> task;
+			while (!TakeJob(self, task))
+				std::this_thread::yield();
+			task();
+		}
+	}
+
+	int EmulatorPool::RunJob(const PoolJob& job) {
+		std::map<std::string, std::string> argv_map = job.options;
+		argv_map["headless"] = "1";
+		argv_map["model"] = job.model;
+		argv_map["batch"] = job.script;
+		if (!job.rom.empty())
+			argv_map["rom"] = job.rom;
+		Emulator emulator(argv_map);
+		return BatchRunner(emulator).Run();
+	}
+
+	int EmulatorPool::RunJobFile(std::map<std::string, std::string>& argv_map) {
+		auto jobs_iter = argv_map.find("jobs");
+		std::ifstream file(jobs_iter->second);
+		if (!file) {
+			logger::Info("[Pool][Error] Can't read %s\n", jobs_iter->second.c_str());
+			return 1;
+		}
+
+		std::vector<PoolJob> jobs;
+		std::string line;
+		while (std::getline(file, line)) {
+			std::istringstream iss(line.substr(0, line.find('#')));
+			std::vector<std::string> args;
+			std::string arg;
+			while (iss >> std::ws && !iss.eof()) {
+				if (iss.peek() == '"')
+					iss >> std::quoted(arg);
+				else
+					iss >> arg;
+				args.push_back(arg);
+			}
+			if (args.empty())
+				continue;
+			if (args.size() < 2) {
+				logger::Info("[Pool][Error] Job %zu has no script\n", jobs.size() + 1);
+				return 1;
+			}
+
+			PoolJob job{args[0], args[1]};
+			for (size_t ix = 2; ix != args.size(); ++ix) {
+				auto eq_pos = args[ix].find('=');
+				auto key = args[ix].substr(0, eq_pos);
+				auto value = eq_pos == std::string::npos ? std::string() : args[ix].substr(eq_pos + 1);
+				if (key == "rom")
+					job.rom = value;
+				else
+					job.options[key] = value;
+			}
+			jobs.push_back(std::move(job));
+		}
+
+		size_t threads = 0;
+		try {
+			std::size_t pos;
+			auto threads_iter = argv_map.find("threads");
+			if (threads_iter != argv_map.end()) {
+				auto count = std::stoul(threads_iter->second, &pos, 0);
+				if (pos != threads_iter->second.size())
+					PANIC("threads parameter has extraneous trailing characters\n");
+				if (count < 1 || count > MAX_POOL_THREADS)
+					throw std::out_of_range("threads");
+				threads = count;
+			}
+		}
+		catch (std::invalid_argument const&) {
+			PANIC("invalid threads parameter\n");
+		}
+		catch (std::out_of_range const&) {
+			PANIC("out of range threads parameter (1 to %zu)\n", MAX_POOL_THREADS);
+		}
+
+		std::vector<std::future<int>> results;
+		{
+			EmulatorPool pool(threads);
+			for (auto& job : jobs)
+				results.push_back(pool.Submit(job));
+		}
+
+		size_t failed = 0;
+		for (size_t ix = 0; ix != results.size(); ++ix) {
+			if (results[ix].get() == 0)
+				continue;
+			logger::Info("[Pool][Error] Job %zu (%s, %s) failed\n", ix + 1, jobs[ix].model.c_str(), jobs[ix].script.c_str());
+			++failed;
+		}
+		logger::Info("[Pool][Info] %zu of %zu jobs succeeded\n", results.size() - failed, results.size());
+		return failed ? 1 : 0;
+	}
+} // namespace casioemu
@@ -0,0 +1,83 @@
+﻿#pragma once
+#include "Config.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace casioemu {
+	/**
+	 * One headless run for an `EmulatorPool`: the model directory, the
+	 * `BatchRunner` script to run on it and optionally another ROM image.
+	 * `options` are passed on as extra keys, e.g. `seed` or `record`.
+	 */
+	struct PoolJob {
+		std::string model, script, rom;
+		std::map<std::string, std::string> options;
+	};
+
+	/**
+	 * Runs headless emulators on a fixed set of worker threads, one whole
+	 * `PoolJob` at a time per thread. Every emulator keeps its state to
+	 * itself (see `EmulatorHooks`), so they don't need to be locked against
+	 * each other.
+	 *
+	 * Jobs are handed out round robin to per-worker queues. A worker takes
+	 * the newest job from its own queue and, once that is empty, steals the
+	 * oldest one from another worker's, so that a few long scripts don't
+	 * leave the other threads idle.
+	 *
+	 * A job that PANICs still takes the whole process down.
+	 */
+	class EmulatorPool {
+		struct Worker {
+			std::mutex access_mx;
+			std::deque<std::packaged_task<int()>> jobs;
+			std::thread thread;
+		};
+		std::vector<std::unique_ptr<Worker>> workers;
+		size_t next_worker = 0;
+
+		std::mutex wake_mx;
+		std::condition_variable wake;
+		size_t queued = 0;
+		bool stopping = false;
+
+		bool TakeJob(size_t self, std::packaged_task<int()>& task);
+		void WorkerLoop(size_t self);
+
+	public:
+		/**
+		 * Starts `threads` workers, or one per hardware thread if that is 0.
+		 */
+		EmulatorPool(size_t threads = 0);
+		/**
+		 * Finishes every job submitted so far before returning.
+		 */
+		~EmulatorPool();
+
+		/**
+		 * Queues a job. The future gets the script's exit code, see
+		 * `BatchRunner::Run`.
+		 */
+		std::future<int> Submit(PoolJob job);
+
+		static int RunJob(const PoolJob& job);
+
+		/**
+		 * Runs every job in the file given by the `jobs` key on `threads`
+		 * workers (1 to 256, one per hardware thread if the key is left out)
+		 * and returns 0 if they all succeeded. One job per line,
+		 * `#` starts a comment:
+		 *
+		 *     <model> <script> [rom=<file>] [<key>=<value>]...
+		 */
+		static int RunJobFile(std::map<std::string, std::string>& argv_map);
+	};
+} // namespace casioemu
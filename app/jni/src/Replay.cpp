@@ -0,0 +1,160 @@
+﻿#include "Replay.hpp"
+
+#include "Binary.h"
+#include "Chipset/Chipset.hpp"
+#include "Emulator.hpp"
+#include "Logger.hpp"
+#include "Peripheral/Keyboard.hpp"
+#include "Rewind.hpp"
+#include "SaveState.hpp"
+
+#include <algorithm>
+
+namespace casioemu {
+	Replay::Replay(Emulator& _emulator) : emulator(_emulator) {
+		auto replay_iter = emulator.argv_map.find("replay");
+		if (replay_iter != emulator.argv_map.end())
+			replay_path = replay_iter->second;
+		auto record_iter = emulator.argv_map.find("record");
+		if (record_iter != emulator.argv_map.end() && replay_path.empty())
+			record_path = record_iter->second;
+	}
+
+	void Replay::WriteEvent(uint64_t tick, uint8_t action, uint8_t button) {
+		uint64_t delta = tick - last_tick;
+		last_tick = tick;
+		do {
+			uint8_t byte = (delta & 0x7F) | (delta > 0x7F ? 0x80 : 0);
+			Binary::Write(record, byte);
+			delta >>= 7;
+		} while (delta);
+		Binary::Write(record, action);
+		Binary::Write(record, button);
+	}
+
+	/**
+	 * FNV-1a over everything a save state holds, which is the RAM, the screen
+	 * buffers and every register.
+	 */
+	uint64_t Replay::HashMachine() {
+		auto snapshot = emulator.save_states.Capture();
+		uint64_t hash = 0xCBF29CE484222325;
+		auto feed = [&hash](const uint8_t* data, size_t size) {
+			for (size_t ix = 0; ix != size; ++ix)
+				hash = (hash ^ data[ix]) * 0x100000001B3;
+		};
+		feed((const uint8_t*)snapshot->machine.data(), snapshot->machine.size());
+		for (auto& image : snapshot->memory)
+			for (size_t offset = 0; offset < image.size; offset += StateSnapshot::page_size)
+				feed(image.pages[offset / StateSnapshot::page_size]->data(), std::min(StateSnapshot::page_size, image.size - offset));
+		return hash;
+	}
+
+	void Replay::Start() {
+		if (!record_path.empty()) {
+			emulator.RunOnTickThread([this] {
+				record.open(record_path, std::ofstream::binary);
+				Binary::Write(record, magic);
+				Binary::Write(record, version);
+				Binary::Write(record, *emulator.save_states.Capture());
+				last_tick = emulator.chipset.GetTickCount();
+				record.flush();
+				if (!record) {
+					logger::Info("[Replay][Error] Can't record to %s\n", record_path.c_str());
+					record.close();
+					return;
+				}
+				logger::Info("[Replay][Info] Recording to %s\n", record_path.c_str());
+			});
+		}
+		if (replay_path.empty())
+			return;
+
+		auto snapshot = std::make_shared<StateSnapshot>();
+		std::vector<Event> loaded;
+		std::ifstream is(replay_path, std::ifstream::binary);
+		uint32_t file_magic = 0, file_version = 0;
+		Binary::Read(is, file_magic);
+		Binary::Read(is, file_version);
+		if (file_magic == magic && file_version == version)
+			Binary::Read(is, *snapshot);
+		if (!is) {
+			logger::Info("[Replay][Error] Can't read a replay from %s\n", replay_path.c_str());
+			return;
+		}
+		// * Ticks are relative to the snapshot until it is restored. A truncated recording plays up to where it was cut off.
+		uint64_t tick = 0;
+		while (true) {
+			uint64_t delta = 0;
+			uint8_t byte = 0x80;
+			for (int shift = 0; byte & 0x80 && is; shift += 7) {
+				Binary::Read(is, byte);
+				delta |= (uint64_t)(byte & 0x7F) << shift;
+			}
+			Event event{tick += delta};
+			Binary::Read(is, event.action);
+			Binary::Read(is, event.button);
+			if (event.action == IKeyboard::KA_END)
+				Binary::Read(is, event.hash);
+			if (!is)
+				break;
+			loaded.push_back(event);
+			if (event.action == IKeyboard::KA_END)
+				break;
+		}
+
+		emulator.RunOnTickThread([this, snapshot, loaded] {
+			if (!emulator.save_states.Restore(*snapshot)) {
+				logger::Info("[Replay][Error] %s was recorded on a different model\n", replay_path.c_str());
+				return;
+			}
+			emulator.rewind.Clear();
+			uint64_t start = emulator.chipset.GetTickCount();
+			events = loaded;
+			for (auto& event : events)
+				event.tick += start;
+			next_event = 0;
+			logger::Info("[Replay][Info] Playing %zu key actions from %s\n", events.size(), replay_path.c_str());
+			Play();
+		});
+	}
+
+	void Replay::Stop() {
+		if (record.is_open()) {
+			WriteEvent(emulator.chipset.GetTickCount(), IKeyboard::KA_END, 0);
+			Binary::Write(record, HashMachine());
+			record.close();
+			logger::Info("[Replay][Info] Recording saved to %s\n", record_path.c_str());
+		}
+		events.clear();
+		next_event = 0;
+		next_event_tick = UINT64_MAX;
+	}
+
+	void Replay::Record(uint8_t action, uint8_t button) {
+		if (!record.is_open())
+			return;
+		WriteEvent(emulator.chipset.GetTickCount(), action, button);
+		// * So that a recording cut short by a crash still plays up to there.
+		record.flush();
+	}
+
+	void Replay::Play() {
+		uint64_t now = emulator.chipset.GetTickCount();
+		auto keyboard = emulator.chipset.QueryInterface<IKeyboard>();
+		while (next_event != events.size() && events[next_event].tick <= now) {
+			auto& event = events[next_event++];
+			if (event.action != IKeyboard::KA_END) {
+				if (keyboard)
+					keyboard->ApplyKeyAction(event.action, event.button);
+				continue;
+			}
+			if (HashMachine() == event.hash)
+				logger::Info("[Replay][Info] Replay finished at tick %llu, the machine matches the recording\n", (unsigned long long)now);
+			else
+				logger::Info("[Replay][Error] Replay finished at tick %llu, the machine differs from the recording\n", (unsigned long long)now);
+			emulator.SetPaused(true);
+		}
+		next_event_tick = next_event != events.size() ? events[next_event].tick : UINT64_MAX;
+	}
+} // namespace casioemu
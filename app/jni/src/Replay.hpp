@@ -0,0 +1,67 @@
+﻿#pragma once
+#include "Config.hpp"
+
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace casioemu {
+	class Emulator;
+	struct StateSnapshot;
+
+	/**
+	 * Records keyboard input against the tick count it was applied at, or
+	 * plays such a recording back, in deterministic mode. Set through the
+	 * `record` and `replay` keys, which both turn deterministic mode on.
+	 *
+	 * A replay file is `magic`, `version` and the `StateSnapshot` recording
+	 * started from, then one record per key action: the ticks since the
+	 * previous record as a LEB128 number, the action and the button. The
+	 * last record is `KA_END` followed by a hash of the machine at that
+	 * point, which playback checks before pausing the emulator.
+	 *
+	 * All methods but `Start` must be called on the tick thread, or once it
+	 * has stopped.
+	 */
+	class Replay {
+		Emulator& emulator;
+		std::string record_path, replay_path;
+
+		std::ofstream record;
+		uint64_t last_tick = 0;
+
+		struct Event {
+			uint64_t tick;
+			uint8_t action, button;
+			uint64_t hash;
+		};
+		std::vector<Event> events;
+		size_t next_event = 0;
+
+		void WriteEvent(uint64_t tick, uint8_t action, uint8_t button);
+		uint64_t HashMachine();
+
+	public:
+		static constexpr uint32_t magic = 0x50525343; // "CSRP"
+		static constexpr uint32_t version = 1;
+
+		// * `Emulator::Tick` calls `Play` once the chipset gets here.
+		uint64_t next_event_tick = UINT64_MAX;
+
+		Replay(Emulator& emulator);
+
+		/**
+		 * Queues the start of recording or playback on the tick thread. Called
+		 * once the emulator is set up.
+		 */
+		void Start();
+		void Stop();
+
+		bool Playing() const {
+			return next_event != events.size();
+		}
+		void Record(uint8_t action, uint8_t button);
+		void Play();
+	};
+} // namespace casioemu
@@ -0,0 +1,312 @@
+﻿#include "Rewind.hpp"
+
+#include "Chipset/CPU.hpp"
+#include "Chipset/Chipset.hpp"
+#include "Emulator.hpp"
+#include "Gui/Hooks.h"
+#include "Logger.hpp"
+#include "Peripheral/Keyboard.hpp"
+#include "Replay.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace casioemu {
+	/**
+	 * Replayed instructions have been seen by the debugger once already, so
+	 * the observing hooks stay quiet while they run again.
+	 */
+	struct MutedHooks {
+		EmulatorHooks& hooks;
+		decltype(EmulatorHooks::on_instruction) on_instruction;
+		decltype(EmulatorHooks::on_call_function) on_call_function;
+		decltype(EmulatorHooks::on_function_return) on_function_return;
+		decltype(EmulatorHooks::on_memory_read) on_memory_read;
+		decltype(EmulatorHooks::on_memory_write) on_memory_write;
+		decltype(EmulatorHooks::on_watched_read) on_watched_read;
+
+		// * The UI may change the listener counts meanwhile, so they are left alone and `muted` silences them.
+		MutedHooks(EmulatorHooks& hooks) : hooks(hooks) {
+			Swap();
+			hooks.muted = true;
+		}
+		~MutedHooks() {
+			hooks.muted = false;
+			Swap();
+		}
+		void Swap() {
+			std::swap(on_instruction, hooks.on_instruction);
+			std::swap(on_call_function, hooks.on_call_function);
+			std::swap(on_function_return, hooks.on_function_return);
+			std::swap(on_memory_read, hooks.on_memory_read);
+			std::swap(on_memory_write, hooks.on_memory_write);
+			std::swap(on_watched_read, hooks.on_watched_read);
+		}
+	};
+
+	RewindBuffer::RewindBuffer(Emulator& _emulator) : emulator(_emulator), states(_emulator) {
+		interval_ms = emulator.headless ? 0 : 100;
+		budget = 64 << 20;
+
+		try {
+			std::size_t pos;
+			auto interval_iter = emulator.argv_map.find("rewind_interval");
+			if (interval_iter != emulator.argv_map.end()) {
+				auto interval = std::stoul(interval_iter->second, &pos, 0);
+				if (pos != interval_iter->second.size())
+					PANIC("rewind_interval parameter has extraneous trailing characters\n");
+				if (interval > UINT_MAX)
+					throw std::out_of_range("rewind_interval");
+				interval_ms = (unsigned int)interval;
+			}
+		}
+		catch (std::invalid_argument const&) {
+			PANIC("invalid rewind_interval parameter\n");
+		}
+		catch (std::out_of_range const&) {
+			PANIC("out of range rewind_interval parameter\n");
+		}
+		try {
+			std::size_t pos;
+			auto budget_iter = emulator.argv_map.find("rewind_budget");
+			if (budget_iter != emulator.argv_map.end()) {
+				auto budget_mb = std::stoul(budget_iter->second, &pos, 0);
+				if (pos != budget_iter->second.size())
+					PANIC("rewind_budget parameter has extraneous trailing characters\n");
+				// * In megabytes, so it has to survive the shift into bytes.
+				if (budget_mb > SIZE_MAX >> 20)
+					throw std::out_of_range("rewind_budget");
+				budget = (size_t)budget_mb << 20;
+			}
+		}
+		catch (std::invalid_argument const&) {
+			PANIC("invalid rewind_budget parameter\n");
+		}
+		catch (std::out_of_range const&) {
+			PANIC("out of range rewind_budget parameter\n");
+		}
+	}
+
+	void RewindBuffer::Setup() {
+		ScheduleCapture();
+	}
+
+	void RewindBuffer::ScheduleCapture() {
+		if (!interval_ms) {
+			next_capture_tick = UINT64_MAX;
+			return;
+		}
+		next_capture_tick = emulator.chipset.GetTickCount() + std::max<uint64_t>(emulator.GetCyclesPerSecond() / 1000 * interval_ms, 1);
+	}
+
+	/**
+	 * Pairs of a byte count to skip and a byte count to XOR in, followed by
+	 * the bytes. Most of a page XORed with its previous contents is zero.
+	 */
+	void RewindBuffer::EncodeXor(const uint8_t* a, const uint8_t* b, size_t size, std::vector<uint8_t>& out) {
+		size_t ix = 0;
+		while (ix != size) {
+			size_t skip = 0;
+			while (ix + skip != size && skip != 0xFF && a[ix + skip] == b[ix + skip])
+				skip++;
+			ix += skip;
+			size_t length = 0;
+			while (ix + length != size && length != 0xFF && a[ix + length] != b[ix + length])
+				length++;
+			out.push_back((uint8_t)skip);
+			out.push_back((uint8_t)length);
+			for (; length; --length, ++ix)
+				out.push_back(a[ix] ^ b[ix]);
+		}
+	}
+
+	const uint8_t* RewindBuffer::DecodeXor(const uint8_t* in, uint8_t* data, size_t size) {
+		size_t ix = 0;
+		while (ix != size) {
+			ix += *in++;
+			size_t length = *in++;
+			for (; length; --length, ++ix)
+				data[ix] ^= *in++;
+		}
+		return in;
+	}
+
+	void RewindBuffer::Capture() {
+		auto& chipset = emulator.chipset;
+		ScheduleCapture();
+
+		auto snapshot = states.Capture();
+		Entry entry{chipset.GetTickCount(), chipset.cpu.instructions_retired, 0, (uint32_t)snapshot->machine.size()};
+
+		if (head && head->memory.size() == snapshot->memory.size()) {
+			std::string current = snapshot->machine, previous = head->machine;
+			size_t size = std::max(current.size(), previous.size());
+			current.resize(size);
+			previous.resize(size);
+			EncodeXor((const uint8_t*)current.data(), (const uint8_t*)previous.data(), size, entry.delta);
+
+			for (size_t block = 0; block != snapshot->memory.size(); ++block) {
+				auto& image = snapshot->memory[block];
+				auto& last = head->memory[block];
+				if (image.size != last.size) {
+					// * The memory layout changed under a host write (an epoch reset), so this
+					// * has to be a full snapshot; nothing before it can be diffed against.
+					DropHistory();
+					entry.delta.clear();
+					break;
+				}
+				for (uint32_t page = 0; page != image.pages.size(); ++page) {
+					if (image.pages[page] == last.pages[page])
+						continue;
+					entry.delta.push_back((uint8_t)block);
+					entry.delta.insert(entry.delta.end(), (uint8_t*)&page, (uint8_t*)&page + sizeof(page));
+					EncodeXor(image.pages[page]->data(), last.pages[page]->data(), StateSnapshot::page_size, entry.delta);
+				}
+			}
+		}
+		else
+			DropHistory();
+
+		entry.inputs = inputs_dropped + inputs.size();
+		used += entry.delta.size() + sizeof(Entry);
+		entries.push_back(std::move(entry));
+		head = snapshot;
+
+		while (entries.size() > 1 && used > budget) {
+			used -= entries.front().delta.size() + sizeof(Entry);
+			entries.pop_front();
+			// * Nothing goes back past the oldest snapshot, so its delta is never used.
+			used -= entries.front().delta.size();
+			entries.front().delta = {};
+		}
+		while (inputs_dropped != entries.front().inputs) {
+			inputs.pop_front();
+			++inputs_dropped;
+		}
+	}
+
+	void RewindBuffer::LogInput(uint8_t action, uint8_t button) {
+		if (!interval_ms || !emulator.deterministic || running_forward)
+			return;
+		inputs.push_back({emulator.chipset.GetTickCount(), action, button});
+	}
+
+	void RewindBuffer::DropHistory() {
+		entries.clear();
+		head.reset();
+		used = 0;
+		inputs_dropped += inputs.size();
+		inputs.clear();
+	}
+
+	void RewindBuffer::Clear() {
+		DropHistory();
+		// * Memory may have changed behind its back, e.g. by loading a state.
+		states.Reset();
+	}
+
+	bool RewindBuffer::Seek(size_t index) {
+		if (!head || index >= entries.size())
+			return false;
+
+		StateSnapshot snapshot = *head;
+		for (size_t ix = entries.size() - 1; ix != index; --ix) {
+			auto& entry = entries[ix];
+			auto& previous = entries[ix - 1];
+			const uint8_t* in = entry.delta.data();
+			const uint8_t* end = in + entry.delta.size();
+
+			snapshot.machine.resize(std::max(entry.machine_size, previous.machine_size));
+			in = DecodeXor(in, (uint8_t*)snapshot.machine.data(), snapshot.machine.size());
+			snapshot.machine.resize(previous.machine_size);
+
+			while (in != end) {
+				uint8_t block = *in++;
+				uint32_t page;
+				memcpy(&page, in, sizeof(page));
+				in += sizeof(page);
+				auto& shared = snapshot.memory[block].pages[page];
+				auto copy = std::make_shared<StateSnapshot::Page>(*shared);
+				in = DecodeXor(in, copy->data(), StateSnapshot::page_size);
+				shared = std::move(copy);
+			}
+		}
+
+		auto& chipset = emulator.chipset;
+		if (!states.Restore(snapshot))
+			return false;
+		chipset.cpu.instructions_retired = entries[index].instructions;
+
+		while (entries.size() > index + 1) {
+			used -= entries.back().delta.size() + sizeof(Entry);
+			entries.pop_back();
+		}
+		head = std::make_shared<const StateSnapshot>(std::move(snapshot));
+		ScheduleCapture();
+		return true;
+	}
+
+	template <typename done_type>
+	uint64_t RewindBuffer::RunForward(done_type done) {
+		auto& chipset = emulator.chipset;
+		auto keyboard = chipset.QueryInterface<IKeyboard>();
+		size_t next_input = entries.back().inputs - inputs_dropped;
+		auto apply_inputs = [&] {
+			while (next_input != inputs.size() && inputs[next_input].tick <= chipset.GetTickCount()) {
+				if (keyboard)
+					keyboard->ApplyKeyAction(inputs[next_input].action, inputs[next_input].button);
+				++next_input;
+			}
+		};
+
+		// * The snapshots taken on the way would land between the ones kept.
+		next_capture_tick = UINT64_MAX;
+		running_forward = true;
+		uint64_t tick_before = chipset.GetTickCount();
+		apply_inputs();
+		while (!done()) {
+			tick_before = chipset.GetTickCount();
+			emulator.Tick();
+			apply_inputs();
+		}
+		running_forward = false;
+		ScheduleCapture();
+
+		// * What was logged after this point no longer happens.
+		inputs.resize(next_input);
+		return tick_before;
+	}
+
+	bool RewindBuffer::StepBack(uint64_t count) {
+		auto& chipset = emulator.chipset;
+		uint64_t now_tick = chipset.GetTickCount();
+		uint64_t now = chipset.cpu.instructions_retired;
+		if (entries.empty() || now < count || now - count < entries.front().instructions)
+			return false;
+		uint64_t target = now - count;
+		emulator.replay.Stop();
+
+		size_t index = entries.size() - 1;
+		while (entries[index].instructions > target)
+			--index;
+		if (!Seek(index))
+			return false;
+
+		MutedHooks muted(emulator.hooks);
+		uint64_t tick_before = RunForward([&] {
+			return chipset.cpu.instructions_retired >= target || chipset.GetTickCount() >= now_tick;
+		});
+		if (chipset.cpu.instructions_retired > target) {
+			// * The target is in the middle of a block, stop right before the block instead.
+			Seek(entries.size() - 1);
+			RunForward([&] {
+				return chipset.GetTickCount() >= tick_before;
+			});
+		}
+		return true;
+	}
+} // namespace casioemu
@@ -0,0 +1,123 @@
+﻿#pragma once
+#include "Config.hpp"
+#include "SaveState.hpp"
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace casioemu {
+	class Emulator;
+
+	/**
+	 * Keeps a snapshot of the machine every `interval_ms` emulated
+	 * milliseconds, so that execution can be stepped backwards. Only the
+	 * newest snapshot is kept whole. Every older one is stored as the
+	 * difference to the snapshot after it: the pages that changed in
+	 * between, XORed with their newer contents and run-length encoded. Going
+	 * back applies these differences from the newest snapshot down, and
+	 * the oldest snapshots are dropped once `budget` bytes are used.
+	 *
+	 * All methods must be called on the tick thread.
+	 */
+	class RewindBuffer {
+		Emulator& emulator;
+
+		/**
+		 * A separate `SaveStates` so that unchanged pages are shared with
+		 * `head`, which makes finding the changed ones a pointer comparison.
+		 */
+		SaveStates states;
+		std::shared_ptr<const StateSnapshot> head;
+
+		struct Entry {
+			// * `inputs` is the number of key actions logged before this snapshot.
+			uint64_t tick_count, instructions, inputs;
+			uint32_t machine_size;
+			/**
+			 * How to get from this snapshot's state to the previous one's:
+			 * the machine blob XORed with the previous one, then records of a
+			 * block index byte, a 32-bit page index and the XORed page. All of
+			 * it run-length encoded, see `EncodeXor`.
+			 */
+			std::vector<uint8_t> delta;
+		};
+		std::deque<Entry> entries;
+		size_t used = 0;
+
+		/**
+		 * Key actions applied since the oldest snapshot, with the tick they
+		 * were applied at, so running forward from a snapshot sees the same
+		 * input. `inputs_dropped` counts the ones dropped from the front.
+		 */
+		struct Input {
+			uint64_t tick;
+			uint8_t action, button;
+		};
+		std::deque<Input> inputs;
+		uint64_t inputs_dropped = 0;
+		// * Set while `StepBack` runs forward, so that input isn't logged twice.
+		bool running_forward = false;
+
+		void ScheduleCapture();
+		static void EncodeXor(const uint8_t* a, const uint8_t* b, size_t size, std::vector<uint8_t>& out);
+		static const uint8_t* DecodeXor(const uint8_t* in, uint8_t* data, size_t size);
+
+		/**
+		 * Rebuilds the snapshot of `entries[index]` and makes it the newest,
+		 * dropping everything recorded after it.
+		 */
+		bool Seek(size_t index);
+		/**
+		 * Runs the machine forward from the snapshot `Seek` went to through
+		 * `Emulator::Tick`, applying the logged input on the way, until
+		 * `done` returns true. Returns the tick count before the last tick.
+		 */
+		template <typename done_type>
+		uint64_t RunForward(done_type done);
+		// * Drops the snapshots but keeps `states`, for `Capture` to start over.
+		void DropHistory();
+
+	public:
+		/**
+		 * Set through the `rewind_interval` and `rewind_budget` (in MB) keys,
+		 * 0 turns rewinding off. Headless instances don't rewind unless
+		 * `rewind_interval` is given.
+		 */
+		unsigned int interval_ms;
+		size_t budget;
+		// * `Emulator::Tick` calls `Capture` once the chipset gets here.
+		uint64_t next_capture_tick = 0;
+
+		RewindBuffer(Emulator& emulator);
+
+		/**
+		 * Schedules the first capture. Called once the chipset is set up and
+		 * the clock rate is known.
+		 */
+		void Setup();
+
+		void Capture();
+		/**
+		 * Drops all snapshots, to be called whenever the machine jumps to a
+		 * state it didn't run into, like loading one.
+		 */
+		void Clear();
+		/**
+		 * Called by the keyboard for every key action it applies. Input is
+		 * only logged in deterministic mode; elsewhere it comes from the UI
+		 * thread at host-timed points, and so do `EmulatorTick`s, so stepping
+		 * back only gets close there.
+		 */
+		void LogInput(uint8_t action, uint8_t button);
+
+		/**
+		 * Goes back `count` instructions by restoring the nearest snapshot
+		 * before them and running the machine forward again, replaying the
+		 * key actions logged since. With the block engine it may land at the
+		 * start of the block containing the target instead. Returns false if
+		 * the target is older than the buffer.
+		 */
+		bool StepBack(uint64_t count);
+	};
+} // namespace casioemu
@@ -0,0 +1,257 @@
+﻿#include "SaveState.hpp"
+
+#include "Chipset/CPU.hpp"
+#include "Chipset/Chipset.hpp"
+#include "Chipset/MMU.hpp"
+#include "Emulator.hpp"
+#include "Logger.hpp"
+#include "Models.h"
+#include "Peripheral/BatteryBackedRAM.hpp"
+#include "Replay.hpp"
+#include "Rewind.hpp"
+
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+namespace casioemu {
+	void StateSnapshot::Write(std::ostream& os) const {
+		Binary::Write(os, magic);
+		Binary::Write(os, version);
+		Binary::Write(os, hardware_id);
+		Binary::Write(os, machine);
+		unsigned long long count = memory.size();
+		Binary::Write(os, count);
+		for (auto& image : memory) {
+			unsigned long long size = image.size;
+			Binary::Write(os, size);
+			for (size_t offset = 0; offset < image.size; offset += page_size)
+				os.write((const char*)image.pages[offset / page_size]->data(), std::min(page_size, image.size - offset));
+		}
+	}
+
+	// * How many bytes are left in `is`, or ULLONG_MAX if it can't seek.
+	static unsigned long long Remaining(std::istream& is) {
+		auto here = is.tellg();
+		if (here == std::streampos(-1))
+			return ULLONG_MAX;
+		is.seekg(0, std::ios::end);
+		auto end = is.tellg();
+		is.seekg(here);
+		return end > here ? (unsigned long long)(end - here) : 0;
+	}
+
+	void StateSnapshot::Read(std::istream& is) {
+		uint32_t file_magic = 0, file_version = 0;
+		Binary::Read(is, file_magic);
+		Binary::Read(is, file_version);
+		if (file_magic != magic || file_version != version) {
+			is.setstate(std::ios::failbit);
+			return;
+		}
+		Binary::Read(is, hardware_id);
+		// * Lengths come from the file, so none is trusted beyond what is left of it.
+		unsigned long long length = 0;
+		Binary::Read(is, length);
+		if (!is || length > Remaining(is)) {
+			is.setstate(std::ios::failbit);
+			return;
+		}
+		machine.assign(length, 0);
+		is.read(machine.data(), length);
+		unsigned long long count = 0;
+		Binary::Read(is, count);
+		if (!is || count > Remaining(is) / sizeof(unsigned long long)) {
+			is.setstate(std::ios::failbit);
+			return;
+		}
+		memory.clear();
+		for (unsigned long long ix = 0; ix < count && is.good(); ++ix) {
+			unsigned long long size = 0;
+			Binary::Read(is, size);
+			if (!is || size > Remaining(is)) {
+				is.setstate(std::ios::failbit);
+				return;
+			}
+			MemoryImage image;
+			image.size = size;
+			for (size_t offset = 0; offset < size && is.good(); offset += page_size) {
+				auto page = std::make_shared<Page>();
+				page->fill(0);
+				is.read((char*)page->data(), std::min<size_t>(page_size, size - offset));
+				image.pages.push_back(page);
+			}
+			memory.push_back(std::move(image));
+		}
+	}
+
+	SaveStates::SaveStates(Emulator& _emulator) : emulator(_emulator) {
+	}
+
+	std::vector<SaveStates::MemoryBlock> SaveStates::GetMemoryBlocks() {
+		std::vector<MemoryBlock> blocks;
+		auto ram = emulator.chipset.QueryInterface<IRam>();
+		if (ram) {
+			blocks.push_back({(uint8_t*)ram->GetRam(), ram->GetRamBufferSize()});
+			blocks.push_back({(uint8_t*)ram->GetPRam(), ram->GetPRamBufferSize()});
+		}
+		// * The fx-5800P's flash chip.
+		blocks.push_back({emulator.chipset.flash_data.data(), emulator.chipset.flash_data.size()});
+		return blocks;
+	}
+
+	void SaveStates::MarkWritten(const uint8_t* begin, size_t size) {
+		for (size_t ix = 0; ix != blocks.size(); ++ix) {
+			auto& block = blocks[ix];
+			if (begin < block.data || begin >= block.data + block.size)
+				continue;
+			size_t offset = begin - block.data;
+			size_t end = std::min(offset + size, block.size);
+			for (size_t page = offset / StateSnapshot::page_size; page * StateSnapshot::page_size < end; ++page)
+				written[ix][page] = true;
+			return;
+		}
+	}
+
+	std::shared_ptr<const StateSnapshot> SaveStates::Capture() {
+		auto snapshot = std::make_shared<StateSnapshot>();
+		snapshot->hardware_id = emulator.hardware_id;
+
+		std::ostringstream machine(std::ios::binary);
+		StateStream state(machine);
+		emulator.chipset.Serialize(state);
+		snapshot->machine = machine.str();
+
+		auto current = GetMemoryBlocks();
+		uint32_t host = emulator.chipset.mmu.host_writes;
+		bool all = host != host_writes || current != blocks;
+		host_writes = host;
+		if (current != blocks) {
+			blocks = current;
+			last_memory.assign(blocks.size(), {});
+			written.assign(blocks.size(), {});
+		}
+		mmu_epoch = emulator.chipset.mmu.WrittenSince(mmu_epoch, [this](const uint8_t* data, size_t size) {
+			MarkWritten(data, size);
+		});
+
+		for (size_t ix = 0; ix != blocks.size(); ++ix) {
+			auto& block = blocks[ix];
+			auto& last = last_memory[ix];
+			last.size = block.size;
+			last.pages.resize((block.size + StateSnapshot::page_size - 1) / StateSnapshot::page_size);
+			written[ix].resize(last.pages.size());
+			for (size_t page = 0; page != last.pages.size(); ++page) {
+				auto& shared = last.pages[page];
+				if (shared && !all && !written[ix][page])
+					continue;
+				written[ix][page] = false;
+				size_t offset = page * StateSnapshot::page_size;
+				size_t length = std::min(StateSnapshot::page_size, block.size - offset);
+				if (shared && !memcmp(shared->data(), block.data + offset, length))
+					continue;
+				auto copy = std::make_shared<StateSnapshot::Page>();
+				copy->fill(0);
+				memcpy(copy->data(), block.data + offset, length);
+				shared = std::move(copy);
+			}
+		}
+		snapshot->memory = last_memory;
+		return snapshot;
+	}
+
+	bool SaveStates::Restore(const StateSnapshot& snapshot) {
+		auto current = GetMemoryBlocks();
+		if (snapshot.hardware_id != (uint32_t)emulator.hardware_id || snapshot.memory.size() != current.size())
+			return false;
+		for (size_t ix = 0; ix != current.size(); ++ix)
+			if (snapshot.memory[ix].size != current[ix].size)
+				return false;
+
+		// * Keep what the peripherals hold now, in case the snapshot's fields don't fit them.
+		std::ostringstream previous(std::ios::binary);
+		StateStream backup(previous);
+		emulator.chipset.Serialize(backup);
+
+		std::istringstream machine(snapshot.machine, std::ios::binary);
+		StateStream state(machine);
+		bool fits;
+		try {
+			emulator.chipset.Serialize(state);
+			// * Every field read and nothing left over, or the peripherals differ from this build.
+			fits = state.Good() && machine.peek() == std::istringstream::traits_type::eof();
+		}
+		catch (std::exception const&) {
+			fits = false;
+		}
+		if (!fits) {
+			std::istringstream undo(previous.str(), std::ios::binary);
+			StateStream restore(undo);
+			emulator.chipset.Serialize(restore);
+			return false;
+		}
+
+		blocks = current;
+
+		for (size_t ix = 0; ix != blocks.size(); ++ix)
+			for (size_t offset = 0; offset < blocks[ix].size; offset += StateSnapshot::page_size)
+				memcpy(blocks[ix].data + offset, snapshot.memory[ix].pages[offset / StateSnapshot::page_size]->data(),
+					std::min(StateSnapshot::page_size, blocks[ix].size - offset));
+		last_memory = snapshot.memory;
+		// * Memory now matches `last_memory` except where written from here on.
+		written.assign(blocks.size(), {});
+		// * Other instances never saw these writes, they have to compare everything.
+		emulator.chipset.mmu.MarkHostWrite();
+		host_writes = emulator.chipset.mmu.host_writes;
+		mmu_epoch = emulator.chipset.mmu.WrittenSince(mmu_epoch, [](const uint8_t*, size_t) {});
+		return true;
+	}
+
+	void SaveStates::Reset() {
+		blocks.clear();
+		last_memory.clear();
+		written.clear();
+	}
+
+	void SaveStates::SaveFile(std::string path) {
+		emulator.RunOnTickThread([this, path] {
+			auto snapshot = Capture();
+			std::thread([snapshot, path] {
+				std::ofstream os(path, std::ofstream::binary);
+				snapshot->Write(os);
+				if (os)
+					logger::Info("[SaveStates][Info] State saved to %s\n", path.c_str());
+				else
+					logger::Info("[SaveStates][Error] Failed to save state to %s\n", path.c_str());
+			}).detach();
+		});
+	}
+
+	void SaveStates::LoadFile(std::string path) {
+		auto snapshot = std::make_shared<StateSnapshot>();
+		std::ifstream is(path, std::ifstream::binary);
+		try {
+			if (is)
+				snapshot->Read(is);
+		}
+		catch (std::exception const&) {
+			is.setstate(std::ios::failbit);
+		}
+		if (!is) {
+			logger::Info("[SaveStates][Error] Can't read a state from %s\n", path.c_str());
+			return;
+		}
+		emulator.RunOnTickThread([this, snapshot, path] {
+			// * A replay can't follow the machine to another state, so it ends here.
+			emulator.replay.Stop();
+			if (!Restore(*snapshot)) {
+				logger::Info("[SaveStates][Error] %s was saved by a different model or build\n", path.c_str());
+				return;
+			}
+			// * Replaying from before the load would not end up where it left off.
+			emulator.rewind.Clear();
+		});
+	}
+} // namespace casioemu
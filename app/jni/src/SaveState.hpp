@@ -0,0 +1,137 @@
+﻿#pragma once
+#include "Config.hpp"
+#include "Binary.h"
+
+#include <array>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace casioemu {
+	class Emulator;
+
+	/**
+	 * Writes fields to or reads them back from a save state, depending on the
+	 * stream it was made for, so that one list of fields in a `Serialize`
+	 * method covers both directions. Fields go through `Binary`.
+	 */
+	class StateStream {
+		std::ostream* os;
+		std::istream* is;
+
+		template <typename value_type>
+		void Field(value_type& value) {
+			if (os)
+				Binary::Write(*os, value);
+			else
+				Binary::Read(*is, value);
+		}
+
+	public:
+		StateStream(std::ostream& os) : os(&os), is(nullptr) {}
+		StateStream(std::istream& is) : os(nullptr), is(&is) {}
+
+		bool Loading() const {
+			return is != nullptr;
+		}
+		bool Good() const {
+			return os ? os->good() : is->good();
+		}
+
+		template <typename... value_types>
+		void operator()(value_types&... values) {
+			(Field(values), ...);
+		}
+		void Bytes(void* data, size_t size) {
+			if (os)
+				os->write((const char*)data, size);
+			else
+				is->read((char*)data, size);
+		}
+	};
+
+	/**
+	 * The emulated machine at one point in time. Everything but memory is
+	 * serialized into `machine`. Memory blocks are kept as 256-byte pages which
+	 * are never written to once captured, so a page that did not change
+	 * between two captures is shared by both snapshots instead of copied, and
+	 * a snapshot may be read from any thread.
+	 */
+	struct StateSnapshot {
+		static constexpr uint32_t magic = 0x53455343; // "CSES"
+		static constexpr uint32_t version = 3;
+		static constexpr size_t page_size = 0x100;
+
+		typedef std::array<uint8_t, page_size> Page;
+		struct MemoryImage {
+			size_t size = 0;
+			std::vector<std::shared_ptr<const Page>> pages;
+		};
+
+		uint32_t hardware_id = 0;
+		std::string machine;
+		std::vector<MemoryImage> memory;
+
+		/**
+		 * The file format: `magic`, `version`, `hardware_id`, then `machine`
+		 * and each memory block with a 64-bit length in front of them.
+		 */
+		void Write(std::ostream& os) const;
+		void Read(std::istream& is);
+	};
+
+	/**
+	 * Captures and restores the emulator's state. `Capture` and `Restore` must
+	 * be called on the tick thread, e.g. through `Emulator::RunOnTickThread`;
+	 * `SaveFile` and `LoadFile` do that themselves and keep file access off it.
+	 */
+	class SaveStates {
+		Emulator& emulator;
+
+		struct MemoryBlock {
+			uint8_t* data;
+			size_t size;
+			bool operator==(const MemoryBlock& other) const {
+				return data == other.data && size == other.size;
+			}
+		};
+		/**
+		 * RAM and what the machine can program. The ROM image is left out, it
+		 * is loaded from the model and the `Flash` peripheral keeps the words
+		 * programmed into it.
+		 */
+		std::vector<MemoryBlock> GetMemoryBlocks();
+
+		/**
+		 * Memory as of the last capture or restore, in `blocks`. Only pages
+		 * marked in `written` since then are compared with it by the next
+		 * capture, the rest are reused as they are.
+		 */
+		std::vector<MemoryBlock> blocks;
+		std::vector<StateSnapshot::MemoryImage> last_memory;
+		std::vector<std::vector<bool>> written;
+		// * Where this instance is in `MMU::WrittenSince` and `MMU::host_writes`.
+		uint32_t mmu_epoch = 0, host_writes = 0;
+		void MarkWritten(const uint8_t* data, size_t size);
+
+	public:
+		SaveStates(Emulator& emulator);
+
+		std::shared_ptr<const StateSnapshot> Capture();
+		/**
+		 * Returns false without touching the machine if `snapshot` was taken
+		 * on a different model, does not fit its memory layout, or holds
+		 * peripheral fields other than the ones this build serializes.
+		 */
+		bool Restore(const StateSnapshot& snapshot);
+		/**
+		 * Forgets the memory of the last capture or restore, so the next
+		 * capture compares every page and shares none with older snapshots.
+		 */
+		void Reset();
+
+		void SaveFile(std::string path);
+		void LoadFile(std::string path);
+	};
+} // namespace casioemu
@@ -1,15 +1,24 @@
 ﻿#include "Config.hpp"
+#ifndef CASIOEMU_HEADLESS
 #include "Ui.hpp"
 #include "imgui_impl_sdl2.h"
+#endif
 
+#include "Batch.hpp"
+#include "Chipset/Chipset.hpp"
 #include "Emulator.hpp"
+#include "FramePacer.hpp"
 #include "Logger.hpp"
+#include "Peripheral/BatteryBackedRAM.hpp"
+#include "Pool.hpp"
 #include "SDL_events.h"
 #include "SDL_keyboard.h"
 #include "SDL_mouse.h"
 #include "SDL_video.h"
 #include <SDL.h>
+#ifndef CASIOEMU_HEADLESS
 #include <SDL_image.h>
+#endif
 #include <atomic>
 #include <condition_variable>
 #include <cstdint>
@@ -23,7 +32,9 @@
 #include <ostream>
 #include <string>
 #include <thread>
+#ifndef CASIOEMU_HEADLESS
 #include "Localization.h"
+#endif
 #if _WIN32
 #include <Windows.h>
 #pragma comment(lib, "winmm.lib")
@@ -35,9 +46,11 @@
 
 #endif
 
+#ifndef CASIOEMU_HEADLESS
 #include "StartupUi/StartupUi.h"
 #include <Gui.h>
 #include <Plugin/PluginMan.h>
+#endif
 
 using namespace casioemu;
 
@@ -52,7 +65,9 @@ int main(int argc, char* argv[]) {
 #ifdef __ANDROID__
 	chdir(SDL_AndroidGetExternalStoragePath());
 #endif
+#ifndef CASIOEMU_HEADLESS
 	g_local.Load();
+#endif
 
 	std::map<std::string, std::string> argv_map;
 	for (int ix = 1; ix != argc; ++ix) {
@@ -72,7 +87,24 @@ int main(int argc, char* argv[]) {
 		else
 			logger::Info("[argv][Info] #%i: key '%s' already set\n", ix, key.c_str());
 	}
+#ifdef CASIOEMU_HEADLESS
+	argv_map.emplace("headless", "1");
+#endif
 	bool headless = argv_map.find("headless") != argv_map.end();
+	if (headless) {
+		if (argv_map["model"].empty() && argv_map.find("jobs") == argv_map.end())
+			PANIC("No model path supplied.\n");
+		// No video subsystem, so that batch runs need no display.
+		if (SDL_Init(SDL_INIT_TIMER) != 0)
+			PANIC("SDL_Init failed: %s\n", SDL_GetError());
+		// Each job owns its emulator, so several can run side by side.
+		if (argv_map.find("jobs") != argv_map.end())
+			return EmulatorPool::RunJobFile(argv_map);
+		Emulator emulator(argv_map);
+		return BatchRunner(emulator).Run();
+	}
+
+#ifndef CASIOEMU_HEADLESS
 
 	int sdlFlags = SDL_INIT_VIDEO | SDL_INIT_TIMER;
 	if (SDL_Init(sdlFlags) != 0)
@@ -81,9 +113,6 @@ int main(int argc, char* argv[]) {
 	int imgFlags = IMG_INIT_PNG;
 	if (IMG_Init(imgFlags) != imgFlags)
 		PANIC("IMG_Init failed: %s\n", IMG_GetError());
-	if (headless && argv_map["model"].empty()) {
-		PANIC("No model path supplied.\n");
-	}
 	if (argv_map["model"].empty()) {
 		auto s = sui_loop();
 		argv_map["model"] = std::move(s);
@@ -92,28 +121,16 @@ int main(int argc, char* argv[]) {
 	}
 
 	Emulator emulator(argv_map);
+	// The debugger windows only ever look at this one emulator.
 	m_emu = &emulator;
+	me_mmu = &emulator.chipset.mmu;
+	if (auto ram = emulator.chipset.QueryInterface<IRam>())
+		n_ram_buffer = (char*)ram->GetRam();
 
 	// static std::atomic<bool> running(true);
 
 	bool guiCreated = false;
-	auto frame_event = SDL_RegisterEvents(1);
-	bool busy = false;
-	std::thread t3([&]() {
-		SDL_Event se{};
-		se.type = frame_event;
-		se.user.windowID = SDL_GetWindowID(emulator.window);
-		while (1) {
-			if (!busy)
-				SDL_PushEvent(&se);
-#ifdef __ANDROID__
-			SDL_Delay(40);
-#else
-			SDL_Delay(1);
-#endif
-		}
-	});
-	t3.detach();
+	auto& frame_pacer = emulator.frame_pacer;
 #ifdef DBG
 	test_gui(&guiCreated, emulator.window, emulator.renderer);
 #endif
@@ -153,6 +170,9 @@ int main(int argc, char* argv[]) {
 
 	// 在主循环渲染部分添加（在SDL_RenderPresent之前）：
 	const Uint32 TRAIL_DURATION = 500; // 轨迹持续500ms
+	// 屏幕静止且没有输入时不再重绘，只是每隔一段时间刷新一次调试窗口
+	const Uint32 IDLE_REFRESH_INTERVAL = 500;
+	Uint32 last_input = 0, last_present = 0;
 
 	TouchState touchState;
 	TouchState touchState2; // 用于第二个手指
@@ -170,11 +190,12 @@ int main(int argc, char* argv[]) {
 
 	while (emulator.Running()) {
 		SDL_Event event{};
-		busy = false;
-		if (!SDL_PollEvent(&event))
-			continue;
-		busy = true;
-		if (event.type == frame_event) {
+		// 有新的墨迹、触摸轨迹还在或者该刷新调试窗口时才需要画一帧，由 frame_pacer 决定何时画
+		Uint32 idle = SDL_GetTicks() - last_present;
+		bool wanted = emulator.FramePending() || SDL_GetTicks() - last_input <= TRAIL_DURATION || idle >= IDLE_REFRESH_INTERVAL;
+		if (frame_pacer.FrameDue(wanted)) {
+			frame_pacer.BeginFrame();
+			last_present = SDL_GetTicks();
 			SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
 			SDL_RenderClear(renderer);
 			if (bg_txt) {
@@ -284,6 +305,7 @@ int main(int argc, char* argv[]) {
 			emulator.Frame();
 			SDL_RenderPresent(emulator.renderer);
 #endif
+			frame_pacer.EndFrame();
 			if (RebuildFont_Requested) {
 				RebuildFont(RebuildFont_Scale);
 				if (RebuildFont_Scale != 0) {
@@ -299,14 +321,15 @@ int main(int argc, char* argv[]) {
 				ImGui_ImplSDLRenderer2_DestroyDeviceObjects();
 				RebuildFont_Requested = 0;
 			}
-			while (SDL_PollEvent(&event)) {
-				if (event.type != frame_event)
-					goto hld;
-			}
 			continue;
 		}
 
-	hld:
+		// 没有事件时睡到下一帧，新的墨迹会用 RequestFrame 叫醒这里
+		if (!SDL_WaitEventTimeout(&event, frame_pacer.WaitTimeout(wanted, IDLE_REFRESH_INTERVAL - idle)))
+			continue;
+		if (frame_pacer.IsWakeEvent(event))
+			continue;
+		last_input = SDL_GetTicks();
 		int wid, hei;
 		SDL_GetWindowSize(window, &wid, &hei);
 		switch (event.type) {
@@ -320,6 +343,18 @@ int main(int argc, char* argv[]) {
 				break;
 			}
 			break;
+		case SDL_RENDER_TARGETS_RESET:
+			// 只丢了渲染目标的内容，重画一次机身即可
+			emulator.InvalidateFrameCache();
+			break;
+		case SDL_RENDER_DEVICE_RESET:
+			// 设备丢失后所有纹理都要重建
+			emulator.RecreateTextures();
+			if (bg_txt) {
+				SDL_DestroyTexture(bg_txt);
+				bg_txt = SDL_CreateTextureFromSurface(renderer, background);
+			}
+			break;
 #ifdef __ANDROID__
 		case SDL_FINGERDOWN:
 			if (!touchState.touching) {
@@ -524,5 +559,6 @@ int main(int argc, char* argv[]) {
 			break;
 		}
 	}
+#endif
 	return 0;
 };
\ No newline at end of file
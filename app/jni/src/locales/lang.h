@@ -92,6 +92,7 @@ CallAnalysis.CallerFilter=Caller:
 
 CodeViewer.Loading=Waiting for disassembler...
 CodeViewer.Goto=Goto:
+CodeViewer.StepBack=Step back
 CodeViewer.Step=Step
 CodeViewer.Trace=Trace
 CodeViewer.JumpOut=Jump out
@@ -110,6 +111,10 @@ HwController.Value2=Screen flashing brightness coeff
 HwController.ScreenBufferSelect=Screen buffer select
 HwController.CPS=Cycles per second
 HwController.Interrupt=Raise an interrupt
+HwController.SaveState=Save state
+HwController.LoadState=Load state
+HwController.FrameTime=Frame time
+HwController.FrameRequests=Frame requests (merged)
 
 MemBP.BPType=Choose breakpoint type:
 MemBP.Delete=Delete
@@ -118,6 +123,9 @@ MemBP.MonitoringHint=Monitoring: 0x%06x
 MemBP.ClearRec=Clear records
 MemBP.AddAddr=Add
 MemBP.BreakWhenHit=Break when hit bp
+MemBP.MonitorBoth=Monitor read and write
+MemBP.Length=Length
+MemBP.IfValue=If value
 
 WatchWindow.CoreStatus=Core status
 WatchWindow.Pause=Pause
@@ -287,6 +295,7 @@ CallAnalysis.CallerFilter=Người gọi:
 
 CodeViewer.Loading=Đang đợi disassembler...
 CodeViewer.Goto=Đến:
+CodeViewer.StepBack=Lùi lại
 CodeViewer.Step=Bước
 CodeViewer.Trace=Theo dõi
 CodeViewer.JumpOut=Nhảy ra
@@ -301,6 +310,10 @@ HwController.Value2=Hệ số độ sáng nháy màn hình
 HwController.ScreenBufferSelect=Chọn buffer màn hình
 HwController.CPS=Chu kỳ mỗi giây
 HwController.Interrupt=Kích hoạt ngắt
+HwController.SaveState=Lưu trạng thái
+HwController.LoadState=Tải trạng thái
+HwController.FrameTime=Thời gian khung hình
+HwController.FrameRequests=Yêu cầu vẽ khung (đã gộp)
 
 MemBP.BPType=Chọn loại điểm dừng:
 MemBP.Delete=Xóa
@@ -309,6 +322,9 @@ MemBP.MonitoringHint=Đang giám sát: 0x%06x
 MemBP.ClearRec=Xóa bản ghi
 MemBP.AddAddr=Thêm
 MemBP.BreakWhenHit=Dừng khi chạm điểm dừng
+MemBP.MonitorBoth=Giám sát đọc và ghi
+MemBP.Length=Độ dài
+MemBP.IfValue=Nếu giá trị
 
 WatchWindow.CoreStatus=Trạng thái nhân(lõi)
 WatchWindow.Pause=Tạm dừng
@@ -476,6 +492,7 @@ CallAnalysis.CallerFilter=调用者：
 
 CodeViewer.Loading=等待反汇编器...
 CodeViewer.Goto=转到：
+CodeViewer.StepBack=单步后退
 CodeViewer.Step=单步
 CodeViewer.Trace=追踪
 CodeViewer.JumpOut=跳出
@@ -490,6 +507,10 @@ HwController.Value2=闪屏对比度补偿
 HwController.ScreenBufferSelect=屏幕缓冲区选择
 HwController.CPS=每秒周期数
 HwController.Interrupt=触发中断
+HwController.SaveState=保存状态
+HwController.LoadState=读取状态
+HwController.FrameTime=帧时间
+HwController.FrameRequests=绘制请求（已合并）
 
 MemBP.BPType=选择断点类型：
 MemBP.Delete=删除
@@ -498,6 +519,9 @@ MemBP.MonitoringHint=监视中：0x%06x
 MemBP.ClearRec=清除记录
 MemBP.AddAddr=添加
 MemBP.BreakWhenHit=命中断点时中断
+MemBP.MonitorBoth=监视读写
+MemBP.Length=长度
+MemBP.IfValue=当值为
 
 WatchWindow.CoreStatus=核心状态
 WatchWindow.Pause=暂停